@@ -131,6 +131,28 @@ void Experiment::DeleteIdentification(const Identification & identification) {
 	d_p->Identifier()->DeleteIdentification(identification.ToPrivate());
 }
 
+struct Experiment::PoseEditScope::Implementation {
+	Implementation(const priv::IdentifierPtr & identifier)
+		: Identifier(identifier)
+		, Scope(*identifier) {
+	}
+
+	// keeps the Identifier alive for the lifetime of the scope
+	priv::IdentifierPtr              Identifier;
+	priv::Identifier::PoseEditScope  Scope;
+};
+
+Experiment::PoseEditScope::PoseEditScope(Experiment & experiment)
+	: d_impl(std::make_unique<Implementation>(experiment.d_p->Identifier())) {
+}
+
+Experiment::PoseEditScope::~PoseEditScope() {
+}
+
+void Experiment::PoseEditScope::Commit() {
+	d_impl->Scope.Commit();
+}
+
 bool Experiment::FreeIdentificationRangeAt(Time::ConstPtr & start,
                                            Time::ConstPtr & end,
                                            TagID tagID, const Time & time) const {
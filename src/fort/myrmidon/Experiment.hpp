@@ -871,6 +871,46 @@ public:
 	std::map<AntID,TagID> IdentificationsAt(const Time & time,
 	                                        bool removeUnidentifiedAnt = true) const;
 
+	// Defers Ant pose updates during bulk edits
+	//
+	// Any change of an <Identification>, or of the measurements
+	// of its tag, recomputes the <Ant> pose in its
+	// <Identification>. While a PoseEditScope exists, these updates
+	// are deferred: each affected <Identification> is recomputed
+	// once, in parallel, when the outermost scope is
+	// committed. Scopes can be nested.
+	//
+	// ```c++
+	// Experiment::PoseEditScope edits(experiment);
+	// for ( const auto & [antID,tagID] : wanted ) {
+	//     experiment.AddIdentification(antID,tagID,nullptr,nullptr);
+	// }
+	// edits.Commit();
+	// ```
+	//
+	// A scope destroyed without <Commit> still tries to update the
+	// <Ant> poses, but silently ignores any error.
+	class PoseEditScope {
+	public:
+		// Opens a scope on an Experiment
+		// @experiment the <Experiment> to edit
+		PoseEditScope(Experiment & experiment);
+		~PoseEditScope();
+
+		// Ends the scope
+		//
+		// Recomputes the deferred <Ant> poses if this is the
+		// outermost scope. Errors are propagated. Further calls have
+		// no effect.
+		void Commit();
+	private:
+		PoseEditScope(const PoseEditScope &) = delete;
+		PoseEditScope & operator=(const PoseEditScope &) = delete;
+
+		struct Implementation;
+		std::unique_ptr<Implementation> d_impl;
+	};
+
 	/* cldoc:end-category() */
 
 	// Compiles a TrackingSolver
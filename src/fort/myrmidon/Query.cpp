@@ -48,13 +48,44 @@ void Query::IdentifyFrames(const CExperiment & experiment,
 	                            start,end,computeZones,singleThread);
 }
 
+void Query::IdentifyFramesInRegionFunctor(const CExperiment & experiment,
+                                          std::function<void (const IdentifiedFrame::ConstPtr &)> storeData,
+                                          const Time::ConstPtr & start,
+                                          const Time::ConstPtr & end,
+                                          const Eigen::Vector2d & regionMin,
+                                          const Eigen::Vector2d & regionMax,
+                                          bool computeZones,
+                                          bool singleThreaded) {
+	priv::Query::IdentifyFramesInRegion(experiment.d_p,storeData,start,end,
+	                                    priv::AABB(regionMin,regionMax),
+	                                    computeZones,singleThreaded);
+}
+
+void Query::IdentifyFramesInRegion(const CExperiment & experiment,
+                                   std::vector<IdentifiedFrame::ConstPtr> & result,
+                                   const Time::ConstPtr & start,
+                                   const Time::ConstPtr & end,
+                                   const Eigen::Vector2d & regionMin,
+                                   const Eigen::Vector2d & regionMax,
+                                   bool computeZones,
+                                   bool singleThread) {
+	priv::Query::IdentifyFramesInRegion(experiment.d_p,
+	                                    [&result] (const IdentifiedFrame::ConstPtr & i) {
+		                                    result.push_back(i);
+	                                    },
+	                                    start,end,
+	                                    priv::AABB(regionMin,regionMax),
+	                                    computeZones,singleThread);
+}
+
 
 void Query::CollideFramesFunctor(const CExperiment & experiment,
                                  std::function<void (const CollisionData & data)> storeData,
                                  const Time::ConstPtr & start,
                                  const Time::ConstPtr & end,
-                                 bool singleThread) {
-	priv::Query::CollideFrames(experiment.d_p,storeData,start,end,singleThread);
+                                 bool singleThread,
+                                 double proximityMargin) {
+	priv::Query::CollideFrames(experiment.d_p,storeData,start,end,singleThread,proximityMargin);
 }
 
 
@@ -62,12 +93,13 @@ void Query::CollideFrames(const CExperiment & experiment,
                           std::vector<CollisionData> & result,
                           const Time::ConstPtr & start,
                           const Time::ConstPtr & end,
-                          bool singleThread) {
+                          bool singleThread,
+                          double proximityMargin) {
 	priv::Query::CollideFrames(experiment.d_p,
 	                           [&result](const CollisionData & data) {
 		                           result.push_back(data);
 	                           },
-	                           start,end,singleThread);
+	                           start,end,singleThread,proximityMargin);
 }
 
 void Query::ComputeAntTrajectoriesFunctor(const CExperiment & experiment,
@@ -77,7 +109,11 @@ void Query::ComputeAntTrajectoriesFunctor(const CExperiment & experiment,
                                           Duration maximumGap,
                                           const Matcher::Ptr & matcher,
                                           bool computeZones,
-                                          bool singleThread) {
+                                          bool singleThread,
+                                          double simplificationTolerance,
+                                          double angularTolerance,
+                                          bool computeKinematics,
+                                          Duration smoothingWindow) {
 	priv::Query::ComputeTrajectories(experiment.d_p,
 	                                 storeTrajectory,
 	                                 start,
@@ -85,7 +121,13 @@ void Query::ComputeAntTrajectoriesFunctor(const CExperiment & experiment,
 	                                 maximumGap,
 	                                 !matcher ? Matcher::PPtr() : matcher->d_p,
 	                                 computeZones,
-	                                 singleThread);
+	                                 singleThread,
+	                                 0,
+	                                 0,
+	                                 simplificationTolerance,
+	                                 angularTolerance,
+	                                 computeKinematics,
+	                                 smoothingWindow);
 }
 
 
@@ -97,7 +139,11 @@ void Query::ComputeAntTrajectories(const CExperiment & experiment,
                                    Duration maximumGap,
                                    const Matcher::Ptr & matcher,
                                    bool computeZones,
-                                   bool singleThread) {
+                                   bool singleThread,
+                                   double simplificationTolerance,
+                                   double angularTolerance,
+                                   bool computeKinematics,
+                                   Duration smoothingWindow) {
 	priv::Query::ComputeTrajectories(experiment.d_p,
 	                                 [&trajectories](const AntTrajectory::ConstPtr & trajectory) {
 		                                 trajectories.push_back(trajectory);
@@ -107,7 +153,72 @@ void Query::ComputeAntTrajectories(const CExperiment & experiment,
 	                                 maximumGap,
 	                                 !matcher ? Matcher::PPtr() : matcher->d_p,
 	                                 computeZones,
-	                                 singleThread);
+	                                 singleThread,
+	                                 0,
+	                                 0,
+	                                 simplificationTolerance,
+	                                 angularTolerance,
+	                                 computeKinematics,
+	                                 smoothingWindow);
+}
+
+void Query::ComputeAntResampledTrajectoriesFunctor(const CExperiment & experiment,
+                                                   std::function<void (const AntTrajectory::ConstPtr &)> storeTrajectory,
+                                                   const Time::ConstPtr & start,
+                                                   const Time::ConstPtr & end,
+                                                   Duration maximumGap,
+                                                   Duration samplingPeriod,
+                                                   Duration maximumInterpolationGap,
+                                                   const Matcher::Ptr & matcher,
+                                                   bool computeZones,
+                                                   bool singleThread,
+                                                   bool computeKinematics,
+                                                   Duration smoothingWindow) {
+	if ( samplingPeriod <= 0 ) {
+		throw std::invalid_argument("Sampling period must be strictly positive");
+	}
+	priv::Query::ComputeTrajectories(experiment.d_p,
+	                                 storeTrajectory,
+	                                 start,
+	                                 end,
+	                                 maximumGap,
+	                                 !matcher ? Matcher::PPtr() : matcher->d_p,
+	                                 computeZones,
+	                                 singleThread,
+	                                 samplingPeriod,
+	                                 maximumInterpolationGap,
+	                                 0.0,
+	                                 0.0,
+	                                 computeKinematics,
+	                                 smoothingWindow);
+}
+
+void Query::ComputeAntResampledTrajectories(const CExperiment & experiment,
+                                            std::vector<AntTrajectory::ConstPtr> & trajectories,
+                                            const Time::ConstPtr & start,
+                                            const Time::ConstPtr & end,
+                                            Duration maximumGap,
+                                            Duration samplingPeriod,
+                                            Duration maximumInterpolationGap,
+                                            const Matcher::Ptr & matcher,
+                                            bool computeZones,
+                                            bool singleThread,
+                                            bool computeKinematics,
+                                            Duration smoothingWindow) {
+	ComputeAntResampledTrajectoriesFunctor(experiment,
+	                                       [&trajectories](const AntTrajectory::ConstPtr & trajectory) {
+		                                       trajectories.push_back(trajectory);
+	                                       },
+	                                       start,
+	                                       end,
+	                                       maximumGap,
+	                                       samplingPeriod,
+	                                       maximumInterpolationGap,
+	                                       matcher,
+	                                       computeZones,
+	                                       singleThread,
+	                                       computeKinematics,
+	                                       smoothingWindow);
 }
 
 void Query::ComputeAntInteractionsFunctor(const CExperiment & experiment,
@@ -117,7 +228,12 @@ void Query::ComputeAntInteractionsFunctor(const CExperiment & experiment,
                                           const Time::ConstPtr & end,
                                           Duration maximumGap,
                                           const Matcher::Ptr & matcher,
-                                          bool singleThread) {
+                                          bool singleThread,
+                                          double proximityMargin,
+                                          double simplificationTolerance,
+                                          double angularTolerance,
+                                          bool computeKinematics,
+                                          Duration smoothingWindow) {
 	priv::Query::ComputeAntInteractions(experiment.d_p,
 	                                    storeTrajectory,
 	                                    storeInteraction,
@@ -125,7 +241,12 @@ void Query::ComputeAntInteractionsFunctor(const CExperiment & experiment,
 	                                    end,
 	                                    maximumGap,
 	                                    !matcher ? Matcher::PPtr() : matcher->d_p,
-	                                    singleThread);
+	                                    singleThread,
+	                                    proximityMargin,
+	                                    simplificationTolerance,
+	                                    angularTolerance,
+	                                    computeKinematics,
+	                                    smoothingWindow);
 }
 
 
@@ -136,7 +257,12 @@ void Query::ComputeAntInteractions(const CExperiment & experiment,
                                    const Time::ConstPtr & end,
                                    Duration maximumGap,
                                    const Matcher::Ptr & matcher,
-                                   bool singleThread) {
+                                   bool singleThread,
+                                   double proximityMargin,
+                                   double simplificationTolerance,
+                                   double angularTolerance,
+                                   bool computeKinematics,
+                                   Duration smoothingWindow) {
 	priv::Query::ComputeAntInteractions(experiment.d_p,
 	                                    [&trajectories](const AntTrajectory::ConstPtr & trajectory) {
 		                                    trajectories.push_back(trajectory);
@@ -148,9 +274,250 @@ void Query::ComputeAntInteractions(const CExperiment & experiment,
 	                                    end,
 	                                    maximumGap,
 	                                    !matcher ? Matcher::PPtr() : matcher->d_p,
+	                                    singleThread,
+	                                    proximityMargin,
+	                                    simplificationTolerance,
+	                                    angularTolerance,
+	                                    computeKinematics,
+	                                    smoothingWindow);
+}
+
+void Query::ComputeAntInteractionSummariesFunctor(const CExperiment & experiment,
+                                                  std::function<void (const AntInteractionSummary &)> storeSummary,
+                                                  const Time::ConstPtr & start,
+                                                  const Time::ConstPtr & end,
+                                                  Duration maximumGap,
+                                                  const Matcher::Ptr & matcher,
+                                                  bool computeMeanPositions,
+                                                  bool singleThread,
+                                                  double proximityMargin) {
+	priv::Query::ComputeAntInteractionSummaries(experiment.d_p,
+	                                            storeSummary,
+	                                            start,
+	                                            end,
+	                                            maximumGap,
+	                                            !matcher ? Matcher::PPtr() : matcher->d_p,
+	                                            computeMeanPositions,
+	                                            singleThread,
+	                                            proximityMargin);
+}
+
+void Query::ComputeAntInteractionSummaries(const CExperiment & experiment,
+                                           std::vector<AntInteractionSummary> & summaries,
+                                           const Time::ConstPtr & start,
+                                           const Time::ConstPtr & end,
+                                           Duration maximumGap,
+                                           const Matcher::Ptr & matcher,
+                                           bool computeMeanPositions,
+                                           bool singleThread,
+                                           double proximityMargin) {
+	priv::Query::ComputeAntInteractionSummaries(experiment.d_p,
+	                                            [&summaries](const AntInteractionSummary & summary) {
+		                                            summaries.push_back(summary);
+	                                            },
+	                                            start,
+	                                            end,
+	                                            maximumGap,
+	                                            !matcher ? Matcher::PPtr() : matcher->d_p,
+	                                            computeMeanPositions,
+	                                            singleThread,
+	                                            proximityMargin);
+}
+
+
+void Query::ComputeAntZoneSummariesFunctor(const CExperiment & experiment,
+                                           std::function<void (const AntZoneSummary &)> storeSummary,
+                                           const Time::ConstPtr & start,
+                                           const Time::ConstPtr & end,
+                                           Duration binSize,
+                                           Duration maximumGap,
+                                           const Matcher::Ptr & matcher,
+                                           bool singleThread) {
+	priv::Query::ComputeAntZoneSummaries(experiment.d_p,
+	                                     storeSummary,
+	                                     start,
+	                                     end,
+	                                     binSize,
+	                                     maximumGap,
+	                                     !matcher ? Matcher::PPtr() : matcher->d_p,
+	                                     singleThread);
+}
+
+void Query::ComputeAntZoneSummaries(const CExperiment & experiment,
+                                    std::vector<AntZoneSummary> & summaries,
+                                    const Time::ConstPtr & start,
+                                    const Time::ConstPtr & end,
+                                    Duration binSize,
+                                    Duration maximumGap,
+                                    const Matcher::Ptr & matcher,
+                                    bool singleThread) {
+	priv::Query::ComputeAntZoneSummaries(experiment.d_p,
+	                                     [&summaries](const AntZoneSummary & summary) {
+		                                     summaries.push_back(summary);
+	                                     },
+	                                     start,
+	                                     end,
+	                                     binSize,
+	                                     maximumGap,
+	                                     !matcher ? Matcher::PPtr() : matcher->d_p,
+	                                     singleThread);
+}
+
+void Query::ComputeAntContactEdgesFunctor(const CExperiment & experiment,
+                                          std::function<void (const AntContactEdge &)> storeEdge,
+                                          const Time::ConstPtr & start,
+                                          const Time::ConstPtr & end,
+                                          Duration windowSize,
+                                          Duration maximumGap,
+                                          const Matcher::Ptr & matcher,
+                                          bool splitByType,
+                                          bool singleThread) {
+	priv::Query::ComputeAntContactEdges(experiment.d_p,
+	                                    storeEdge,
+	                                    start,
+	                                    end,
+	                                    windowSize,
+	                                    maximumGap,
+	                                    !matcher ? Matcher::PPtr() : matcher->d_p,
+	                                    splitByType,
+	                                    singleThread);
+}
+
+void Query::ComputeAntContactEdges(const CExperiment & experiment,
+                                   std::vector<AntContactEdge> & edges,
+                                   const Time::ConstPtr & start,
+                                   const Time::ConstPtr & end,
+                                   Duration windowSize,
+                                   Duration maximumGap,
+                                   const Matcher::Ptr & matcher,
+                                   bool splitByType,
+                                   bool singleThread) {
+	priv::Query::ComputeAntContactEdges(experiment.d_p,
+	                                    [&edges](const AntContactEdge & edge) {
+		                                    edges.push_back(edge);
+	                                    },
+	                                    start,
+	                                    end,
+	                                    windowSize,
+	                                    maximumGap,
+	                                    !matcher ? Matcher::PPtr() : matcher->d_p,
+	                                    splitByType,
 	                                    singleThread);
 }
 
+void Query::ComputeAntNeighboursFunctor(const CExperiment & experiment,
+                                        std::function<void (const AntNeighbours::ConstPtr &)> storeNeighbours,
+                                        const Time::ConstPtr & start,
+                                        const Time::ConstPtr & end,
+                                        size_t k,
+                                        double radius,
+                                        bool singleThread) {
+	priv::Query::ComputeAntNeighbours(experiment.d_p,
+	                                  storeNeighbours,
+	                                  start,
+	                                  end,
+	                                  k,
+	                                  radius,
+	                                  singleThread);
+}
+
+void Query::ComputeAntNeighbours(const CExperiment & experiment,
+                                 std::vector<AntNeighbours::ConstPtr> & neighbours,
+                                 const Time::ConstPtr & start,
+                                 const Time::ConstPtr & end,
+                                 size_t k,
+                                 double radius,
+                                 bool singleThread) {
+	priv::Query::ComputeAntNeighbours(experiment.d_p,
+	                                  [&neighbours](const AntNeighbours::ConstPtr & n) {
+		                                  neighbours.push_back(n);
+	                                  },
+	                                  start,
+	                                  end,
+	                                  k,
+	                                  radius,
+	                                  singleThread);
+}
+
+void Query::ComputeAntZoneTransitionsFunctor(const CExperiment & experiment,
+                                             std::function<void (const AntZoneTransition &)> storeTransition,
+                                             const Time::ConstPtr & start,
+                                             const Time::ConstPtr & end,
+                                             Duration debounce,
+                                             Duration maximumGap,
+                                             const Matcher::Ptr & matcher,
+                                             bool singleThread) {
+	priv::Query::ComputeAntZoneTransitions(experiment.d_p,
+	                                       storeTransition,
+	                                       start,
+	                                       end,
+	                                       debounce,
+	                                       maximumGap,
+	                                       !matcher ? Matcher::PPtr() : matcher->d_p,
+	                                       singleThread);
+}
+
+void Query::ComputeAntZoneTransitions(const CExperiment & experiment,
+                                      std::vector<AntZoneTransition> & transitions,
+                                      const Time::ConstPtr & start,
+                                      const Time::ConstPtr & end,
+                                      Duration debounce,
+                                      Duration maximumGap,
+                                      const Matcher::Ptr & matcher,
+                                      bool singleThread) {
+	priv::Query::ComputeAntZoneTransitions(experiment.d_p,
+	                                       [&transitions](const AntZoneTransition & t) {
+		                                       transitions.push_back(t);
+	                                       },
+	                                       start,
+	                                       end,
+	                                       debounce,
+	                                       maximumGap,
+	                                       !matcher ? Matcher::PPtr() : matcher->d_p,
+	                                       singleThread);
+}
+
+void Query::ComputeAntOccupancyHeatmapsFunctor(const CExperiment & experiment,
+                                               std::function<void (const AntOccupancyHeatmap::ConstPtr &)> storeHeatmap,
+                                               const Time::ConstPtr & start,
+                                               const Time::ConstPtr & end,
+                                               double binSize,
+                                               Duration windowSize,
+                                               bool perAnt,
+                                               const std::string & groupColumn,
+                                               bool singleThread) {
+	priv::Query::ComputeAntOccupancyHeatmaps(experiment.d_p,
+	                                         storeHeatmap,
+	                                         start,
+	                                         end,
+	                                         binSize,
+	                                         windowSize,
+	                                         perAnt,
+	                                         groupColumn,
+	                                         singleThread);
+}
+
+void Query::ComputeAntOccupancyHeatmaps(const CExperiment & experiment,
+                                        std::vector<AntOccupancyHeatmap::ConstPtr> & heatmaps,
+                                        const Time::ConstPtr & start,
+                                        const Time::ConstPtr & end,
+                                        double binSize,
+                                        Duration windowSize,
+                                        bool perAnt,
+                                        const std::string & groupColumn,
+                                        bool singleThread) {
+	priv::Query::ComputeAntOccupancyHeatmaps(experiment.d_p,
+	                                         [&heatmaps](const AntOccupancyHeatmap::ConstPtr & heatmap) {
+		                                         heatmaps.push_back(heatmap);
+	                                         },
+	                                         start,
+	                                         end,
+	                                         binSize,
+	                                         windowSize,
+	                                         perAnt,
+	                                         groupColumn,
+	                                         singleThread);
+}
 
 } // namespace myrmidon
 } // namespace fort
@@ -127,6 +127,61 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	                           bool computeZones = false,
 	                           bool singleThreaded = false);
 
+	// Identifies ants in a region of frames - functor version
+	// @experiment the <Experiment> to query for
+	// @storeData a functor to store/convert the data
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @regionMin the top left corner of the region, in pixels
+	// @regionMax the bottom right corner of the region, in pixels
+	// @computeZones should compute zones for, makes computation slower
+	// @singleThread run this query on a single thread
+	//
+	// Identifies Ants located in a rectangular region of the frames
+	// of all spaces. Only frames with at least one ant in the region
+	// are reported, ordered by time. The first query builds and
+	// caches a coarse index of the tags seen in each tracking
+	// segment, later queries use it to skip the segments that could
+	// not have any ant in the region. This version aimed to be used
+	// by language bindings to avoid large data copy.
+	static void IdentifyFramesInRegionFunctor(const CExperiment & experiment,
+	                                          std::function<void (const IdentifiedFrame::ConstPtr &)> storeData,
+	                                          const Time::ConstPtr & start,
+	                                          const Time::ConstPtr & end,
+	                                          const Eigen::Vector2d & regionMin,
+	                                          const Eigen::Vector2d & regionMax,
+	                                          bool computeZones = false,
+	                                          bool singleThreaded = false);
+
+	// Identifies ants in a region of frames
+	// @experiment the <Experiment> to query for
+	// @result the resulting <IdentifiedFrame>
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @regionMin the top left corner of the region, in pixels
+	// @regionMax the bottom right corner of the region, in pixels
+	// @computeZones should compute zones for, makes computation slower
+	// @singleThread run this query on a single thread
+	//
+	// Identifies Ants located in a rectangular region of the frames
+	// of all spaces. Only frames with at least one ant in the region
+	// are reported, ordered by time. The first query builds and
+	// caches a coarse index of the tags seen in each tracking
+	// segment, later queries use it to skip the segments that could
+	// not have any ant in the region.
+	static void IdentifyFramesInRegion(const CExperiment & experiment,
+	                                   std::vector<IdentifiedFrame::ConstPtr> & result,
+	                                   const Time::ConstPtr & start,
+	                                   const Time::ConstPtr & end,
+	                                   const Eigen::Vector2d & regionMin,
+	                                   const Eigen::Vector2d & regionMax,
+	                                   bool computeZones = false,
+	                                   bool singleThreaded = false);
+
 	// Finds <Collision> in data frame - functor version
 	// @OutputIter an output iterator to fill results
 	// @experiment the <Experiment> to query for
@@ -135,6 +190,11 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	//        of the experiment.
 	// @end the end time for the query, use nullptr for the end of the
 	//      experiment
+	// @singleThread run this query on a single thread
+	// @proximityMargin if strictly positive, also reports ants whose
+	//                  capsules are closer than this distance, in
+	//                  pixels, with their <Collision::Distance>,
+	//                  which is otherwise not computed.
 	//
 	// Finds <Collision> between ants in frames, data will be reported
 	// ordered by time. This version aimed to be used by language bindings to
@@ -152,7 +212,8 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	                                 std::function<void (const CollisionData & data)> storeData,
 	                                 const Time::ConstPtr & start,
 	                                 const Time::ConstPtr & end,
-	                                 bool singleThread = false);
+	                                 bool singleThread = false,
+	                                 double proximityMargin = 0.0);
 
 
 	// Finds <Collision> in data frame
@@ -163,6 +224,10 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	// @end the end time for the query, use nullptr for the end of the
 	//      experiment
 	// @singleThread run this query on a single thread
+	// @proximityMargin if strictly positive, also reports ants whose
+	//                  capsules are closer than this distance, in
+	//                  pixels, with their <Collision::Distance>,
+	//                  which is otherwise not computed.
 	//
 	// Finds <Collision> between ants in frames, data will be reported
 	// ordered by time.
@@ -179,7 +244,8 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	                          std::vector<CollisionData> & result,
 	                          const Time::ConstPtr & start,
 	                          const Time::ConstPtr & end,
-	                          bool singleThread = false);
+	                          bool singleThread = false,
+	                          double proximityMargin = 0.0);
 
 	// Computes trajectories for ants - functor version
 	// @experiment the <Experiment> to query for
@@ -194,6 +260,16 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	//          intensive queries.
 	// @computeZones enables ant zone computation, but slower query
 	// @singleThread run this query on a single thread
+	// @simplificationTolerance if strictly positive, simplifies the
+	//                          trajectories by dropping detections
+	//                          closer than this distance, in pixels,
+	//                          to the interpolated trajectory.
+	// @angularTolerance the maximal angle error, in radians, of the
+	//                   simplification. Zero or less does not bound
+	//                   angles.
+	// @computeKinematics reports <AntTrajectory::Kinematics>.
+	// @smoothingWindow the time window for the mean speed of
+	//                  <AntTrajectory::Kinematics>.
 	//
 	// Computes trajectories for <Ant>. Those will be reported ordered
 	// by ending time. This version aimed to be used by language bindings to
@@ -217,7 +293,11 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	                                          Duration maximumGap,
 	                                          const Matcher::Ptr & matcher = Matcher::Ptr(),
 	                                          bool computeZones = false,
-	                                          bool singleThread = false);
+	                                          bool singleThread = false,
+	                                          double simplificationTolerance = 0.0,
+	                                          double angularTolerance = 0.0,
+	                                          bool computeKinematics = false,
+	                                          Duration smoothingWindow = 0);
 
 
 
@@ -234,6 +314,16 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	//          intensive queries.
 	// @computeZones enables ant zone computation, but slower query
 	// @singleThread run this query on a single thread
+	// @simplificationTolerance if strictly positive, simplifies the
+	//                          trajectories by dropping detections
+	//                          closer than this distance, in pixels,
+	//                          to the interpolated trajectory.
+	// @angularTolerance the maximal angle error, in radians, of the
+	//                   simplification. Zero or less does not bound
+	//                   angles.
+	// @computeKinematics reports <AntTrajectory::Kinematics>.
+	// @smoothingWindow the time window for the mean speed of
+	//                  <AntTrajectory::Kinematics>.
 	//
 	// Computes trajectories for <Ant>. Those will be reported ordered
 	// by ending time
@@ -256,9 +346,99 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	                                   Duration maximumGap,
 	                                   const Matcher::Ptr & matcher = Matcher::Ptr(),
 	                                   bool computeZones = false,
-	                                   bool singleThread = false);
+	                                   bool singleThread = false,
+	                                   double simplificationTolerance = 0.0,
+	                                   double angularTolerance = 0.0,
+	                                   bool computeKinematics = false,
+	                                   Duration smoothingWindow = 0);
 
 
+	// Computes resampled trajectories for ants - functor version
+	// @experiment the <Experiment> to query for
+	// @storeTrajectory a functor to store/covert the data
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @maximumGap the maximal undetected duration before cutting the
+	//             trajectory in two
+	// @samplingPeriod the period of the output samples, must be
+	//                 strictly positive.
+	// @maximumInterpolationGap samples falling between two detections
+	//                          further apart than this duration are
+	//                          left out. Zero or less fills any gap.
+	// @matcher a <Matcher> to specify more precise, less memory
+	//          intensive queries.
+	// @computeZones enables ant zone computation, but slower query
+	// @singleThread run this query on a single thread
+	// @computeKinematics reports <AntTrajectory::Kinematics>.
+	// @smoothingWindow the time window for the mean speed of
+	//                  <AntTrajectory::Kinematics>.
+	//
+	// Computes trajectories for <Ant> sampled every samplingPeriod
+	// from their first detection, instead of on every frame. Positions
+	// are linearly interpolated between detections, and angles along
+	// the shortest arc. A sample reports the zone of the last
+	// detection at or before it. Samples are computed while the
+	// trajectories are built, so the full rate data is never kept in
+	// memory. Trajectories with a single sample are not
+	// reported. This version aimed to be used by language bindings
+	// to avoid large data copy.
+	static void ComputeAntResampledTrajectoriesFunctor(const CExperiment & experiment,
+	                                                   std::function<void (const AntTrajectory::ConstPtr &)> storeTrajectory,
+	                                                   const Time::ConstPtr & start,
+	                                                   const Time::ConstPtr & end,
+	                                                   Duration maximumGap,
+	                                                   Duration samplingPeriod,
+	                                                   Duration maximumInterpolationGap = 0,
+	                                                   const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                                   bool computeZones = false,
+	                                                   bool singleThread = false,
+	                                                   bool computeKinematics = false,
+	                                                   Duration smoothingWindow = 0);
+
+	// Computes resampled trajectories for ants
+	// @experiment the <Experiment> to query for
+	// @trajectories container for the trajectory output
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @maximumGap the maximal undetected duration before cutting the
+	//             trajectory in two
+	// @samplingPeriod the period of the output samples, must be
+	//                 strictly positive.
+	// @maximumInterpolationGap samples falling between two detections
+	//                          further apart than this duration are
+	//                          left out. Zero or less fills any gap.
+	// @matcher a <Matcher> to specify more precise, less memory
+	//          intensive queries.
+	// @computeZones enables ant zone computation, but slower query
+	// @singleThread run this query on a single thread
+	// @computeKinematics reports <AntTrajectory::Kinematics>.
+	// @smoothingWindow the time window for the mean speed of
+	//                  <AntTrajectory::Kinematics>.
+	//
+	// Computes trajectories for <Ant> sampled every samplingPeriod
+	// from their first detection, instead of on every frame. Positions
+	// are linearly interpolated between detections, and angles along
+	// the shortest arc. A sample reports the zone of the last
+	// detection at or before it. Samples are computed while the
+	// trajectories are built, so the full rate data is never kept in
+	// memory. Trajectories with a single sample are not reported.
+	static void ComputeAntResampledTrajectories(const CExperiment & experiment,
+	                                            std::vector<AntTrajectory::ConstPtr> & trajectories,
+	                                            const Time::ConstPtr & start,
+	                                            const Time::ConstPtr & end,
+	                                            Duration maximumGap,
+	                                            Duration samplingPeriod,
+	                                            Duration maximumInterpolationGap = 0,
+	                                            const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                            bool computeZones = false,
+	                                            bool singleThread = false,
+	                                            bool computeKinematics = false,
+	                                            Duration smoothingWindow = 0);
+
 	// Computes interactions for ants - functor version
 	// @experiment the <Experiment> to query for
 	// @storeTrajectory a functor to store/convert trajectories
@@ -272,6 +452,20 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	// @matcher a <Matcher> to specify more precise, less memory
 	//          intensive queries.
 	// @singleThread run this query on a single thread
+	// @proximityMargin if strictly positive, also reports ants whose
+	//                  capsules are closer than this distance, in
+	//                  pixels, with their <Collision::Distance>,
+	//                  which is otherwise not computed.
+	// @simplificationTolerance if strictly positive, simplifies the
+	//                          reported trajectories as in
+	//                          <ComputeAntTrajectories>. The last
+	//                          detection of each interaction is
+	//                          always kept.
+	// @angularTolerance the maximal angle error, in radians, of the
+	//                   simplification.
+	// @computeKinematics reports <AntTrajectory::Kinematics>.
+	// @smoothingWindow the time window for the mean speed of
+	//                  <AntTrajectory::Kinematics>.
 	//
 	// Computes interactions for <Ant>. Those will be reported ordered
 	// by ending time. This version aimed to be used by language bindings to
@@ -295,7 +489,12 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	                                          const Time::ConstPtr & end,
 	                                          Duration maximumGap,
 	                                          const Matcher::Ptr & matcher = Matcher::Ptr(),
-	                                          bool singleThread = false);
+	                                          bool singleThread = false,
+	                                          double proximityMargin = 0.0,
+	                                          double simplificationTolerance = 0.0,
+	                                          double angularTolerance = 0.0,
+	                                          bool computeKinematics = false,
+	                                          Duration smoothingWindow = 0);
 
 
 
@@ -311,6 +510,18 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	// @matcher a <Matcher> to specify more precise, less memory
 	//          intensive queries.
 	// @singleThread run this query on a single thread
+	// @proximityMargin if strictly positive, also reports ants whose
+	//                  capsules are closer than this distance, in
+	//                  pixels, with their <Collision::Distance>,
+	//                  which is otherwise not computed.
+	// @simplificationTolerance if strictly positive, simplifies the
+	//                          reported trajectories as in
+	//                          <ComputeAntTrajectories>.
+	// @angularTolerance the maximal angle error, in radians, of the
+	//                   simplification.
+	// @computeKinematics reports <AntTrajectory::Kinematics>.
+	// @smoothingWindow the time window for the mean speed of
+	//                  <AntTrajectory::Kinematics>.
 	//
 	// Computes interactions for <Ant>. Those will be reported ordered
 	// by ending time.
@@ -333,8 +544,379 @@ static void IdentifyFramesFunctor(const CExperiment & experiment,
 	                                   const Time::ConstPtr & end,
 	                                   Duration maximumGap,
 	                                   const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                   bool singleThread = false,
+	                                   double proximityMargin = 0.0,
+	                                   double simplificationTolerance = 0.0,
+	                                   double angularTolerance = 0.0,
+	                                   bool computeKinematics = false,
+	                                   Duration smoothingWindow = 0);
+
+	// Computes interaction summaries for ants - functor version
+	// @experiment the <Experiment> to query for
+	// @storeSummary a functor to store/convert the summaries
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @maximumGap the maximal duration without collision before
+	//             cutting the interaction in two
+	// @matcher a <Matcher> to specify more precise queries.
+	// @computeMeanPositions reports
+	//                       <AntInteractionSummary::MeanPositions>.
+	// @singleThread run this query on a single thread
+	// @proximityMargin if strictly positive, also reports ants whose
+	//                  capsules are closer than this distance, in
+	//                  pixels.
+	//
+	// Summarizes interactions without building any <AntTrajectory>,
+	// which keeps memory usage independent of the length of the
+	// interactions. A pair of ants interacts while they collide in
+	// the same space without any gap longer than <maximumGap>. Unlike
+	// <ComputeAntInteractions>, <matcher> is only evaluated on the
+	// colliding pair, and never on each ant alone. An ended
+	// interaction is reported when the pair collides again after the
+	// gap, when its space is swept for ended interactions, which
+	// happens at most once per <maximumGap> of frame time, or at the
+	// end of the query.
+	//
+	// This version aimed to be used by language bindings to avoid
+	// large data copy.
+	static void ComputeAntInteractionSummariesFunctor(const CExperiment & experiment,
+	                                                  std::function<void (const AntInteractionSummary &)> storeSummary,
+	                                                  const Time::ConstPtr & start,
+	                                                  const Time::ConstPtr & end,
+	                                                  Duration maximumGap,
+	                                                  const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                                  bool computeMeanPositions = false,
+	                                                  bool singleThread = false,
+	                                                  double proximityMargin = 0.0);
+
+	// Computes interaction summaries for ants
+	// @experiment the <Experiment> to query for
+	// @summaries the resulting <AntInteractionSummary>
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @maximumGap the maximal duration without collision before
+	//             cutting the interaction in two
+	// @matcher a <Matcher> to specify more precise queries.
+	// @computeMeanPositions reports
+	//                       <AntInteractionSummary::MeanPositions>.
+	// @singleThread run this query on a single thread
+	// @proximityMargin if strictly positive, also reports ants whose
+	//                  capsules are closer than this distance, in
+	//                  pixels.
+	//
+	// Summarizes interactions without building any <AntTrajectory>,
+	// which keeps memory usage independent of the length of the
+	// interactions. A pair of ants interacts while they collide in
+	// the same space without any gap longer than <maximumGap>. Unlike
+	// <ComputeAntInteractions>, <matcher> is only evaluated on the
+	// colliding pair, and never on each ant alone. An ended
+	// interaction is reported when the pair collides again after the
+	// gap, when its space is swept for ended interactions, which
+	// happens at most once per <maximumGap> of frame time, or at the
+	// end of the query.
+	static void ComputeAntInteractionSummaries(const CExperiment & experiment,
+	                                           std::vector<AntInteractionSummary> & summaries,
+	                                           const Time::ConstPtr & start,
+	                                           const Time::ConstPtr & end,
+	                                           Duration maximumGap,
+	                                           const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                           bool computeMeanPositions = false,
+	                                           bool singleThread = false,
+	                                           double proximityMargin = 0.0);
+
+	// Summarizes ant presence in zones - functor version
+	// @experiment the <Experiment> to query for
+	// @storeSummary a functor to store/convert the summaries
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @binSize the duration of the time bins. Bins are aligned on
+	//          multiple of binSize since the Unix epoch.
+	// @maximumGap the maximal undetected duration for an interval
+	//             between two detections to be accounted.
+	// @matcher a <Matcher> to select the <Ant> to summarize.
+	// @singleThread run this query on a single thread
+	//
+	// Computes, for each <Ant>, <Zone> and time bin, the time spent,
+	// the number of detections and the distance walked, without
+	// building any <AntTrajectory>. Memory usage does not depend on
+	// the number of frames. Summaries are reported ordered by time
+	// bin. This version aimed to be used by language bindings to
+	// avoid large data copy.
+	static void ComputeAntZoneSummariesFunctor(const CExperiment & experiment,
+	                                           std::function<void (const AntZoneSummary &)> storeSummary,
+	                                           const Time::ConstPtr & start,
+	                                           const Time::ConstPtr & end,
+	                                           Duration binSize,
+	                                           Duration maximumGap,
+	                                           const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                           bool singleThread = false);
+
+	// Summarizes ant presence in zones
+	// @experiment the <Experiment> to query for
+	// @summaries the resulting <AntZoneSummary>
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @binSize the duration of the time bins. Bins are aligned on
+	//          multiple of binSize since the Unix epoch.
+	// @maximumGap the maximal undetected duration for an interval
+	//             between two detections to be accounted.
+	// @matcher a <Matcher> to select the <Ant> to summarize.
+	// @singleThread run this query on a single thread
+	//
+	// Computes, for each <Ant>, <Zone> and time bin, the time spent,
+	// the number of detections and the distance walked, without
+	// building any <AntTrajectory>. Summaries are reported ordered by
+	// time bin.
+	static void ComputeAntZoneSummaries(const CExperiment & experiment,
+	                                    std::vector<AntZoneSummary> & summaries,
+	                                    const Time::ConstPtr & start,
+	                                    const Time::ConstPtr & end,
+	                                    Duration binSize,
+	                                    Duration maximumGap,
+	                                    const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                    bool singleThread = false);
+
+	// Aggregates contacts between ants - functor version
+	// @experiment the <Experiment> to query for
+	// @storeEdge a functor to store/convert the edges
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @windowSize the duration of the time windows. Windows are
+	//             aligned on multiple of windowSize since the Unix
+	//             epoch.
+	// @maximumGap the maximal duration without collision before
+	//             considering a new contact.
+	// @matcher a <Matcher> to select the <Collision> to aggregate.
+	// @splitByType reports an edge per colliding <AntShapeTypeID>
+	//              pair instead of one per <Ant> pair.
+	// @singleThread run this query on a single thread
+	//
+	// Computes the contact network between <Ant> as an edge list per
+	// time window, without building any <AntInteraction>. Memory
+	// usage depends on the number of edges, not on the number of
+	// frames. Edges are reported ordered by time window. This version
+	// aimed to be used by language bindings to avoid large data copy.
+	static void ComputeAntContactEdgesFunctor(const CExperiment & experiment,
+	                                          std::function<void (const AntContactEdge &)> storeEdge,
+	                                          const Time::ConstPtr & start,
+	                                          const Time::ConstPtr & end,
+	                                          Duration windowSize,
+	                                          Duration maximumGap,
+	                                          const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                          bool splitByType = false,
+	                                          bool singleThread = false);
+
+	// Aggregates contacts between ants
+	// @experiment the <Experiment> to query for
+	// @edges the resulting <AntContactEdge>
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @windowSize the duration of the time windows. Windows are
+	//             aligned on multiple of windowSize since the Unix
+	//             epoch.
+	// @maximumGap the maximal duration without collision before
+	//             considering a new contact.
+	// @matcher a <Matcher> to select the <Collision> to aggregate.
+	// @splitByType reports an edge per colliding <AntShapeTypeID>
+	//              pair instead of one per <Ant> pair.
+	// @singleThread run this query on a single thread
+	//
+	// Computes the contact network between <Ant> as an edge list per
+	// time window, without building any <AntInteraction>. Edges are
+	// reported ordered by time window.
+	static void ComputeAntContactEdges(const CExperiment & experiment,
+	                                   std::vector<AntContactEdge> & edges,
+	                                   const Time::ConstPtr & start,
+	                                   const Time::ConstPtr & end,
+	                                   Duration windowSize,
+	                                   Duration maximumGap,
+	                                   const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                   bool splitByType = false,
 	                                   bool singleThread = false);
 
+	// Computes neighbours of ants in each frame
+	// @experiment the <Experiment> to query for
+	// @storeNeighbours a callback for each frame <AntNeighbours>
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @k the number of neighbours to report for each <Ant>, or 0 to
+	//    report all pairs closer than radius.
+	// @radius the maximal distance of a neighbour, in pixels. Ignored
+	//         if zero or less and k is strictly positive.
+	// @singleThread run this query on a single thread
+	//
+	// Reports neighbour relations between <Ant> in each frame, as
+	// columns of an <AntNeighbours>. Positions are indexed spatially
+	// so dense frames are not compared pairwise. This version aimed to be used by
+	// language bindings to avoid large data copy.
+	static void ComputeAntNeighboursFunctor(const CExperiment & experiment,
+	                                        std::function<void (const AntNeighbours::ConstPtr &)> storeNeighbours,
+	                                        const Time::ConstPtr & start,
+	                                        const Time::ConstPtr & end,
+	                                        size_t k,
+	                                        double radius = 0.0,
+	                                        bool singleThread = false);
+
+	// Computes neighbours of ants in each frame
+	// @experiment the <Experiment> to query for
+	// @neighbours the resulting <AntNeighbours>
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @k the number of neighbours to report for each <Ant>, or 0 to
+	//    report all pairs closer than radius.
+	// @radius the maximal distance of a neighbour, in pixels. Ignored
+	//         if zero or less and k is strictly positive.
+	// @singleThread run this query on a single thread
+	//
+	// Reports neighbour relations between <Ant> in each frame, as
+	// columns of an <AntNeighbours>. Positions are indexed spatially
+	// so dense frames are not compared pairwise.
+	static void ComputeAntNeighbours(const CExperiment & experiment,
+	                                 std::vector<AntNeighbours::ConstPtr> & neighbours,
+	                                 const Time::ConstPtr & start,
+	                                 const Time::ConstPtr & end,
+	                                 size_t k,
+	                                 double radius = 0.0,
+	                                 bool singleThread = false);
+
+	// Computes zone entries and exits
+	// @experiment the <Experiment> to query for
+	// @storeTransition a callback for each <AntZoneTransition>
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @debounce the minimal duration an <Ant> should stay in a new
+	//           <Zone> for the change to be reported.
+	// @maximumGap the maximal duration without detection before
+	//             considering the <Ant> lost.
+	// @matcher a <Matcher> to select the <Ant> to report.
+	// @singleThread run this query on a single thread
+	//
+	// Reports when each <Ant> enters or leaves a <Zone>, instead of
+	// the <Zone> of every detection. Every stay is closed by a
+	// transition to <AntZoneTransition::UNDETECTED>, including the
+	// ones still open at the end of the query, which are reported
+	// at the last detection. Transitions of an <Ant> are
+	// reported in time order, but as a change is only confirmed after
+	// debounce, transitions of different <Ant> may be interleaved out
+	// of order. This version aimed to be used by language bindings to
+	// avoid large data copy.
+	static void ComputeAntZoneTransitionsFunctor(const CExperiment & experiment,
+	                                             std::function<void (const AntZoneTransition &)> storeTransition,
+	                                             const Time::ConstPtr & start,
+	                                             const Time::ConstPtr & end,
+	                                             Duration debounce,
+	                                             Duration maximumGap,
+	                                             const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                             bool singleThread = false);
+
+	// Computes zone entries and exits
+	// @experiment the <Experiment> to query for
+	// @transitions the resulting <AntZoneTransition>
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @debounce the minimal duration an <Ant> should stay in a new
+	//           <Zone> for the change to be reported.
+	// @maximumGap the maximal duration without detection before
+	//             considering the <Ant> lost.
+	// @matcher a <Matcher> to select the <Ant> to report.
+	// @singleThread run this query on a single thread
+	//
+	// Reports when each <Ant> enters or leaves a <Zone>, instead of
+	// the <Zone> of every detection. Every stay is closed by a
+	// transition to <AntZoneTransition::UNDETECTED>, including the
+	// ones still open at the end of the query, which are reported
+	// at the last detection. Transitions of an <Ant> are
+	// reported in time order.
+	static void ComputeAntZoneTransitions(const CExperiment & experiment,
+	                                      std::vector<AntZoneTransition> & transitions,
+	                                      const Time::ConstPtr & start,
+	                                      const Time::ConstPtr & end,
+	                                      Duration debounce,
+	                                      Duration maximumGap,
+	                                      const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                      bool singleThread = false);
+
+	// Computes spatial occupancy heatmaps
+	// @experiment the <Experiment> to query for
+	// @storeHeatmap a callback for each computed <AntOccupancyHeatmap>
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @binSize the size of the square bins, in pixels.
+	// @windowSize the duration of the time windows, aligned on
+	//             multiple of windowSize since the Unix epoch. Zero or
+	//             less computes a single heatmap over the whole query.
+	// @perAnt computes an heatmap per <Ant> instead of one for all.
+	// @groupColumn if not empty, computes an heatmap per value of this
+	//              <Ant> metadata column.
+	// @singleThread run this query on a single thread
+	//
+	// Accumulates the position of all detected <Ant> into 2D
+	// histograms per <Space> and time window. Frames are processed in
+	// parallel, in per-thread grids reduced once at the end, so no
+	// <IdentifiedFrame> is kept in memory. Heatmaps are reported
+	// ordered by time window. This version aimed to be used by
+	// language bindings to avoid large data copy.
+	static void ComputeAntOccupancyHeatmapsFunctor(const CExperiment & experiment,
+	                                               std::function<void (const AntOccupancyHeatmap::ConstPtr &)> storeHeatmap,
+	                                               const Time::ConstPtr & start,
+	                                               const Time::ConstPtr & end,
+	                                               double binSize,
+	                                               Duration windowSize,
+	                                               bool perAnt = false,
+	                                               const std::string & groupColumn = "",
+	                                               bool singleThread = false);
+
+	// Computes spatial occupancy heatmaps
+	// @experiment the <Experiment> to query for
+	// @heatmaps the resulting <AntOccupancyHeatmap>
+	// @start the start time for the query use nullptr for the starts
+	//        of the experiment.
+	// @end the end time for the query, use nullptr for the end of the
+	//      experiment
+	// @binSize the size of the square bins, in pixels.
+	// @windowSize the duration of the time windows, aligned on
+	//             multiple of windowSize since the Unix epoch. Zero or
+	//             less computes a single heatmap over the whole query.
+	// @perAnt computes an heatmap per <Ant> instead of one for all.
+	// @groupColumn if not empty, computes an heatmap per value of this
+	//              <Ant> metadata column.
+	// @singleThread run this query on a single thread
+	//
+	// Accumulates the position of all detected <Ant> into 2D
+	// histograms per <Space> and time window. Heatmaps are reported
+	// ordered by time window.
+	static void ComputeAntOccupancyHeatmaps(const CExperiment & experiment,
+	                                        std::vector<AntOccupancyHeatmap::ConstPtr> & heatmaps,
+	                                        const Time::ConstPtr & start,
+	                                        const Time::ConstPtr & end,
+	                                        double binSize,
+	                                        Duration windowSize,
+	                                        bool perAnt = false,
+	                                        const std::string & groupColumn = "",
+	                                        bool singleThread = false);
+
 
 };
 
@@ -1,5 +1,8 @@
 #include "Types.hpp"
 
+#include <limits>
+#include <cmath>
+
 #include "priv/Measurement.hpp"
 
 namespace fort {
@@ -20,6 +23,48 @@ Time AntTrajectory::End() const {
 	return Start.Add(Positions(Positions.rows()-1,0) * Duration::Second);
 }
 
+void AntTrajectory::ComputeKinematics(Duration smoothingWindow) {
+	const size_t n = Positions.rows();
+	Kinematics.setConstant(n,4,std::numeric_limits<double>::quiet_NaN());
+	if ( n < 2 ) {
+		return;
+	}
+	const auto times = Positions.col(0).array();
+	const Eigen::ArrayXd dt = times.tail(n-1) - times.head(n-1);
+	const Eigen::ArrayXd distances = (Positions.block(1,1,n-1,2) - Positions.block(0,1,n-1,2)).rowwise().norm().array();
+	const Eigen::ArrayXd angles = (Positions.col(3).tail(n-1) - Positions.col(3).head(n-1)).array()
+		.unaryExpr([](double a) { return std::remainder(a,2.0 * M_PI); });
+	Kinematics.col(0).tail(n-1) = distances / dt;
+	Kinematics.col(3).tail(n-1) = angles / dt;
+
+	const double halfWindow = smoothingWindow.Seconds() / 2.0;
+	if ( halfWindow <= 0.0 ) {
+		Kinematics.col(1) = Kinematics.col(0);
+	} else {
+		// sliding window over the speeds, which are defined from index 1
+		Eigen::VectorXd cumulated(n);
+		cumulated(0) = 0.0;
+		for ( size_t i = 1; i < n; ++i ) {
+			cumulated(i) = cumulated(i-1) + Kinematics(i,0);
+		}
+		size_t low(1),high(1);
+		for ( size_t i = 0; i < n; ++i ) {
+			while ( low < n && times(low) < times(i) - halfWindow ) {
+				++low;
+			}
+			while ( high < n && times(high) <= times(i) + halfWindow ) {
+				++high;
+			}
+			if ( high > low ) {
+				Kinematics(i,1) = (cumulated(high-1) - cumulated(low-1)) / (high - low);
+			}
+		}
+	}
+	Kinematics.col(2).tail(n-1) = (Kinematics.col(1).tail(n-1) - Kinematics.col(1).head(n-1)).array() / dt;
+}
+
+const ZoneID AntZoneTransition::UNDETECTED = std::numeric_limits<ZoneID>::max();
+
 std::string FormatTagID(TagID tagID) {
 	std::ostringstream oss;
 	oss << "0x" << std::hex << std::setfill('0') << std::setw(3) << tagID;
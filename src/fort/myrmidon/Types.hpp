@@ -194,6 +194,16 @@ struct Collision {
 	// corresponding <Space> is reported in <CollisionFrame>. 0 means
 	// the default zone.
 	ZoneID                       Zone;
+	// Reports the smallest distance between the interacting capsules
+	//
+	// Reports the smallest distance between the surfaces of the
+	// interacting capsules, only computed by queries with a strictly
+	// positive proximity margin, and 0 otherwise. It is negative or
+	// zero when they overlap, and at most the proximity margin of the
+	// query. For capsules whose radius varies along their length, the
+	// radii are taken at the closest points of their segments, which
+	// slightly overestimates the distance.
+	double                       Distance = 0.0;
 };
 
 // Reports all <Collision> happening at a given time.
@@ -238,7 +248,39 @@ struct AntTrajectory {
 	// Optional vector of either size 0 or Data.rows(). O value means
 	// currentlty not in a zone.
 	std::vector<uint32_t>                  Zones;
+	// The number of detections the trajectory was built from.
+	//
+	// It is larger than the number of <Positions> for simplified
+	// trajectories, their compression ratio is `Detections /
+	// Positions.rows()`.
+	size_t                                 Detections = 0;
+	// The largest distance in pixels between a dropped detection and
+	// the simplified trajectory, 0 if not simplified.
+	double                                 MaximumError = 0.0;
+	// The largest angle difference in radians between a dropped
+	// detection and the simplified trajectory, 0 if not simplified.
+	double                                 MaximumAngularError = 0.0;
+	// Reports kinematics derived from <Positions>, if asked.
+	//
+	// Either empty or with as many rows as <Positions>:
+	// * first column: speed from the previous position, in pixels
+	//   per second
+	// * second column: mean speed over a time window centered on the
+	//   position, in pixels per second
+	// * third column: derivative of the mean speed, in pixels per
+	//   second squared
+	// * fourth column: angular velocity from the previous position,
+	//   in radians per second, using the shortest arc.
+	// Values needing a previous position are NaN on the first row.
+	Eigen::Matrix<double,Eigen::Dynamic,4> Kinematics = Eigen::Matrix<double,Eigen::Dynamic,4>(0,4);
+
 	Time End() const;
+
+	// Computes <Kinematics> from <Positions>
+	// @smoothingWindow the duration of the window centered on each
+	//                  position to average the speed on. Zero or less
+	//                  does not average.
+	void ComputeKinematics(Duration smoothingWindow);
 };
 
 // Defines a sub segment of a trajectory
@@ -285,6 +327,160 @@ struct AntInteraction {
 	SpaceID                            Space;
 };
 
+// Summarizes an interaction between two Ants
+//
+// A lightweight alternative to <AntInteraction> that does not hold
+// the trajectories of the two <Ant>.
+struct AntInteractionSummary {
+	// Memory management issue with Eigen
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	// The IDs of the two <Ant>.
+	//
+	// The ID of the two <Ant>. Always reports `IDs.first <
+	// IDs.second`.
+	InteractionID                      IDs;
+	// Virtual shape body part that were in contact.
+	//
+	// Virtual shape body part that were in contact during the
+	// interaction.
+	InteractionTypes                   Types;
+	// Reports the <Time> the interaction starts
+	Time                               Start;
+	// Reports the <Time> the interaction ends
+	Time                               End;
+	// Reports the <SpaceID> where the interaction happend
+	SpaceID                            Space;
+	// The number of frames the two <Ant> were colliding.
+	size_t                             Frames;
+	// Reports the mean position of each <Ant>.
+	//
+	// Reports the mean position of each <Ant> over the frames they
+	// were colliding. Only computed when requested, NaN otherwise.
+	std::pair<Eigen::Vector2d,
+	          Eigen::Vector2d>         MeanPositions;
+};
+
+
+// Summarizes the presence of an <Ant> in a <Zone> during a time bin
+//
+// Each interval between two consecutive detections of an <Ant> is
+// attributed to the <Zone> of its first detection, only if the two
+// detections are in the same <Space> and not more than the query
+// maximum gap apart. An interval spanning several time bins is split
+// between them, assuming a linear motion.
+struct AntZoneSummary {
+	// The <AntID> of the <Ant> this summary refers to.
+	AntID   Ant;
+	// The <Space> of the <Zone>.
+	SpaceID Space;
+	// The <Zone>, 0 means not in any zone.
+	ZoneID  Zone;
+	// The start of the time bin.
+	Time    BinStart;
+	// The time spent in the <Zone>, in seconds.
+	double  DwellTime;
+	// The number of frames the <Ant> was detected in the <Zone>.
+	size_t  Detections;
+	// The distance walked in the <Zone>, in pixels.
+	double  PathLength;
+};
+
+// Aggregates the contacts between two <Ant> during a time window
+//
+// A contact is a sequence of <Collision> between the same two <Ant>
+// with no gap longer than the query maximum gap, as for
+// <AntInteraction>. Time between two consecutive collisions is split
+// between the windows it spans.
+struct AntContactEdge {
+	// The IDs of the two <Ant>, always `IDs.first < IDs.second`.
+	InteractionID                            IDs;
+	// The <AntShapeTypeID> in contact, or (0,0) if contacts are not
+	// split by type.
+	std::pair<AntShapeTypeID,AntShapeTypeID> Types;
+	// The start of the time window.
+	Time                                     WindowStart;
+	// The number of contacts starting in the window.
+	size_t                                   Count;
+	// The total duration of the contacts in the window, in seconds.
+	double                                   TotalDuration;
+	// The number of frames the two <Ant> were in contact.
+	size_t                                   Frames;
+};
+
+// An <Ant> moving from a <Zone> to another
+//
+// Transitions delimit the stays of an <Ant> in a <Zone>. An <Ant>
+// appearing, or re-appearing after not being detected for more than
+// the query maximum gap or in another <Space>, comes from
+// <UNDETECTED>. Symmetrically the end of a stay because of such a
+// gap goes to <UNDETECTED>.
+struct AntZoneTransition {
+	// A pseudo <ZoneID> for an <Ant> that is not detected.
+	const static ZoneID UNDETECTED;
+
+	// The <AntID> of the <Ant>.
+	AntID   Ant;
+	// The <Space> of the <Zone>.
+	SpaceID Space;
+	// The <Zone> the <Ant> leaves, 0 means not in any zone.
+	ZoneID  From;
+	// The <Zone> the <Ant> enters, 0 means not in any zone.
+	ZoneID  To;
+	// The time of the first frame in the new <Zone>, or of the last
+	// frame in the previous one if To is <UNDETECTED>.
+	Time    FrameTime;
+};
+
+// Neighbour relations between <Ant> in a frame
+//
+// Relations are stored in columns, one row per relation. For a k
+// nearest neighbours query, each <Ant> has up to k rows ordered by
+// increasing distance, and <Ant> are ordered by <AntID>. For a
+// radius query, each pair within the radius is reported once, with
+// `IDs(i,0) < IDs(i,1)`, in lexicographic order.
+struct AntNeighbours {
+	// A pointer to the relations
+	typedef std::shared_ptr<AntNeighbours>       Ptr;
+	// A const pointer to the relations
+	typedef std::shared_ptr<const AntNeighbours> ConstPtr;
+
+	// The <Time> of the frame.
+	Time                                      FrameTime;
+	// The <Space> of the frame.
+	SpaceID                                   Space;
+	// The <AntID> of the <Ant> and its neighbour.
+	Eigen::Matrix<AntID,Eigen::Dynamic,2>     IDs;
+	// The distance between the two <Ant>, in pixels.
+	Eigen::VectorXd                           Distances;
+};
+
+// A 2D histogram of <Ant> positions in a <Space>
+struct AntOccupancyHeatmap {
+	// A pointer to an heatmap
+	typedef std::shared_ptr<const AntOccupancyHeatmap> ConstPtr;
+	// The histogram counts
+	typedef Eigen::Matrix<uint32_t,Eigen::Dynamic,Eigen::Dynamic> Counts;
+
+	// The <Space> the positions are taken from.
+	SpaceID        Space;
+	// The <AntID> for per-ant heatmaps, 0 otherwise.
+	AntID          Ant;
+	// The metadata value of the <Ant> for per-group heatmaps, `false`
+	// otherwise.
+	AntStaticValue Group;
+	// The start of the time window.
+	Time           WindowStart;
+	// The size of the square bins, in pixels.
+	double         BinSize;
+	// The number of detections in each bin.
+	//
+	// Row `i` and column `j` counts the positions with a Y coordinate
+	// in `[i*BinSize,(i+1)*BinSize[` and a X coordinate in
+	// `[j*BinSize,(j+1)*BinSize[`. It covers the whole frame, and
+	// is extended to any detection outside of it. Detections with
+	// negative coordinates are dropped.
+	Counts         Detections;
+};
 
 // Reports information about a tracking data directory.
 struct TrackingDataDirectoryInfo {
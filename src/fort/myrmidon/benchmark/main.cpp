@@ -8,6 +8,9 @@
 #include <fort/myrmidon/utils/FileSystem.hpp>
 #include <fort/myrmidon/priv/Capsule.hpp>
 #include <fort/myrmidon/priv/KDTree.hpp>
+#include <fort/myrmidon/priv/Identification.hpp>
+#include <fort/myrmidon/priv/Isometry2D.hpp>
+#include <fort/myrmidon/priv/SegmentIndexer.hpp>
 
 #include <fstream>
 
@@ -163,7 +166,122 @@ void BenchmarkKDTreeBuilding( const fs::path &  result) {
 }
 
 
+void BenchmarkFrozenIndexes( const fs::path & result ) {
+	std::cerr << "*****************************************" << std::endl;
+	std::cerr << "*   F R O Z E N   T I M E   I N D E X   *" << std::endl;
+	std::cerr << "*****************************************" << std::endl;
 
+	std::vector<size_t> Numbers = {10,100,1000,10000,100000};
+	const size_t NB_LOOKUPS = 1000000;
+	std::random_device r;
+	std::default_random_engine e1(r());
+	std::ofstream out(result.c_str());
+	out << "#Number,SegmentMap(ns),SegmentFrozen(ns)" << std::endl;
+
+	auto perLookup = [NB_LOOKUPS](const Time & start, const Time & end) {
+		                 return double(end.Sub(start).Nanoseconds()) / NB_LOOKUPS;
+	                 };
+
+	for ( const auto & n : Numbers ) {
+		std::cerr << " -- N: " << n << std::endl;
+		SegmentIndexer<std::string> segments;
+		for ( size_t i = 0; i < n; ++i ) {
+			auto t = Time::FromTimeT(10 * i + 1);
+			segments.Insert(FrameReference("",10 * i + 1,t),std::to_string(i));
+		}
+
+		std::uniform_int_distribution<uint64_t> frameDist(1, 10 * n);
+		std::vector<uint64_t> frames(NB_LOOKUPS);
+		std::vector<Time> times;
+		times.reserve(NB_LOOKUPS);
+		for ( auto & f : frames ) {
+			f = frameDist(e1);
+			times.push_back(Time::FromTimeT(f));
+		}
+
+		// avoids the compiler to optimize lookups away
+		size_t sum = 0;
+		auto measure =
+			[&]() {
+				auto start = Time::Now();
+				for ( size_t i = 0; i < NB_LOOKUPS; ++i ) {
+					sum += segments.Find(frames[i]).first.FrameID();
+					sum += segments.Find(times[i]).second.size();
+				}
+				return perLookup(start,Time::Now());
+			};
+
+		auto mapTimes = measure();
+		segments.Freeze();
+		auto frozenTimes = measure();
+
+		std::cerr << " ---- SegmentIndexer: " << mapTimes << "ns frozen: " << frozenTimes << "ns (" << sum << ")" << std::endl;
+		out << n
+		    << "," << mapTimes
+		    << "," << frozenTimes
+		    << std::endl;
+	}
+}
+
+
+void BenchmarkPositionsFromTags( const fs::path & result ) {
+	std::cerr << "*********************************************" << std::endl;
+	std::cerr << "*   P O S I T I O N S   F R O M   T A G S   *" << std::endl;
+	std::cerr << "*********************************************" << std::endl;
+
+	std::vector<size_t> Numbers = {10,50,100,500,1000,5000};
+	const size_t NB_POSES = 10000000;
+	std::random_device r;
+	std::default_random_engine e1(r());
+	std::uniform_real_distribution<double> positionDist(0.0,2000.0);
+	std::uniform_real_distribution<double> offsetDist(-20.0,20.0);
+	std::uniform_real_distribution<double> angleDist(-M_PI,M_PI);
+	std::ofstream out(result.c_str());
+	out << "#Number,Isometry(ns),Batch(ns)" << std::endl;
+
+	for ( const auto & n : Numbers ) {
+		std::cerr << " -- N: " << n << std::endl;
+		Identification::PoseBatch tags,antToTags,ants;
+		std::vector<Isometry2Dd> isometries;
+		for ( size_t i = 0; i < n; ++i ) {
+			tags.X.push_back(positionDist(e1));
+			tags.Y.push_back(positionDist(e1));
+			tags.Angle.push_back(angleDist(e1));
+			antToTags.X.push_back(offsetDist(e1));
+			antToTags.Y.push_back(offsetDist(e1));
+			antToTags.Angle.push_back(angleDist(e1));
+			isometries.push_back(Isometry2Dd(antToTags.Angle.back(),
+			                                 Eigen::Vector2d(antToTags.X.back(),antToTags.Y.back())));
+		}
+		const size_t nbFrames = NB_POSES / n;
+		auto perPose = [nbFrames,n](const Time & start, const Time & end) {
+			               return double(end.Sub(start).Nanoseconds()) / (nbFrames * n);
+		               };
+
+		// avoids the compiler to optimize computations away
+		double sum = 0.0;
+		// as Identification::ComputePositionFromTag
+		auto start = Time::Now();
+		for ( size_t f = 0; f < nbFrames; ++f ) {
+			for ( size_t i = 0; i < n; ++i ) {
+				auto antToOrig = Isometry2Dd(tags.Angle[i],Eigen::Vector2d(tags.X[i],tags.Y[i])) * isometries[i];
+				sum += antToOrig.translation().x() + antToOrig.angle();
+			}
+		}
+		auto middle = Time::Now();
+		for ( size_t f = 0; f < nbFrames; ++f ) {
+			Identification::ComputePositionsFromTags(ants,tags,antToTags);
+			sum += ants.X[f % n] + ants.Angle[f % n];
+		}
+		auto end = Time::Now();
+
+		std::cerr << " ---- Isometry: " << perPose(start,middle) << "ns batch: " << perPose(middle,end) << "ns (" << sum << ")" << std::endl;
+		out << n
+		    << "," << perPose(start,middle)
+		    << "," << perPose(middle,end)
+		    << std::endl;
+	}
+}
 
 }
 }
@@ -180,6 +298,10 @@ void Execute(int argc, char ** argv) {
 		throw std::invalid_argument(dirpath.string() + " is not a directory");
 	}
 
+	fmp::BenchmarkFrozenIndexes(dirpath / "frozen_indexes.txt");
+
+	fmp::BenchmarkPositionsFromTags(dirpath / "positions_from_tags.txt");
+
 	fmp::BenchmarkKDTreeBuilding(dirpath / "benchmark_kdtree.txt");
 
 	fmp::BenchmarkAABBCollisionDetection(dirpath / "aabb_collision.txt");
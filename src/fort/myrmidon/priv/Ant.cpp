@@ -1,6 +1,7 @@
 #include "Ant.hpp"
 
 #include <sstream>
+#include <algorithm>
 #include <iomanip>
 
 #include "AntShapeType.hpp"
@@ -89,7 +90,30 @@ Ant::DisplayState Ant::DisplayStatus() const {
 
 const AntStaticValue & Ant::GetValue(const std::string & name,
                                      const Time & time) const {
-	return d_compiledData.At(name,time);
+	return GetValue(d_metadata->ColumnIDOf(name),time.SortKey());
+}
+
+const AntStaticValue & Ant::GetValue(AntMetadata::ColumnID column,
+                                     const Time::SortableKey & time) const {
+	const auto & compiled = CompiledValues(column);
+	auto fi = std::upper_bound(compiled.Times.begin(),
+	                           compiled.Times.end(),
+	                           time);
+	if ( fi == compiled.Times.begin() ) {
+		throw std::out_of_range("Invalid time");
+	}
+	return compiled.Values[fi - compiled.Times.begin() - 1];
+}
+
+AntMetadata::ColumnID Ant::ColumnIDOf(const std::string & name) const {
+	return d_metadata->ColumnIDOf(name);
+}
+
+const Ant::CompiledColumn & Ant::CompiledValues(AntMetadata::ColumnID column) const {
+	if ( column >= d_compiledData.size() || d_compiledData[column].Times.empty() ) {
+		throw std::out_of_range("Invalid column");
+	}
+	return d_compiledData[column];
 }
 
 AntStaticValue Ant::GetBaseValue(const std::string & name) const {
@@ -196,25 +220,27 @@ const AntConstDataMap & Ant::CDataMap() const {
 }
 
 void Ant::CompileData() {
-	std::map<std::string,AntStaticValue> defaults;
-	for ( const auto & [name,column] : d_metadata->CColumns() ) {
-		defaults.insert(std::make_pair(name,column->DefaultValue()));
-	}
-	d_compiledData.Clear();
+	d_compiledData.clear();
+	d_compiledData.resize(d_metadata->ColumnIDBound());
 
-	for ( const auto & [name,tValues] : d_data ) {
-		for ( const auto & [time,value] : tValues ) {
-			if ( !time ) {
-				defaults.erase(name);
-			}
-			d_compiledData.Insert(name,value,time);
+	for ( const auto & [name,column] : d_metadata->CColumns() ) {
+		auto & compiled = d_compiledData[column->ID()];
+		auto fi = d_data.find(name);
+		// values are sorted, the base value, if any, comes first
+		if ( fi == d_data.end()
+		     || fi->second.empty()
+		     || !fi->second.front().first == false ) {
+			compiled.Times.push_back(Time::SortKey(Time::ConstPtr()));
+			compiled.Values.push_back(column->DefaultValue());
+		}
+		if ( fi == d_data.end() ) {
+			continue;
+		}
+		for ( const auto & [time,value] : fi->second ) {
+			compiled.Times.push_back(Time::SortKey(time));
+			compiled.Values.push_back(value);
 		}
 	}
-
-	for ( const auto & [name,defaultValue] : defaults ) {
-		d_compiledData.Insert(name,defaultValue,Time::ConstPtr());
-	}
-
 }
 
 
@@ -10,7 +10,7 @@
 
 #include "Identification.hpp"
 
-#include "TimeMap.hpp"
+#include "AntMetadata.hpp"
 
 #include "Capsule.hpp"
 
@@ -130,6 +130,39 @@ public:
 	const AntStaticValue & GetValue(const std::string & name,
 	                                const Time & time) const;
 
+	// The compiled values of a metadata column
+	//
+	// Values[i] is valid from Times[i] until Times[i+1]. Times[0]
+	// is always -∞.
+	struct CompiledColumn {
+		std::vector<Time::SortableKey> Times;
+		std::vector<AntStaticValue>    Values;
+	};
+
+	// Gets a metadata value through its interned <ColumnID>
+	// @column the <AntMetadata::ColumnID> of the column
+	// @time the time to query the value for
+	//
+	// Faster than <GetValue> by name, as it does not need to look up
+	// the column.
+	// @return the value of the column at time
+	const AntStaticValue & GetValue(AntMetadata::ColumnID column,
+	                                const Time::SortableKey & time) const;
+
+	// Gets all compiled values of a column
+	// @column the <AntMetadata::ColumnID> of the column
+	//
+	// @return the <CompiledColumn> for column, or throws
+	//         std::out_of_range if it does not exists.
+	const CompiledColumn & CompiledValues(AntMetadata::ColumnID column) const;
+
+	// Interns a metadata column name
+	// @name the name of the column
+	//
+	// @return the <AntMetadata::ColumnID> for name, or throws
+	//         std::out_of_range if it does not exists.
+	AntMetadata::ColumnID ColumnIDOf(const std::string & name) const;
+
 	void SetValue(const std::string & name,
 	              const AntStaticValue & value,
 	              const Time::ConstPtr & time,
@@ -180,7 +213,8 @@ private:
 	AntMetadataConstPtr           d_metadata;
 
 	AntDataMap                          d_data;
-	TimeMap<std::string,AntStaticValue> d_compiledData;
+	// indexed by <AntMetadata::ColumnID>
+	std::vector<CompiledColumn>         d_compiledData;
 };
 
 } //namespace priv
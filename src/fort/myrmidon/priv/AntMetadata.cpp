@@ -24,7 +24,7 @@ AntMetadata::Column::Ptr AntMetadata::Create(const Ptr & itself,
                                              AntMetadata::Type type) {
 	itself->CheckName(name);
 
-	auto res = std::make_shared<AntMetadata::Column>(itself,name,type);
+	auto res = std::make_shared<AntMetadata::Column>(itself,name,type,itself->d_nextColumnID++);
 	itself->d_columns.insert(std::make_pair(name,res));
 	return res;
 }
@@ -38,7 +38,8 @@ void AntMetadata::Delete(const std::string & name) {
 }
 
 AntMetadata::AntMetadata()
-	: d_onNameChange([](const std::string &, const std::string) {} )
+	: d_nextColumnID(0)
+	, d_onNameChange([](const std::string &, const std::string) {} )
 	, d_onTypeChange([](const std::string &, Type, Type) {} )
 	, d_onDefaultChange([](const std::string &, const AntStaticValue &, const AntStaticValue &) {} ) {
 }
@@ -46,7 +47,8 @@ AntMetadata::AntMetadata()
 AntMetadata::AntMetadata(const NameChangeCallback & onNameChange,
                          const TypeChangeCallback & onTypeChange,
                          const DefaultChangeCallback & onDefaultChange )
-	: d_onNameChange(onNameChange)
+	: d_nextColumnID(0)
+	, d_onNameChange(onNameChange)
 	, d_onTypeChange(onTypeChange)
 	, d_onDefaultChange(onDefaultChange) {
 }
@@ -63,6 +65,18 @@ size_t AntMetadata::Count(const std::string & name) const {
 	return d_columns.count(name);
 }
 
+AntMetadata::ColumnID AntMetadata::ColumnIDOf(const std::string & name) const {
+	auto fi = d_columns.find(name);
+	if ( fi == d_columns.end() ) {
+		throw std::out_of_range("Unknown column '" + name + "'");
+	}
+	return fi->second->ID();
+}
+
+AntMetadata::ColumnID AntMetadata::ColumnIDBound() const {
+	return d_nextColumnID;
+}
+
 
 AntMetadata::Validity AntMetadata::Validate(Type type, const std::string & value) {
 	std::vector<std::function< Validity (const std::string & value) > > validators =
@@ -231,11 +245,17 @@ AntStaticValue AntMetadata::DefaultValue(Type type) {
 
 AntMetadata::Column::Column(const std::weak_ptr<AntMetadata> & metadata,
                             const std::string & name,
-                            AntMetadata::Type type)
+                            AntMetadata::Type type,
+                            ColumnID ID)
 	: d_metadata(metadata)
 	, d_name(name)
 	, d_type(type)
-	, d_default(AntMetadata::DefaultValue(type)) {
+	, d_default(AntMetadata::DefaultValue(type))
+	, d_ID(ID) {
+}
+
+AntMetadata::ColumnID AntMetadata::Column::ID() const {
+	return d_ID;
 }
 
 const AntStaticValue & AntMetadata::Column::DefaultValue() const {
@@ -23,6 +23,10 @@ public:
 	                     Invalid = 2,
 	};
 
+	// An interned, experiment-wide, identifier for a Column. It
+	// stays the same when the column is renamed.
+	typedef uint32_t ColumnID;
+
 	class Column {
 	public:
 		typedef std::shared_ptr<Column>       Ptr;
@@ -31,7 +35,10 @@ public:
 
 		Column(const std::weak_ptr<AntMetadata> & metadata,
 		       const std::string & name,
-		       Type type);
+		       Type type,
+		       ColumnID ID);
+
+		ColumnID ID() const;
 
 		const std::string & Name() const;
 		void SetName(const std::string & name);
@@ -47,6 +54,7 @@ public:
 		std::string                d_name;
 		Type                       d_type;
 		AntStaticValue             d_default;
+		ColumnID                   d_ID;
 	};
 
 	typedef std::map<std::string,Column::Ptr>      ColumnByName;
@@ -81,12 +89,24 @@ public:
 	const ColumnByName & Columns();
 	const ConstColumnByName & CColumns() const;
 
+	// Gets the ColumnID of a Column
+	// @name the name of the column
+	//
+	// @return the <ColumnID> of the column, or throws
+	//         std::out_of_range if it does not exists.
+	ColumnID ColumnIDOf(const std::string & name) const;
+
+	// All <ColumnID> are strictly smaller than this bound
+	// @return an upper bound of all <ColumnID>
+	ColumnID ColumnIDBound() const;
+
 private:
 	static AntStaticValue DefaultValue(Type type);
 
 	void CheckName(const std::string & name) const;
 
 	ColumnByName          d_columns;
+	ColumnID              d_nextColumnID;
 	NameChangeCallback    d_onNameChange;
 	TypeChangeCallback    d_onTypeChange;
 	DefaultChangeCallback d_onDefaultChange;
@@ -78,6 +78,33 @@ TEST_F(AntUTest,StaticDataTest) {
 
 }
 
+TEST_F(AntUTest,InternedDataAccess) {
+	AntMetadata::ColumnID dead,group;
+	ASSERT_NO_THROW({
+			dead = ant->ColumnIDOf("dead");
+			group = ant->ColumnIDOf("group");
+		});
+	EXPECT_NE(dead,group);
+	EXPECT_THROW(ant->ColumnIDOf("isQueen"),std::out_of_range);
+
+	ASSERT_NO_THROW({
+			ant->SetValue("dead",true,std::make_shared<Time>(Time::FromTimeT(42)));
+			ant->SetValue("group",std::string("forager"),Time::ConstPtr());
+		});
+
+	for ( const auto & t : {Time::FromTimeT(41),Time::FromTimeT(42),Time::FromTimeT(43)} ) {
+		EXPECT_EQ(ant->GetValue(dead,t.SortKey()),ant->GetValue("dead",t));
+		EXPECT_EQ(ant->GetValue(group,t.SortKey()),ant->GetValue("group",t));
+	}
+	EXPECT_EQ(ant->CompiledValues(dead).Times.size(),2);
+	EXPECT_EQ(ant->CompiledValues(group).Times.size(),1);
+	EXPECT_THROW(ant->CompiledValues(group+1),std::out_of_range);
+
+	// IDs are stable through renaming
+	antMetadata->Columns().at("group")->SetName("social-group");
+	EXPECT_EQ(ant->ColumnIDOf("social-group"),group);
+}
+
 TEST_F(AntUTest,IDFormatting) {
 	std::vector<std::pair<AntID,std::string>> testdata
 		= {
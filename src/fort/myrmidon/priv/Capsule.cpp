@@ -1,5 +1,7 @@
 #include "Capsule.hpp"
 
+#include <limits>
+
 namespace fort {
 namespace myrmidon {
 namespace priv {
@@ -99,6 +101,55 @@ bool Capsule::Intersect(const Eigen::Vector2d & aC1,
 	intersect(aC2,bC1,bCC,bR1,bR2,aR2);
 
 	return false;
+#undef intersect
+}
+
+double Capsule::Distance(const Eigen::Vector2d & aC1,
+                         const Eigen::Vector2d & aC2,
+                         double aR1,
+                         double aR2,
+                         const Eigen::Vector2d & bC1,
+                         const Eigen::Vector2d & bC2,
+                         double bR1,
+                         double bR2) {
+	// If the segments do not cross, the closest points of the two
+	// segments include an end point, so we use the smallest distance
+	// between the four capsule centers projected on the other capsule
+	// segment. The radius is interpolated at these points, which is
+	// only approximate for capsules of varying radius.
+	Eigen::Vector2d aCC = aC2 - aC1;
+	Eigen::Vector2d bCC = bC2 - bC1;
+
+	// crossing segments, the surfaces are the sum of the radii at the
+	// crossing point apart.
+	const double denom = aCC.x() * bCC.y() - aCC.y() * bCC.x();
+	if ( denom != 0.0 ) {
+		const Eigen::Vector2d ab = bC1 - aC1;
+		const double s = (ab.x() * bCC.y() - ab.y() * bCC.x()) / denom;
+		const double u = (ab.x() * aCC.y() - ab.y() * aCC.x()) / denom;
+		if ( s >= 0.0 && s <= 1.0 && u >= 0.0 && u <= 1.0 ) {
+			return -(aR1 + s * (aR2 - aR1) + bR1 + u * (bR2 - bR1));
+		}
+	}
+
+	Eigen::Vector2d proj;
+	double t;
+	double res = std::numeric_limits<double>::max();
+
+#define distance(point,startSegment,segment,pRadius1,pRadius2,radius) do {	  \
+		constraintToSegment(t,proj,point,startSegment,segment); \
+		double sumRadius = pRadius1 + t * (pRadius2 - pRadius1) + radius; \
+		res = std::min(res,(proj-point).norm() - sumRadius); \
+	}while(0)
+
+	distance(bC1,aC1,aCC,aR1,aR2,bR1);
+	distance(bC2,aC1,aCC,aR1,aR2,bR2);
+	distance(aC1,bC1,bCC,bR1,bR2,aR1);
+	distance(aC2,bC1,bCC,bR1,bR2,aR2);
+
+	return res;
+#undef distance
+#undef constraintToSegment
 }
 
 bool Capsule::Contains(const Eigen::Vector2d & point) const {
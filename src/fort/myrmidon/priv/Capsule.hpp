@@ -73,8 +73,31 @@ public:
 	}
 
 
+	// Distance between the surfaces of two capsules
+	// @other the other capsule
+	//
+	// It is the distance between the two segments minus the radii at
+	// their closest points, exact for capsules of constant radius.
+	// For crossing segments, it is minus the sum of the radii at the
+	// crossing point. It is non-positive when <Intersects> reports a
+	// collision.
+	// @return the distance, negative if the capsules overlap
+	inline double Distance(const Capsule & other) const {
+		return Distance(d_c1,d_c2,d_r1,d_r2,
+		                other.d_c1,other.d_c2,other.d_r1,other.d_r2);
+	}
+
 	AABB ComputeAABB() const override;
 
+	static double Distance(const Eigen::Vector2d & aC1,
+	                       const Eigen::Vector2d & aC2,
+	                       double aR1,
+	                       double aR2,
+	                       const Eigen::Vector2d & bC1,
+	                       const Eigen::Vector2d & bC2,
+	                       double bR1,
+	                       double bR2);
+
 	static bool Intersect(const Eigen::Vector2d & aC1,
 	                      const Eigen::Vector2d & aC2,
 	                      double aR1,
@@ -114,10 +114,34 @@ TEST_F(CapsuleUTest,TestCaspuleCollision) {
 		bool res = Capsule::Intersect(a.C1(),a.C2(),a.R1(),a.R2(),
 		                              b.C1(),b.C2(),b.R1(),b.R2());
 		EXPECT_EQ(res,d.Expected) << " Intersecting " << a << " and " << b;
+		EXPECT_EQ(a.Distance(b) <= 0.0,d.Expected) << " Distance between " << a << " and " << b;
 	}
 
 }
 
+TEST_F(CapsuleUTest,Distance) {
+	Capsule a(Eigen::Vector2d(0,0),Eigen::Vector2d(0,1),0.25,0.25);
+	Capsule b(Eigen::Vector2d(1,0),Eigen::Vector2d(1,1),0.25,0.25);
+	EXPECT_NEAR(a.Distance(b),0.5,1.0e-9);
+	EXPECT_NEAR(b.Distance(a),0.5,1.0e-9);
+
+	Capsule c(Eigen::Vector2d(0,2),Eigen::Vector2d(0,3),0.25,0.5);
+	EXPECT_NEAR(a.Distance(c),0.5,1.0e-9);
+
+	Capsule d(Eigen::Vector2d(0.25,0),Eigen::Vector2d(0.25,1),0.25,0.25);
+	EXPECT_NEAR(a.Distance(d),-0.25,1.0e-9);
+
+	// crossing like an X, no end point is close to the other segment
+	Capsule e(Eigen::Vector2d(-10,-10),Eigen::Vector2d(10,10),1.0,1.0);
+	Capsule f(Eigen::Vector2d(-10,10),Eigen::Vector2d(10,-10),1.0,3.0);
+	EXPECT_NEAR(e.Distance(f),-3.0,1.0e-9);
+	EXPECT_NEAR(f.Distance(e),-3.0,1.0e-9);
+
+	// parallel, not crossing
+	Capsule g(Eigen::Vector2d(-10,-8),Eigen::Vector2d(10,12),1.0,1.0);
+	EXPECT_NEAR(e.Distance(g),std::sqrt(2.0) - 2.0,1.0e-9);
+}
+
 
 
 
@@ -1,7 +1,12 @@
 #include "CollisionSolver.hpp"
 
+#include <tbb/parallel_for.h>
+#include <tbb/enumerable_thread_specific.h>
+
 #include "Space.hpp"
 #include "Capsule.hpp"
+#include "Circle.hpp"
+#include "Polygon.hpp"
 #include "AntShapeType.hpp"
 #include "KDTree.hpp"
 
@@ -9,88 +14,235 @@ namespace fort {
 namespace myrmidon {
 namespace priv {
 
+const size_t CollisionSolver::DEFAULT_PARALLEL_THRESHOLD = 1000;
+
 CollisionSolver::CollisionSolver(const SpaceByID & spaces,
-                                 const AntByID & ants) {
+                                 const AntByID & ants,
+                                 size_t parallelThreshold)
+	: d_parallelThreshold(parallelThreshold) {
 
 	for ( const auto & [aID,ant] : ants ) {
 		d_antGeometries.insert(std::make_pair(aID,ant->Capsules()));
 	}
 
 	for ( const auto & [spaceID,space] : spaces ) {
-		auto res = d_spaceGeometries.insert(std::make_pair(spaceID,TimedZoneGeometries()));
-		d_zoneIDs.insert(std::make_pair(spaceID,std::vector<ZoneID>()));
-		auto & geometries = res.first->second;
-		for ( const auto & [zID,zone] : space->Zones() ) {
-			d_zoneIDs.at(spaceID).push_back(zID);
-			Time::ConstPtr last;
-			for ( const auto & definition : zone->Definitions() ) {
-				if ( Time::SortKey(definition->Start()) != Time::SortKey(last) ) {
-					geometries.Insert(zID,{},last);
+		d_zoners.insert(std::make_pair(spaceID,ComputeZoners(*space)));
+	}
+}
+
+CollisionSolver::TimedZoners CollisionSolver::ComputeZoners(const Space & space) {
+	typedef std::pair<Time::SortableKey,Time::SortableKey> Range;
+	const static auto infinity = std::make_pair(std::numeric_limits<int64_t>::max(),
+	                                            std::numeric_limits<int32_t>::max());
+	std::vector<std::pair<ZoneID,std::vector<std::pair<Range,Zone::Geometry::ConstPtr>>>> definitions;
+	std::set<Time::SortableKey> boundaries = { Time::SortKey(Time::ConstPtr()) };
+	for ( const auto & [zID,zone] : space.CZones() ) {
+		definitions.push_back(std::make_pair(zID,std::vector<std::pair<Range,Zone::Geometry::ConstPtr>>()));
+		for ( const auto & definition : zone->CDefinitions() ) {
+			auto start = Time::SortKey(definition->Start());
+			auto end = !definition->End() ? infinity : definition->End()->SortKey();
+			boundaries.insert(start);
+			boundaries.insert(end);
+			definitions.back().second.push_back(std::make_pair(std::make_pair(start,end),
+			                                                   definition->GetGeometry()));
+		}
+	}
+	boundaries.erase(infinity);
+
+	TimedZoners res;
+	AntZoner::ZoneGeometries last;
+	for ( const auto & start : boundaries ) {
+		AntZoner::ZoneGeometries current;
+		for ( const auto & [zID,zoneDefinitions] : definitions ) {
+			for ( const auto & [range,geometry] : zoneDefinitions ) {
+				if ( start >= range.first && start < range.second ) {
+					current.push_back(std::make_pair(zID,geometry));
+					break;
 				}
-				last = definition->End();
-				geometries.Insert(zID,definition->GetGeometry(),definition->Start());
-			}
-			if ( !last ) {
-				geometries.Insert(zID,{},last);
 			}
 		}
+		if ( res.Zoners.empty() == false && current == last ) {
+			continue;
+		}
+		res.Starts.push_back(start);
+		res.Zoners.push_back(std::make_shared<AntZoner>(current));
+		last = std::move(current);
 	}
+	return res;
 }
 
 CollisionFrame::ConstPtr
-CollisionSolver::ComputeCollisions(const IdentifiedFrame::Ptr & frame) const {
+CollisionSolver::ComputeCollisions(const IdentifiedFrame::Ptr & frame,
+                                   const InteractionTypeSet * types,
+                                   double margin) const {
+	auto res = std::make_shared<CollisionFrame>();
+	ComputeCollisions(*res,frame,types,margin);
+	return res;
+}
+
+void CollisionSolver::ComputeCollisions(CollisionFrame & result,
+                                        const IdentifiedFrame::Ptr & frame,
+                                        const InteractionTypeSet * types,
+                                        double margin) const {
 	LocatedAnts locatedAnts;
 	LocateAnts(locatedAnts,frame);
-	auto res = std::make_shared<CollisionFrame>();
-	res->FrameTime = frame->FrameTime;
-	res->Space = frame->Space;
+	result.FrameTime = frame->FrameTime;
+	result.Space = frame->Space;
+	result.Collisions.clear();
 	for ( const auto & [zID,ants] : locatedAnts ) {
-		ComputeCollisions(res->Collisions,ants,zID);
+		ComputeCollisions(result.Collisions,ants,zID,types,margin);
 	}
-	return res;
 }
 
 
-AntZoner::ConstPtr CollisionSolver::ZonerFor(const IdentifiedFrame::ConstPtr & frame) const {
-	if ( d_spaceGeometries.count(frame->Space) == 0) {
+const AntZoner::ConstPtr & CollisionSolver::ZonerFor(const IdentifiedFrame::ConstPtr & frame) const {
+	auto fi = d_zoners.find(frame->Space);
+	if ( fi == d_zoners.end() ) {
 		throw std::invalid_argument("Unknown SpaceID " + std::to_string(frame->Space) + " in IdentifiedFrame");
 	}
-	const auto & allGeometries = d_spaceGeometries.at(frame->Space);
+	const auto & zoners = fi->second;
+	auto ti = std::upper_bound(zoners.Starts.begin(),
+	                           zoners.Starts.end(),
+	                           frame->FrameTime.SortKey());
+	// Starts.front() is -∞, ti is never begin()
+	return zoners.Zoners[ti - zoners.Starts.begin() - 1];
+}
 
-	// first we build geometries for the right time;
-	std::vector<std::pair<ZoneID,Zone::Geometry::ConstPtr> > currentGeometries;
-	for ( const auto & zID : d_zoneIDs.at(frame->Space) ) {
-		try {
-			currentGeometries.push_back(std::make_pair(zID,allGeometries.At(zID,frame->FrameTime)));
-		} catch ( const std::exception & e ) {
-			continue;
+
+const size_t AntZoner::GRID_SIZE = 32;
+
+AntZoner::AntZoner(const ZoneGeometries & zoneGeometries)
+	: d_zoneGeometries(zoneGeometries) {
+	for ( size_t i = 0; i < d_zoneGeometries.size(); ++i ) {
+		const auto & geometry = d_zoneGeometries[i].second;
+		const auto & shapes = geometry->Shapes();
+		const auto & AABBs = geometry->IndividualAABB();
+		for ( size_t j = 0; j < shapes.size(); ++j ) {
+			d_shapes.push_back({.S = shapes[j].get(),
+			                    .Type = shapes[j]->ShapeType(),
+			                    .ZoneIndex = i,
+			                    .Volume = AABBs[j]});
+			d_bounds.extend(AABBs[j]);
+		}
+	}
+	if ( d_shapes.empty() == true ) {
+		return;
+	}
+	d_cellSize = (d_bounds.sizes() / GRID_SIZE).cwiseMax(std::numeric_limits<double>::epsilon());
+	d_cellZones.reserve(GRID_SIZE * GRID_SIZE);
+	d_cellOffsets.reserve(GRID_SIZE * GRID_SIZE + 1);
+	d_cellOffsets.push_back(0);
+	for ( size_t y = 0; y < GRID_SIZE; ++y ) {
+		for ( size_t x = 0; x < GRID_SIZE; ++x ) {
+			BuildCell(x,y);
 		}
 	}
-	return std::make_shared<AntZoner>(currentGeometries);
 }
 
+void AntZoner::BuildCell(size_t x, size_t y) {
+	// slightly inflates the cell to be robust to rounding errors
+	// when locating a point.
+	Eigen::Vector2d margin = 1.0e-6 * d_cellSize;
+	Eigen::Vector2d cellMin = d_bounds.min() + d_cellSize.cwiseProduct(Eigen::Vector2d(x,y));
+	AABB cell(cellMin - margin,cellMin + d_cellSize + margin);
 
-AntZoner::AntZoner(const ZoneGeometries & zoneGeometries)
-	: d_zoneGeometries(zoneGeometries) {
+	size_t coveringZone = d_zoneGeometries.size();
+	for ( const auto & shape : d_shapes ) {
+		if ( shape.ZoneIndex >= coveringZone ) {
+			break;
+		}
+		if ( shape.Volume.intersects(cell) && Covers(shape,cell) ) {
+			coveringZone = shape.ZoneIndex;
+		}
+	}
+
+	for ( uint32_t i = 0; i < d_shapes.size(); ++i ) {
+		const auto & shape = d_shapes[i];
+		if ( shape.ZoneIndex >= coveringZone ) {
+			break;
+		}
+		if ( shape.Volume.intersects(cell) ) {
+			d_candidates.push_back(i);
+		}
+	}
+	d_cellZones.push_back(coveringZone);
+	d_cellOffsets.push_back(d_candidates.size());
+}
+
+bool AntZoner::Contains(const IndexedShape & shape,
+                        const Eigen::Vector2d & point) {
+	switch(shape.Type) {
+	case Shape::Type::Circle:
+		return static_cast<const Circle*>(shape.S)->Circle::Contains(point);
+	case Shape::Type::Capsule:
+		return static_cast<const Capsule*>(shape.S)->Capsule::Contains(point);
+	case Shape::Type::Polygon:
+		return static_cast<const Polygon*>(shape.S)->Polygon::Contains(point);
+	}
+	return false;
+}
+
+bool AntZoner::Covers(const IndexedShape & shape,
+                      const AABB & cell) {
+	const static AABB::CornerType corners[4] = {AABB::BottomLeft,AABB::BottomRight,
+	                                            AABB::TopRight,AABB::TopLeft};
+	for ( const auto & c : corners ) {
+		if ( Contains(shape,cell.corner(c)) == false ) {
+			return false;
+		}
+	}
+	if ( shape.Type != Shape::Type::Polygon ) {
+		// capsules and circles are convex
+		return true;
+	}
+	// the polygon may still enter the cell, we check that no edge
+	// crosses it.
+	const auto & polygon = *static_cast<const Polygon*>(shape.S);
+	for ( size_t i = 0; i < polygon.Size(); ++i ) {
+		const auto & a = polygon.Vertex(i);
+		const auto & b = polygon.Vertex((i+1) % polygon.Size());
+		if ( AABB(a.cwiseMin(b),a.cwiseMax(b)).intersects(cell) == false ) {
+			continue;
+		}
+		Eigen::Vector2d normal(a.y() - b.y(),b.x() - a.x());
+		int sides = 0;
+		for ( const auto & c : corners ) {
+			sides |= normal.dot(cell.corner(c) - a) >= 0.0 ? 1 : 2;
+		}
+		if ( sides == 3 ) {
+			return false;
+		}
+	}
+	return true;
 }
 
 ZoneID AntZoner::LocateAnt(const PositionedAnt & ant) const {
-	auto fi =  std::find_if(d_zoneGeometries.begin(),
-	                        d_zoneGeometries.end(),
-	                        [&ant](const std::pair<ZoneID,Zone::Geometry::ConstPtr> & iter ) -> bool {
-		                        return iter.second->Contains(ant.Position);
-	                        });
-	if ( fi == d_zoneGeometries.end() ) {
+	if ( d_shapes.empty() || d_bounds.contains(ant.Position) == false ) {
 		return 0;
 	}
-	return fi->first;
+	Eigen::Vector2d cellPos = (ant.Position - d_bounds.min()).cwiseQuotient(d_cellSize);
+	size_t x = std::min(size_t(cellPos.x()),GRID_SIZE-1);
+	size_t y = std::min(size_t(cellPos.y()),GRID_SIZE-1);
+	size_t cell = y * GRID_SIZE + x;
+
+	for ( size_t i = d_cellOffsets[cell]; i < d_cellOffsets[cell+1]; ++i ) {
+		const auto & shape = d_shapes[d_candidates[i]];
+		if ( shape.Volume.contains(ant.Position) && Contains(shape,ant.Position) ) {
+			return d_zoneGeometries[shape.ZoneIndex].first;
+		}
+	}
+	auto zoneIndex = d_cellZones[cell];
+	if ( zoneIndex == d_zoneGeometries.size() ) {
+		return 0;
+	}
+	return d_zoneGeometries[zoneIndex].first;
 }
 
 
 void CollisionSolver::LocateAnts(LocatedAnts & locatedAnts,
                                  const IdentifiedFrame::Ptr & frame) const {
 
-	auto zoner = ZonerFor(frame);
+	const auto & zoner = ZonerFor(frame);
 
 	// now for each geometry. we test if the ants is in the zone
 	frame->Zones.reserve(frame->Positions.size());
@@ -105,7 +257,9 @@ void CollisionSolver::LocateAnts(LocatedAnts & locatedAnts,
 
 void CollisionSolver::ComputeCollisions(std::vector<Collision> &  result,
                                         const std::vector<PositionedAnt> & ants,
-                                        ZoneID zoneID) const {
+                                        ZoneID zoneID,
+                                        const InteractionTypeSet * types,
+                                        double margin) const {
 
 	//first-pass we compute possible interactions
 	struct AntTypedCapsule  {
@@ -124,6 +278,33 @@ void CollisionSolver::ComputeCollisions(std::vector<Collision> &  result,
 	};
 	typedef KDTree<AntTypedCapsule,double,2> KDT;
 
+	// capsules whose type is not in types are never tested
+	std::set<AntShapeTypeID> usedTypes;
+	if ( types != nullptr ) {
+		for ( const auto & [a,b] : *types ) {
+			usedTypes.insert(a);
+			usedTypes.insert(b);
+		}
+	}
+	auto wanted =
+		[types](const AntTypedCapsule & a, const AntTypedCapsule & b) {
+			return types == nullptr
+				|| types->count(std::make_pair(std::min(a.TypeID,b.TypeID),
+				                               std::max(a.TypeID,b.TypeID))) != 0;
+		};
+	// in proximity mode, capsules are inflated by the margin. Otherwise
+	// the distance is not computed and left to 0.
+	auto collide =
+		[margin](const AntTypedCapsule & a, const AntTypedCapsule & b, double & distance) {
+			if ( margin <= 0.0 ) {
+				distance = 0.0;
+				return a.C.Intersects(b.C);
+			}
+			distance = a.C.Distance(b.C);
+			return distance <= margin;
+		};
+	Eigen::Vector2d inflation = Eigen::Vector2d::Constant(std::max(margin,0.0) / 2.0);
+
 	std::vector<KDT::Element> nodes;
 
 	for ( const auto & ant : ants) {
@@ -134,40 +315,95 @@ void CollisionSolver::ComputeCollisions(std::vector<Collision> &  result,
 		Isometry2Dd antToOrig(ant.Angle,ant.Position);
 
 		for ( const auto & [typeID,c] : fiGeom->second ) {
+			if ( types != nullptr && usedTypes.count(typeID) == 0 ) {
+				continue;
+			}
 			auto data =
 				AntTypedCapsule { .C = c.Transform(antToOrig),
 				                  .ID = uint32_t(ant.ID),
 				                  .TypeID = typeID,
 			};
-			nodes.push_back({.Object = data, .Volume = data.C.ComputeAABB() });
+			auto volume = data.C.ComputeAABB();
+			volume.min() -= inflation;
+			volume.max() += inflation;
+			nodes.push_back({.Object = data, .Volume = volume });
 		}
 	}
 	auto kdt = KDT::Build(nodes.begin(),nodes.end(),-1);
-	std::list<std::pair<AntTypedCapsule,AntTypedCapsule>> possibleCollisions;
-	auto inserter = std::inserter(possibleCollisions,possibleCollisions.begin());
-	kdt->ComputeCollisions(inserter);
-
-	// now do the actual collisions
-	std::map<InteractionID,std::set<std::pair<uint32_t,uint32_t>>> res;
-	for ( const auto & coarse : possibleCollisions ) {
-		if ( coarse.first.C.Intersects(coarse.second.C) == true ) {
-			InteractionID ID = std::make_pair(coarse.first.ID,coarse.second.ID);
-			auto type = std::make_pair(coarse.first.TypeID,coarse.second.TypeID);
-			res[ID].insert(type);
-		}
-	}
-	result.reserve(result.size() + res.size());
-	for ( const auto & [ID,interactionSet] : res ) {
-		InteractionTypes interactions(interactionSet.size(),2);
-		size_t i = 0;
-		for ( const auto & t : interactionSet ) {
-			interactions(i,0) = t.first;
-			interactions(i,1) = t.second;
-			++i;
+
+	std::vector<TypedInteraction> interactions;
+	if ( ants.size() < d_parallelThreshold ) {
+		std::list<std::pair<AntTypedCapsule,AntTypedCapsule>> possibleCollisions;
+		auto inserter = std::inserter(possibleCollisions,possibleCollisions.begin());
+		kdt->ComputeCollisions(inserter);
+
+		// now do the actual collisions
+		double distance;
+		for ( const auto & coarse : possibleCollisions ) {
+			if ( wanted(coarse.first,coarse.second) == true
+			     && collide(coarse.first,coarse.second,distance) == true ) {
+				interactions.push_back({.IDs = std::make_pair(coarse.first.ID,coarse.second.ID),
+				                        .Types = std::make_pair(coarse.first.TypeID,coarse.second.TypeID),
+				                        .Distance = distance});
+			}
 		}
-		result.push_back(Collision{ID,interactions,zoneID});
+	} else {
+		// each capsule queries the tree on its own, and only reports
+		// ants with a greater ID, so each pair is found once.
+		tbb::enumerable_thread_specific<std::vector<TypedInteraction>> local;
+		tbb::parallel_for(tbb::blocked_range<size_t>(0,nodes.size()),
+		                  [&nodes,&kdt,&local,&wanted,&collide](const tbb::blocked_range<size_t> & range) {
+			                  auto & found = local.local();
+			                  for ( size_t idx = range.begin();
+			                        idx != range.end();
+			                        ++idx ) {
+				                  const auto & a = nodes[idx].Object;
+				                  kdt->ForEachIntersecting(nodes[idx].Volume,
+				                                           [&a,&found,&wanted,&collide](const AntTypedCapsule & b) {
+					                                           double distance;
+					                                           if ( b.ID <= a.ID
+					                                                || wanted(a,b) == false
+					                                                || collide(a,b,distance) == false ) {
+						                                           return;
+					                                           }
+					                                           found.push_back({.IDs = std::make_pair(a.ID,b.ID),
+					                                                            .Types = std::make_pair(a.TypeID,b.TypeID),
+					                                                            .Distance = distance});
+				                                           });
+			                  }
+		                  });
+		local.combine_each([&interactions](const std::vector<TypedInteraction> & found) {
+			                   interactions.insert(interactions.end(),found.begin(),found.end());
+		                   });
 	}
 
+	// several capsules may share a type, we keep the closest ones.
+	std::sort(interactions.begin(),interactions.end(),
+	          [](const TypedInteraction & a, const TypedInteraction & b) {
+		          return std::tie(a.IDs,a.Types,a.Distance) < std::tie(b.IDs,b.Types,b.Distance);
+	          });
+	interactions.erase(std::unique(interactions.begin(),interactions.end(),
+	                               [](const TypedInteraction & a, const TypedInteraction & b) {
+		                               return a.IDs == b.IDs && a.Types == b.Types;
+	                               }),
+	                   interactions.end());
+
+	for ( auto begin = interactions.begin(); begin != interactions.end(); ) {
+		auto end = std::find_if(begin,interactions.end(),
+		                        [&begin](const TypedInteraction & i) {
+			                        return i.IDs != begin->IDs;
+		                        });
+		InteractionTypes interactionTypes(end-begin,2);
+		double distance = std::numeric_limits<double>::max();
+		size_t i = 0;
+		for ( auto it = begin; it != end; ++it,++i ) {
+			interactionTypes(i,0) = it->Types.first;
+			interactionTypes(i,1) = it->Types.second;
+			distance = std::min(distance,it->Distance);
+		}
+		result.push_back(Collision{begin->IDs,interactionTypes,zoneID,distance});
+		begin = end;
+	}
 }
 
 
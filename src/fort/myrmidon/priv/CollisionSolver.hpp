@@ -5,7 +5,6 @@
 
 #include "Ant.hpp"
 #include "Zone.hpp"
-#include "TimeMap.hpp"
 
 namespace fort {
 namespace myrmidon {
@@ -17,11 +16,46 @@ public:
 	typedef std::shared_ptr<const AntZoner> ConstPtr;
 	typedef std::vector<std::pair<ZoneID,Zone::Geometry::ConstPtr> > ZoneGeometries;
 
+	// Number of cells of the zone index in each dimension
+	const static size_t GRID_SIZE;
+
 	AntZoner(const ZoneGeometries & zoneGeometries);
 
+	// Locates an ant
+	// @ant the ant to locate
+	//
+	// Zones are tested in order, the first one containing the ant
+	// position is returned. The search uses a coarse grid over the
+	// zones: cells fully covered by a zone are resolved directly,
+	// other cells only test the shapes overlapping them.
+	// @return the ZoneID of the ant, or 0 if it is in no zone.
 	ZoneID LocateAnt(const PositionedAnt & ant) const;
 private:
-	ZoneGeometries d_zoneGeometries;
+	struct IndexedShape {
+		const Shape * S;
+		Shape::Type   Type;
+		size_t        ZoneIndex;
+		AABB          Volume;
+	};
+
+	static bool Contains(const IndexedShape & shape,
+	                     const Eigen::Vector2d & point);
+
+	static bool Covers(const IndexedShape & shape,
+	                   const AABB & cell);
+
+	void BuildCell(size_t x, size_t y);
+
+	ZoneGeometries            d_zoneGeometries;
+	std::vector<IndexedShape> d_shapes;
+	AABB                      d_bounds;
+	Eigen::Vector2d           d_cellSize;
+	// Zone index covering each cell, or d_zoneGeometries.size()
+	std::vector<size_t>       d_cellZones;
+	// Shapes to test, sorted by zone index, for each cell. They are
+	// stored in d_candidates[d_cellOffsets[i]:d_cellOffsets[i+1]]
+	std::vector<size_t>       d_cellOffsets;
+	std::vector<uint32_t>     d_candidates;
 };
 
 
@@ -30,30 +64,73 @@ public:
 	typedef std::shared_ptr<CollisionSolver>       Ptr;
 	typedef std::shared_ptr<const CollisionSolver> ConstPtr;
 
-	CollisionSolver(const SpaceByID & spaces,
-	                const AntByID & ants);
-
-	AntZoner::ConstPtr ZonerFor(const IdentifiedFrame::ConstPtr & frame) const;
+	// Number of ants in a single zone above which the collisions of
+	// a frame are computed concurrently.
+	const static size_t DEFAULT_PARALLEL_THRESHOLD;
 
+	CollisionSolver(const SpaceByID & spaces,
+	                const AntByID & ants,
+	                size_t parallelThreshold = DEFAULT_PARALLEL_THRESHOLD);
+
+	// Returns the AntZoner valid at the time of a frame. Zoners are
+	// computed once per time interval over which the zone geometries
+	// of a space are constant, and are shared between frames.
+	const AntZoner::ConstPtr & ZonerFor(const IdentifiedFrame::ConstPtr & frame) const;
+
+	// Computes the collisions in a frame
+	// @frame the frame to compute collisions for, its Zones will be set
+	// @types if not null, only the capsule pairings in this set are
+	//        tested and reported.
+	// @margin if strictly positive, capsules closer than margin are
+	//         reported, instead of only intersecting ones.
+	// @return the collisions in the frame
 	CollisionFrame::ConstPtr
-	ComputeCollisions(const IdentifiedFrame::Ptr & frame) const;
+	ComputeCollisions(const IdentifiedFrame::Ptr & frame,
+	                  const InteractionTypeSet * types = nullptr,
+	                  double margin = 0.0) const;
+
+	// Computes the collisions in a frame into an existing CollisionFrame
+	// @result the CollisionFrame to fill, its previous Collisions are
+	//         discarded but their storage is reused.
+	// @frame the frame to compute collisions for, its Zones will be set
+	// @types if not null, only the capsule pairings in this set are
+	//        tested and reported.
+	// @margin if strictly positive, capsules closer than margin are
+	//         reported, instead of only intersecting ones.
+	void ComputeCollisions(CollisionFrame & result,
+	                       const IdentifiedFrame::Ptr & frame,
+	                       const InteractionTypeSet * types = nullptr,
+	                       double margin = 0.0) const;
 private:
 	typedef DenseMap<AntID,Ant::TypedCapsuleList>                    AntGeometriesByID;
-	typedef TimeMap<ZoneID,Zone::Geometry::ConstPtr>                 TimedZoneGeometries;
-	typedef DenseMap<SpaceID,TimedZoneGeometries>                    GeometriesBySpaceID;
-	typedef DenseMap<SpaceID,std::vector<ZoneID>>                    ZoneIDsBySpaceID;
+	struct TimedZoners {
+		// Start of each interval, sorted. The first one is -∞.
+		std::vector<Time::SortableKey>  Starts;
+		std::vector<AntZoner::ConstPtr> Zoners;
+	};
+	typedef DenseMap<SpaceID,TimedZoners>                            ZonersBySpaceID;
 	typedef std::unordered_map<Zone::ID,std::vector<PositionedAnt> > LocatedAnts;
 
 	void LocateAnts(LocatedAnts & locatedAnts,
 	                const IdentifiedFrame::Ptr & frame) const;
 
+	struct TypedInteraction {
+		InteractionID                IDs;
+		std::pair<uint32_t,uint32_t> Types;
+		double                       Distance;
+	};
+
 	void ComputeCollisions(std::vector<Collision> &  result,
 	                       const std::vector<PositionedAnt> & ants,
-	                       ZoneID zoneID) const;
+	                       ZoneID zoneID,
+	                       const InteractionTypeSet * types,
+	                       double margin) const;
+
+	static TimedZoners ComputeZoners(const Space & space);
 
 	AntGeometriesByID   d_antGeometries;
-	GeometriesBySpaceID d_spaceGeometries;
-	ZoneIDsBySpaceID    d_zoneIDs;
+	ZonersBySpaceID     d_zoners;
+	size_t              d_parallelThreshold;
 
 };
 
@@ -236,6 +236,210 @@ TEST_F(CollisionSolverUTest,TestE2E) {
 	}
 }
 
+TEST_F(CollisionSolverUTest,ParallelMatchesSerial) {
+	frame->Space = 1;
+	auto serial = std::make_shared<CollisionSolver>(universe->Spaces(),
+	                                                ants,
+	                                                std::numeric_limits<size_t>::max());
+	auto parallel = std::make_shared<CollisionSolver>(universe->Spaces(),
+	                                                  ants,
+	                                                  0);
+	CollisionFrame::ConstPtr expected,res;
+	ASSERT_NO_THROW({
+			frame->Zones.clear();
+			expected = serial->ComputeCollisions(frame);
+			frame->Zones.clear();
+			res = parallel->ComputeCollisions(frame);
+		});
+	auto byIDs = [](const Collision & a, const Collision & b) {
+		             return a.IDs < b.IDs;
+	             };
+	auto expectedCollisions = expected->Collisions;
+	auto collisions = res->Collisions;
+	std::sort(expectedCollisions.begin(),expectedCollisions.end(),byIDs);
+	std::sort(collisions.begin(),collisions.end(),byIDs);
+	ASSERT_EQ(collisions.size(),expectedCollisions.size());
+	for ( size_t i = 0; i < collisions.size(); ++i ) {
+		EXPECT_EQ(collisions[i].IDs,expectedCollisions[i].IDs);
+		EXPECT_EQ(collisions[i].Zone,expectedCollisions[i].Zone);
+		EXPECT_TRUE(collisions[i].Types == expectedCollisions[i].Types);
+	}
+}
+
+TEST_F(CollisionSolverUTest,ZonersFollowZoneDefinitions) {
+	auto timedUniverse = std::make_shared<Space::Universe>();
+	auto space = Space::Universe::Create(timedUniverse,1,"foo");
+	auto start = std::make_shared<Time>(Time::FromTimeT(10));
+	auto end = std::make_shared<Time>(Time::FromTimeT(20));
+	std::vector<Shape::ConstPtr> left = {std::make_shared<Circle>(Eigen::Vector2d(0,0),10)};
+	std::vector<Shape::ConstPtr> right = {std::make_shared<Circle>(Eigen::Vector2d(100,0),10)};
+	auto a = space->CreateZone("a");
+	a->AddDefinition(left,{},start);
+	a->AddDefinition(right,end,{});
+	auto b = space->CreateZone("b");
+	b->AddDefinition(left,start,{});
+
+	auto solver = std::make_shared<CollisionSolver>(timedUniverse->Spaces(),
+	                                                AntByID());
+
+	auto identified = std::make_shared<IdentifiedFrame>();
+	identified->Space = 1;
+	PositionedAnt atLeft{.Position = Eigen::Vector2d(0,0), .Angle = 0.0, .ID = 1};
+	PositionedAnt atRight{.Position = Eigen::Vector2d(100,0), .Angle = 0.0, .ID = 1};
+
+	struct TestData {
+		Time T;
+		ZoneID Left,Right;
+	};
+	std::vector<TestData> testdata =
+		{
+		 {Time::FromTimeT(0),a->ZoneID(),0},
+		 {Time::FromTimeT(9),a->ZoneID(),0},
+		 {Time::FromTimeT(10),b->ZoneID(),0},
+		 {Time::FromTimeT(19),b->ZoneID(),0},
+		 {Time::FromTimeT(20),b->ZoneID(),a->ZoneID()},
+		 {Time::FromTimeT(100),b->ZoneID(),a->ZoneID()},
+		};
+	for ( const auto & d : testdata ) {
+		identified->FrameTime = d.T;
+		AntZoner::ConstPtr zoner;
+		ASSERT_NO_THROW(zoner = solver->ZonerFor(identified));
+		ASSERT_TRUE(zoner);
+		EXPECT_EQ(zoner->LocateAnt(atLeft),d.Left) << " at " << d.T;
+		EXPECT_EQ(zoner->LocateAnt(atRight),d.Right) << " at " << d.T;
+	}
+
+	// zoners are shared within an interval
+	identified->FrameTime = Time::FromTimeT(11);
+	auto first = solver->ZonerFor(identified);
+	identified->FrameTime = Time::FromTimeT(18);
+	EXPECT_EQ(first,solver->ZonerFor(identified));
+}
+
+TEST_F(CollisionSolverUTest,ZonerMatchesNaiveLocation) {
+	std::default_random_engine e1(42);
+	std::uniform_real_distribution<double> pos(-50,250);
+	// a concave polygon, overlapping with a circle and a capsule
+	std::vector<Shape::ConstPtr> uShape =
+		{std::make_shared<Polygon>(Vector2dList({{0,0},{200,0},{200,200},{150,200},{150,50},{50,50},{50,200},{0,200}}))};
+	std::vector<Shape::ConstPtr> round =
+		{
+		 std::make_shared<Circle>(Eigen::Vector2d(100,100),60),
+		 std::make_shared<Capsule>(Eigen::Vector2d(-20,-20),Eigen::Vector2d(220,220),10,30),
+		};
+	AntZoner::ZoneGeometries geometries
+		= {
+		   {1,std::make_shared<ZoneGeometry>(uShape)},
+		   {2,std::make_shared<ZoneGeometry>(round)},
+	};
+	AntZoner zoner(geometries);
+	for ( size_t i = 0; i < 20000; ++i ) {
+		PositionedAnt ant{.Position = Eigen::Vector2d(pos(e1),pos(e1)), .Angle = 0.0, .ID = 1};
+		ZoneID expected = 0;
+		for ( const auto & [zID,geometry] : geometries ) {
+			if ( geometry->Contains(ant.Position) == true ) {
+				expected = zID;
+				break;
+			}
+		}
+		ASSERT_EQ(zoner.LocateAnt(ant),expected) << " at " << ant.Position.transpose();
+	}
+	EXPECT_EQ(AntZoner({}).LocateAnt(PositionedAnt{.Position = Eigen::Vector2d(0,0), .Angle = 0.0, .ID = 1}),0);
+}
+
+TEST_F(CollisionSolverUTest,FiltersInteractionTypes) {
+	frame->Space = 1;
+	auto solver = std::make_shared<CollisionSolver>(universe->Spaces(),
+	                                                ants);
+	InteractionTypeSet types = {{1,2}};
+	CollisionFrame::ConstPtr res;
+	ASSERT_NO_THROW({
+			frame->Zones.clear();
+			res = solver->ComputeCollisions(frame,&types);
+		});
+
+	std::map<InteractionID,std::set<std::pair<uint32_t,uint32_t>>> expected;
+	for ( const auto & c : collisions->Collisions ) {
+		for ( size_t i = 0; i < c.Types.rows(); ++i ) {
+			if ( c.Types(i,0) != c.Types(i,1) ) {
+				expected[c.IDs].insert(std::make_pair(c.Types(i,0),c.Types(i,1)));
+			}
+		}
+	}
+	ASSERT_EQ(res->Collisions.size(),expected.size());
+	for ( const auto & c : res->Collisions ) {
+		auto fi = expected.find(c.IDs);
+		if ( fi == expected.end() ) {
+			ADD_FAILURE() << "Unexpected collision between " << Ant::FormatID(c.IDs.first)
+			              << " and " << Ant::FormatID(c.IDs.second);
+			continue;
+		}
+		std::set<std::pair<uint32_t,uint32_t>> found;
+		for ( size_t i = 0; i < c.Types.rows(); ++i ) {
+			found.insert(std::make_pair(c.Types(i,0),c.Types(i,1)));
+		}
+		EXPECT_EQ(found,fi->second);
+	}
+}
+
+TEST_F(CollisionSolverUTest,ProximityCollisions) {
+	const static double MARGIN = 30.0;
+	frame->Space = 1;
+	auto solver = std::make_shared<CollisionSolver>(universe->Spaces(),
+	                                                ants);
+	// computes the zones of each ant
+	frame->Zones.clear();
+	ASSERT_NO_THROW(solver->ComputeCollisions(frame));
+
+	std::map<InteractionID,double> expected;
+	for ( size_t i = 0; i < frame->Positions.size(); ++i ) {
+		const auto & a = frame->Positions[i];
+		for ( size_t j = i+1; j < frame->Positions.size(); ++j ) {
+			const auto & b = frame->Positions[j];
+			if ( frame->Zones[i] != frame->Zones[j] ) {
+				continue;
+			}
+			Isometry2Dd aIso(a.Angle,a.Position),bIso(b.Angle,b.Position);
+			double distance = std::numeric_limits<double>::max();
+			for ( const auto & [aType,aC] : ants.at(a.ID)->Capsules() ) {
+				for ( const auto & [bType,bC] : ants.at(b.ID)->Capsules() ) {
+					distance = std::min(distance,aC.Transform(aIso).Distance(bC.Transform(bIso)));
+				}
+			}
+			if ( distance <= MARGIN ) {
+				expected[std::make_pair(std::min(a.ID,b.ID),std::max(a.ID,b.ID))] = distance;
+			}
+		}
+	}
+
+	CollisionFrame::ConstPtr res;
+	ASSERT_NO_THROW({
+			frame->Zones.clear();
+			res = solver->ComputeCollisions(frame,nullptr,MARGIN);
+		});
+	EXPECT_GT(res->Collisions.size(),collisions->Collisions.size());
+	EXPECT_EQ(res->Collisions.size(),expected.size());
+	for ( const auto & c : res->Collisions ) {
+		auto fi = expected.find(c.IDs);
+		if ( fi == expected.end() ) {
+			ADD_FAILURE() << "Unexpected collision between " << Ant::FormatID(c.IDs.first)
+			              << " and " << Ant::FormatID(c.IDs.second);
+			continue;
+		}
+		EXPECT_NEAR(c.Distance,fi->second,1.0e-9);
+	}
+
+	// without margin, distances are not computed
+	ASSERT_NO_THROW({
+			frame->Zones.clear();
+			res = solver->ComputeCollisions(frame);
+		});
+	EXPECT_FALSE(res->Collisions.empty());
+	for ( const auto & c : res->Collisions ) {
+		EXPECT_EQ(c.Distance,0.0);
+	}
+}
+
 
 } // namespace priv
 } // namespace myrmidon
@@ -3,11 +3,20 @@
 #include <utility>
 #include <vector>
 #include <stdexcept>
+#include <cstdint>
+#include <string>
 
 namespace fort {
 namespace myrmidon {
 namespace priv {
 
+// A map for small contiguous integer keys
+//
+// Values are stored in a vector indexed by their key, and an
+// occupancy bitmap tells which slots are populated. Iteration uses
+// the bitmap to jump over empty slots 64 at a time, so iterating a
+// sparse map is proportional to the number of populated words, not
+// to its largest key. Key 0 is reserved.
 template <typename Key,typename T>
 class DenseMap {
 public:
@@ -18,30 +27,18 @@ public:
 
 	class iterator {
     public:
-		iterator(const typename std::vector<std::pair<Key,T>>::iterator & iter,
-		         const typename std::vector<std::pair<Key,T>>::iterator & begin,
-		         const typename std::vector<std::pair<Key,T>>::iterator & end)
-			: d_iter(iter)
-			, d_end(end) {
+		iterator(DenseMap * map, size_t index)
+			: d_map(map)
+			, d_index(index) {
 		}
 
 		iterator& operator++() {
-			if ( d_iter == d_end ) {
-				return *this;
-			}
-			do {
-				++d_iter;
-			}while(d_iter != d_end && d_iter->first == 0);
+			d_index = d_map->NextOccupied(d_index+1);
 			return *this;
 		}
 
 		iterator& operator--() {
-			if ( d_iter == d_begin ) {
-				return *this;
-			}
-			do {
-				--d_iter;
-			}while(d_iter != d_begin && d_iter->first == 0);
+			d_index = d_map->PreviousOccupied(d_index);
 			return *this;
 		}
 
@@ -49,128 +46,105 @@ public:
         iterator operator++(int) {iterator retval = *this; ++(*this); return retval;}
         iterator operator--(int) {iterator retval = *this; --(*this); return retval;}
 
-        bool operator==(const iterator & other) const {return d_iter == other.d_iter;}
+        bool operator==(const iterator & other) const {return d_index == other.d_index;}
         bool operator!=(const iterator & other) const {return !(*this == other);}
 		DenseMap::value_type & operator*() {
-			return reinterpret_cast<std::pair<const Key,T>&>(*d_iter);
+			return reinterpret_cast<std::pair<const Key,T>&>(d_map->d_values[d_index]);
         }
 		DenseMap::value_type * operator->() {
-			return reinterpret_cast<std::pair<const Key,T>*>(&(*d_iter));
+			return reinterpret_cast<std::pair<const Key,T>*>(&(d_map->d_values[d_index]));
 		}
         // iterator traits
         using difference_type = long;
 		using value_type = DenseMap::value_type;
 		using pointer = const DenseMap::value_type*;
 		using reference = const DenseMap::value_type&;
-        using iterator_category = std::forward_iterator_tag;
+        using iterator_category = std::bidirectional_iterator_tag;
 	private :
 		friend class DenseMap::const_iterator;
-		typename std::vector<std::pair<Key,T>>::iterator d_iter,d_begin,d_end;
+		DenseMap * d_map;
+		size_t     d_index;
 	};
 
 	class const_iterator {
     public:
-		const_iterator(const typename std::vector<std::pair<Key,T>>::const_iterator & iter,
-		               const typename std::vector<std::pair<Key,T>>::const_iterator & begin,
-		               const typename std::vector<std::pair<Key,T>>::const_iterator & end)
-			: d_iter(iter)
-			, d_begin(begin)
-			, d_end(end) {
+		const_iterator(const DenseMap * map, size_t index)
+			: d_map(map)
+			, d_index(index) {
 		}
 
 		const_iterator(const iterator & iter)
-			: d_iter(iter.d_iter)
-			, d_end(iter.d_end) {
+			: d_map(iter.d_map)
+			, d_index(iter.d_index) {
 		}
 
 		const_iterator& operator++() {
-			if ( d_iter == d_end ) {
-				return *this;
-			}
-			do {
-				++d_iter;
-			}while(d_iter != d_end && d_iter->first == 0);
+			d_index = d_map->NextOccupied(d_index+1);
 			return *this;
 		}
 
 		const_iterator& operator--() {
-			if ( d_iter == d_begin ) {
-				return *this;
-			}
-			do {
-				--d_iter;
-			}while(d_iter != d_begin && d_iter->first == 0);
+			d_index = d_map->PreviousOccupied(d_index);
 			return *this;
 		}
 
         const_iterator operator++(int) {const_iterator retval = *this; ++(*this); return retval;}
 		const_iterator operator--(int) {const_iterator retval = *this; --(*this); return retval;}
-        bool operator==(const const_iterator & other) const {return d_iter == other.d_iter;}
+        bool operator==(const const_iterator & other) const {return d_index == other.d_index;}
         bool operator!=(const const_iterator & other) const {return !(*this == other);}
 		const DenseMap::value_type & operator*() const {
-			return reinterpret_cast<const std::pair<const Key,T>&>(*d_iter);
+			return reinterpret_cast<const std::pair<const Key,T>&>(d_map->d_values[d_index]);
         }
 		const DenseMap::value_type * operator->() const {
-			return reinterpret_cast<const std::pair<const Key,T>*>(&(*d_iter));
+			return reinterpret_cast<const std::pair<const Key,T>*>(&(d_map->d_values[d_index]));
 		}
         // iterator traits
         using difference_type = long;
 		using value_type = const DenseMap::value_type;
 		using pointer = const DenseMap::value_type*;
 		using reference = const DenseMap::value_type&;
-        using iterator_category = std::forward_iterator_tag;
+        using iterator_category = std::bidirectional_iterator_tag;
 	private :
-		typename std::vector<std::pair<Key,T>>::const_iterator d_iter,d_begin,d_end;
+		const DenseMap * d_map;
+		size_t           d_index;
 	};
 
 	T & at(const Key & key) {
-		if ( key == 0 || key > d_values.size() || d_values[key-1].first == 0 ) {
+		if ( count(key) == 0 ) {
 			throw std::out_of_range(std::to_string(key) + " is out of range");
 		}
 		return d_values[key-1].second;
 	}
 
 	const T & at(const Key & key) const {
-		if ( key == 0 || key > d_values.size() || d_values[key-1].first == 0 ) {
+		if ( count(key) == 0 ) {
 			throw std::out_of_range(std::to_string(key) + " is out of range");
 		}
 		return d_values[key-1].second;
 	}
 
 	iterator begin() noexcept {
-		auto b = d_values.begin();
-		while ( b != d_values.end() && b->first == 0 ) {
-			++b;
-		}
-		return iterator(b,d_values.begin(),d_values.end());
+		return iterator(this,NextOccupied(0));
 	}
 	const_iterator begin() const noexcept {
-		auto b = d_values.cbegin();
-		while ( b != d_values.cend() && b->first == 0 ) {
-			++b;
-		}
-		return const_iterator(b,d_values.begin(),d_values.cend());
+		return const_iterator(this,NextOccupied(0));
 	}
 	const_iterator cbegin() const noexcept {
-		auto b = d_values.cbegin();
-		while ( b != d_values.cend() && b->first == 0 ) {
-			++b;
-		}
-		return const_iterator(b,d_values.begin(),d_values.cend());
+		return const_iterator(this,NextOccupied(0));
 	}
 
 	iterator end() noexcept {
-		return iterator(d_values.end(),d_values.begin(),d_values.end());
+		return iterator(this,d_values.size());
 	}
 	const_iterator end() const noexcept {
-		return const_iterator(d_values.cend(),d_values.begin(),d_values.cend());
+		return const_iterator(this,d_values.size());
 	}
 	const_iterator cend() const noexcept {
-		return const_iterator(d_values.cend(),d_values.begin(),d_values.cend());
+		return const_iterator(this,d_values.size());
 	}
 
 	bool empty() const noexcept {
-		return d_values.empty();
+		return d_size == 0;
 	}
 
 	size_t size() const noexcept {
@@ -181,12 +155,23 @@ public:
 		if ( key == 0 || key > d_values.size() ) {
 			return 0;
 		}
-		return d_values[key-1].first == 0 ? 0 : 1;
+		return Occupied(key-1) ? 1 : 0;
 	}
 
+	// Removes all values
+	//
+	// Storage is kept, so refilling the map does not allocate.
 	void clear() noexcept {
 		d_size = 0;
 		d_values.clear();
+		d_occupied.clear();
+	}
+
+	// Preallocates storage
+	// @maxKey the largest key the map is expected to hold
+	void reserve(const Key & maxKey) {
+		d_values.reserve(maxKey);
+		d_occupied.reserve(WordCount(maxKey));
 	}
 
 	std::pair<iterator,bool> insert(const value_type & v) {
@@ -196,65 +181,61 @@ public:
 		}
 		if ( k > d_values.size() ) {
 			d_values.resize(k,std::make_pair(0,T()));
+			d_occupied.resize(WordCount(k),0);
 		}
-		if ( d_values[k-1].first != 0 ) {
-			return std::make_pair(iterator(d_values.begin() + (k-1),d_values.begin(),d_values.end()),false);
+		if ( Occupied(k-1) == true ) {
+			return std::make_pair(iterator(this,k-1),false);
 		}
 		d_values[k-1].first = v.first;
 		d_values[k-1].second = v.second;
+		d_occupied[(k-1) / 64] |= uint64_t(1) << ((k-1) % 64);
 		++d_size;
-		return std::make_pair(iterator(d_values.end()-1,d_values.begin(),d_values.end()),true);
+		return std::make_pair(iterator(this,k-1),true);
 	}
 
 	void erase( const_iterator pos ) {
-		auto k = pos->first;
-		if ( k == 0 || k > d_values.size() || d_values[k-1].first == 0) {
+		if ( pos == cend() ) {
 			return;
 		}
-		d_values[k-1] = std::make_pair(0,T());
-		--d_size;
-		auto last = d_values.end();
-		do {
-			--last;
-		} while( last != d_values.begin() && last->first == 0 );
-		d_values.erase(last+1,d_values.end() + (k-1),d_values.end());
+		erase(pos->first);
 	}
 
 	void erase( iterator pos ) {
-		auto k = pos->first;
-		if ( k == 0 || k > d_values.size() || d_values[k-1].first == 0) {
+		if ( pos == end() ) {
 			return;
 		}
-		d_values[k-1] = std::make_pair(0,T());
-		--d_size;
-		auto last = d_values.end();
-		do {
-			--last;
-		} while( last != d_values.begin() && last->first == 0 );
-		d_values.erase(last+1,d_values.end());
+		erase(pos->first);
 	}
 
-	size_t erase ( const key_type & key) {
-		if ( key == 0 || key > d_values.size() || d_values[key-1].first == 0 ) {
+	size_t erase ( const key_type & k) {
+		// copies the key, as it may reference the slot we clear
+		const key_type key = k;
+		if ( count(key) == 0 ) {
 			return 0;
 		}
-		erase(iterator(d_values.begin() + (key-1),d_values.begin(),d_values.end()));
+		d_values[key-1] = std::make_pair(0,T());
+		d_occupied[(key-1) / 64] &= ~(uint64_t(1) << ((key-1) % 64));
+		--d_size;
+		// trims the trailing empty slots
+		size_t last = PreviousOccupied(d_values.size());
+		size_t newSize = ( last < d_values.size() && Occupied(last) ) ? last + 1 : 0;
+		d_values.erase(d_values.begin() + newSize,d_values.end());
+		d_occupied.resize(WordCount(newSize));
 		return 1;
 	}
 
 	const_iterator find( const key_type & key) const {
-		if ( key == 0 || key > d_values.size() || d_values[key-1].first == 0) {
+		if ( count(key) == 0 ) {
 			return cend();
 		}
-		return const_iterator(d_values.cbegin()+(key-1),d_values.begin(),d_values.end());
+		return const_iterator(this,key-1);
 	}
 
 	iterator find( const key_type & key) {
-		if ( key == 0 || key > d_values.size() || d_values[key-1].first == 0) {
+		if ( count(key) == 0 ) {
 			return end();
 		}
-		return iterator(d_values.begin()+(key-1),d_values.begin(),d_values.end());
-
+		return iterator(this,key-1);
 	}
 
 
@@ -263,7 +244,50 @@ public:
 	}
 
 private:
+	static size_t WordCount(size_t size) {
+		return (size + 63) / 64;
+	}
+
+	inline bool Occupied(size_t index) const {
+		return (d_occupied[index / 64] >> (index % 64)) & 1;
+	}
+
+	// index of the first occupied slot at or after index, or
+	// d_values.size() if none.
+	size_t NextOccupied(size_t index) const {
+		size_t word = index / 64;
+		if ( word >= d_occupied.size() ) {
+			return d_values.size();
+		}
+		uint64_t bits = d_occupied[word] & (~uint64_t(0) << (index % 64));
+		while ( bits == 0 ) {
+			if ( ++word >= d_occupied.size() ) {
+				return d_values.size();
+			}
+			bits = d_occupied[word];
+		}
+		return word * 64 + __builtin_ctzll(bits);
+	}
+
+	// index of the last occupied slot before index, or index if
+	// none.
+	size_t PreviousOccupied(size_t index) const {
+		if ( index == 0 ) {
+			return index;
+		}
+		size_t word = (index - 1) / 64;
+		uint64_t bits = d_occupied[word] & (~uint64_t(0) >> (63 - ((index - 1) % 64)));
+		while ( bits == 0 ) {
+			if ( word == 0 ) {
+				return index;
+			}
+			bits = d_occupied[--word];
+		}
+		return word * 64 + 63 - __builtin_clzll(bits);
+	}
+
 	std::vector<std::pair<Key,T>> d_values;
+	std::vector<uint64_t>         d_occupied;
 	size_t                        d_size;
 };
 
@@ -98,6 +98,57 @@ TEST_F(DenseMapUTest,Find) {
 
 }
 
+TEST_F(DenseMapUTest,SparseIterationAndBulkOperations) {
+	std::vector<uint32_t> keys = {3,64,65,128,1000,1001,4097};
+	DM map;
+	map.reserve(4097);
+	EXPECT_TRUE(map.empty());
+	EXPECT_TRUE(map.begin() == map.end());
+	for ( const auto & k : keys ) {
+		auto res = map.insert(std::make_pair(k,2*k));
+		ASSERT_TRUE(res.second);
+		EXPECT_EQ(res.first->first,k);
+	}
+	EXPECT_FALSE(map.empty());
+	EXPECT_EQ(map.count(2),0);
+	EXPECT_EQ(map.count(4096),0);
+	EXPECT_EQ(map.count(4098),0);
+
+	std::vector<uint32_t> iterated;
+	for ( const auto & [k,v] : map ) {
+		EXPECT_EQ(v,2*k);
+		iterated.push_back(k);
+	}
+	EXPECT_EQ(iterated,keys);
+
+	// backward iteration
+	iterated.clear();
+	auto it = map.end();
+	do {
+		--it;
+		iterated.insert(iterated.begin(),it->first);
+	} while ( it != map.begin() );
+	EXPECT_EQ(iterated,keys);
+
+	// erasing the last key trims the map
+	EXPECT_EQ(map.erase(4097),1);
+	EXPECT_EQ(map.erase(4097),0);
+	iterated.clear();
+	for ( const auto & [k,v] : map ) {
+		iterated.push_back(k);
+	}
+	EXPECT_EQ(iterated,std::vector<uint32_t>(keys.begin(),keys.end()-1));
+	EXPECT_THROW(map.at(4097),std::out_of_range);
+
+	map.clear();
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(map.size(),0);
+	EXPECT_TRUE(map.begin() == map.end());
+	EXPECT_EQ(map.count(3),0);
+	EXPECT_TRUE(map.insert(std::make_pair(3,1)).second);
+	EXPECT_EQ(map.at(3),1);
+}
+
 TEST_F(DenseMapUTest,ConsistencyAndTiming) {
 	std::random_device r;
 	// Choose a random mean between 1 and 6
@@ -3,6 +3,8 @@
 #include "DeletedReference.hpp"
 #include "Identifier.hpp"
 
+#include <cmath>
+
 namespace fort {
 namespace myrmidon {
 namespace priv {
@@ -137,6 +139,38 @@ void Identification::ComputePositionFromTag(Eigen::Vector2d & position,
 	angle = antToOrig.angle();
 }
 
+// Wraps an angle in [-π,π[ like <Isometry2D>, but without a data
+// dependent loop, so it does not prevent vectorization.
+static inline double NormalizeAngle(double angle) {
+	return angle - 2.0 * M_PI * std::floor((angle + M_PI) / (2.0 * M_PI));
+}
+
+void Identification::ComputePositionsFromTags(PoseBatch & ants,
+                                              const PoseBatch & tags,
+                                              const PoseBatch & antToTags) {
+	const size_t size = tags.X.size();
+	ants.Resize(size);
+	double * x = ants.X.data();
+	double * y = ants.Y.data();
+	double * angle = ants.Angle.data();
+	const double * tagX = tags.X.data();
+	const double * tagY = tags.Y.data();
+	const double * tagAngle = tags.Angle.data();
+	const double * offsetX = antToTags.X.data();
+	const double * offsetY = antToTags.Y.data();
+	const double * offsetAngle = antToTags.Angle.data();
+
+	// a single pass, with one sin/cos pair per tag. The tag angle
+	// needs no normalization as the sum is normalized.
+	for ( size_t i = 0; i < size; ++i ) {
+		const double c = std::cos(tagAngle[i]);
+		const double s = std::sin(tagAngle[i]);
+		x[i] = c * offsetX[i] - s * offsetY[i] + tagX[i];
+		y[i] = s * offsetX[i] + c * offsetY[i] + tagY[i];
+		angle[i] = NormalizeAngle(tagAngle[i] + offsetAngle[i]);
+	}
+}
+
 
 void Identification::SetUserDefinedAntPose(const Eigen::Vector2d & antPosition, double antAngle) {
 	d_userDefinedPose = true;
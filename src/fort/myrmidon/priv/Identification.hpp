@@ -143,6 +143,31 @@ public:
 	                            const Eigen::Vector2d & tagPosition,
 	                            double tagAngle) const;
 
+	// A batch of poses, as a structure of arrays
+	struct PoseBatch {
+		std::vector<double> X,Y,Angle;
+
+		inline void Resize(size_t size) {
+			X.resize(size);
+			Y.resize(size);
+			Angle.resize(size);
+		}
+	};
+
+	// Computes the positions of a batch of ants from their tags
+	// @ants the resulting ant poses, resized to the size of <tags>
+	// @tags the tag poses in image space
+	// @antToTags the <AntToTagTransform> of each tag <Identification>
+	//
+	// Batch version of <ComputePositionFromTag>, written as a single
+	// branchless loop over contiguous arrays. Its cost is dominated
+	// by sin/cos, which are only vectorized with a vector math
+	// library (e.g. glibc libmvec with -ffast-math). The
+	// positions_from_tags benchmark compares it with <Isometry2D>.
+	static void ComputePositionsFromTags(PoseBatch & ants,
+	                                     const PoseBatch & tags,
+	                                     const PoseBatch & antToTags);
+
 	// Gets the identified Ant
 	// @return an <Ant::Ptr> to the identified Ant
 	//
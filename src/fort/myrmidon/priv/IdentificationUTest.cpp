@@ -191,6 +191,38 @@ TEST_F(IdentificationUTest,TestIdentificationBoundary) {
 
 
 
+TEST_F(IdentificationUTest,BatchComputesPositionsFromTags) {
+	Identification::PoseBatch tags,antToTags,ants;
+	for ( size_t i = 0; i < d_list.size(); ++i ) {
+		d_list[i]->SetUserDefinedAntPose(Eigen::Vector2d(3.0 * i - 10.0,7.0 - 2.0 * i),
+		                                 -3.0 + 0.7 * i);
+		const auto & antToTag = d_list[i]->AntToTagTransform();
+		// covers angles outside of [-π,π[
+		tags.X.push_back(100.0 * i);
+		tags.Y.push_back(50.0 - 20.0 * i);
+		tags.Angle.push_back(-7.0 + 1.3 * i);
+		antToTags.X.push_back(antToTag.translation().x());
+		antToTags.Y.push_back(antToTag.translation().y());
+		antToTags.Angle.push_back(antToTag.angle());
+	}
+
+	Identification::ComputePositionsFromTags(ants,tags,antToTags);
+	ASSERT_EQ(ants.X.size(),d_list.size());
+	ASSERT_EQ(ants.Y.size(),d_list.size());
+	ASSERT_EQ(ants.Angle.size(),d_list.size());
+
+	Eigen::Vector2d position;
+	double angle;
+	for ( size_t i = 0; i < d_list.size(); ++i ) {
+		d_list[i]->ComputePositionFromTag(position,angle,
+		                                  Eigen::Vector2d(tags.X[i],tags.Y[i]),
+		                                  tags.Angle[i]);
+		EXPECT_NEAR(ants.X[i],position.x(),1.0e-9);
+		EXPECT_NEAR(ants.Y[i],position.y(),1.0e-9);
+		EXPECT_NEAR(ants.Angle[i],angle,1.0e-9);
+	}
+}
+
 } // namespace priv
 } // namespace myrmidon
 } // namespace fort
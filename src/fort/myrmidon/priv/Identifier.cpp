@@ -6,6 +6,9 @@
 #include "AntPoseEstimate.hpp"
 
 #include <iostream>
+#include <set>
+
+#include <tbb/parallel_for.h>
 
 namespace fort {
 namespace myrmidon {
@@ -13,6 +16,63 @@ namespace priv {
 
 IdentifierIF::~IdentifierIF() {}
 
+void IdentifierIF::IdentifyTags(std::vector<const Identification*> & identifications,
+                                const google::protobuf::RepeatedPtrField<fort::hermes::Tag> & tags,
+                                const Time & time) const {
+	identifications.clear();
+	identifications.reserve(tags.size());
+	for ( const auto & t : tags ) {
+		identifications.push_back(Identify(t.id(),time).get());
+	}
+}
+
+void IdentifierIF::IdentifyAnts(PositionedAntList & positions,
+                                const google::protobuf::RepeatedPtrField<fort::hermes::Tag> & tags,
+                                const Time & time,
+                                const AABB * tagRegion) const {
+	thread_local std::vector<const Identification*> identifications;
+	thread_local Identification::PoseBatch tagPoses,antToTags,antPoses;
+	thread_local std::vector<AntID> antIDs;
+	IdentifyTags(identifications,tags,time);
+
+	tagPoses.X.clear(); tagPoses.Y.clear(); tagPoses.Angle.clear();
+	antToTags.X.clear(); antToTags.Y.clear(); antToTags.Angle.clear();
+	antIDs.clear();
+	for ( size_t i = 0; i < identifications.size(); ++i ) {
+		const auto identification = identifications[i];
+		if ( identification == nullptr ) {
+			continue;
+		}
+		const auto & t = tags.Get(i);
+		if ( tagRegion != nullptr
+		     && tagRegion->contains(Eigen::Vector2d(t.x(),t.y())) == false ) {
+			continue;
+		}
+		const auto & antToTag = identification->AntToTagTransform();
+		tagPoses.X.push_back(t.x());
+		tagPoses.Y.push_back(t.y());
+		tagPoses.Angle.push_back(t.theta());
+		antToTags.X.push_back(antToTag.translation().x());
+		antToTags.Y.push_back(antToTag.translation().y());
+		antToTags.Angle.push_back(antToTag.angle());
+		antIDs.push_back(identification->Target()->AntID());
+	}
+
+	Identification::ComputePositionsFromTags(antPoses,tagPoses,antToTags);
+
+	// PositionedAntList is an array of structures, the batch is
+	// scattered into it in a single pass, without reallocation.
+	const size_t offset = positions.size();
+	positions.resize(offset + antIDs.size());
+	PositionedAnt * out = positions.data() + offset;
+	for ( size_t i = 0; i < antIDs.size(); ++i ) {
+		out[i].Position.x() = antPoses.X[i];
+		out[i].Position.y() = antPoses.Y[i];
+		out[i].Angle = antPoses.Angle[i];
+		out[i].ID = antIDs[i];
+	}
+}
+
 
 Identifier::UnmanagedIdentification::UnmanagedIdentification(const Identification & ident) noexcept
 	: std::runtime_error([&ident](){
@@ -29,7 +89,8 @@ Identifier::UnmanagedTag::UnmanagedTag(TagID ID) noexcept
 	                     }()) {}
 
 Identifier::Identifier()
-	: d_callback([](const Identification::Ptr &, const std::vector<AntPoseEstimateConstPtr> &){}) {
+	: d_callback([](const Identification::Ptr &, const std::vector<AntPoseEstimateConstPtr> &){})
+	, d_poseEditDepth(0) {
 }
 
 Identifier::~Identifier() {}
@@ -294,6 +355,12 @@ void Identifier::QueryAntPoseEstimate(std::vector<AntPoseEstimateConstPtr> & est
 }
 
 void Identifier::UpdateIdentificationAntPosition(const Identification::Ptr & identification) {
+	if ( d_poseEditDepth > 0 ) {
+		if ( d_pendingPoseSet.insert(identification.get()).second == true ) {
+			d_pendingPoseUpdates.push_back(identification);
+		}
+		return;
+	}
 	if ( identification->HasUserDefinedAntPose() == true ) {
 		return;
 	}
@@ -312,31 +379,235 @@ void Identifier::SetAntPositionUpdateCallback(const OnPositionUpdateCallback & c
 	d_callback =  callback;
 }
 
+void Identifier::UpdatePendingAntPositions() {
+	std::vector<Identification::Ptr> pending;
+	pending.swap(d_pendingPoseUpdates);
+	d_pendingPoseSet.clear();
+
+	// Identifications deleted within the scope are not updated.
+	pending.erase(std::remove_if(pending.begin(),
+	                             pending.end(),
+	                             [this](const Identification::Ptr & identification) {
+		                             if ( identification->HasUserDefinedAntPose() == true ) {
+			                             return true;
+		                             }
+		                             auto fi = d_identifications.find(identification->TagValue());
+		                             return fi == d_identifications.end()
+			                             || std::find(fi->second.begin(),
+			                                          fi->second.end(),
+			                                          identification) == fi->second.end();
+	                             }),
+	              pending.end());
+
+	std::vector<std::vector<AntPoseEstimateConstPtr>> matched(pending.size());
+	std::vector<Eigen::Vector2d> positions(pending.size());
+	std::vector<double> angles(pending.size());
+	tbb::parallel_for(tbb::blocked_range<size_t>(0,pending.size()),
+	                  [&](const tbb::blocked_range<size_t> & range) {
+		                  for ( size_t i = range.begin(); i != range.end(); ++i ) {
+			                  QueryAntPoseEstimate(matched[i],pending[i]);
+			                  AntPoseEstimate::ComputeMeanPose(positions[i],
+			                                                   angles[i],
+			                                                   matched[i].begin(),
+			                                                   matched[i].end());
+		                  }
+	                  });
+
+	// the callback may not be thread safe.
+	for ( size_t i = 0; i < pending.size(); ++i ) {
+		const auto & identification = pending[i];
+		if ( positions[i] == identification->AntPosition() && angles[i] == identification->AntAngle() ) {
+			continue;
+		}
+		Identification::Accessor::SetAntPosition(*identification,positions[i],angles[i]);
+		d_callback(identification,matched[i]);
+	}
+}
+
+Identifier::PoseEditScope::PoseEditScope(Identifier & identifier)
+	: d_identifier(identifier)
+	, d_committed(false) {
+	++d_identifier.d_poseEditDepth;
+}
+
+Identifier::PoseEditScope::~PoseEditScope() {
+	if ( d_committed == true ) {
+		return;
+	}
+	try {
+		Commit();
+	} catch ( ... ) {
+	}
+}
+
+void Identifier::PoseEditScope::Commit() {
+	if ( d_committed == true ) {
+		return;
+	}
+	d_committed = true;
+	if ( --d_identifier.d_poseEditDepth > 0 ) {
+		return;
+	}
+	d_identifier.UpdatePendingAntPositions();
+}
+
+
+const uint32_t Identifier::Compiled::UNIDENTIFIED = std::numeric_limits<uint32_t>::max();
 
-Identifier::Compiled::Compiled(const Identifier::IdentificationByTagID & identifications) {
+const size_t Identifier::Compiled::MAX_SNAPSHOT_ENTRIES = 16 * 1024 * 1024;
+
+Identifier::Compiled::Compiled(const Identifier::IdentificationByTagID & identifications,
+                               size_t maxSnapshotEntries) {
+	// deleted identifications may leave empty lists, possibly for
+	// TagID larger than any identified one, they are skipped.
+	TagID maxTagID = 0;
+	bool hasIdentification = false;
+	for ( const auto & [tagID,idents] : identifications ) {
+		if ( idents.empty() == false ) {
+			maxTagID = std::max(maxTagID,tagID);
+			hasIdentification = true;
+		}
+	}
+	d_offsets.assign(hasIdentification == false ? 1 : size_t(maxTagID) + 2,0);
+	for ( const auto & [tagID,idents] : identifications ) {
+		if ( idents.empty() == true ) {
+			continue;
+		}
+		d_offsets[tagID+1] = idents.size();
+	}
+	for ( size_t i = 1; i < d_offsets.size(); ++i ) {
+		d_offsets[i] += d_offsets[i-1];
+	}
+	const static Time::SortableKey infinity(std::numeric_limits<int64_t>::max(),
+	                                        std::numeric_limits<int32_t>::max());
+	d_valids.resize(d_offsets.back());
 	for ( const auto & [tagID,idents] : identifications ) {
-		d_identifications.insert(std::make_pair(tagID+1,idents));
+		if ( idents.empty() == true ) {
+			continue;
+		}
+		auto valid = d_valids.begin() + d_offsets[tagID];
+		for ( const auto & i : idents ) {
+			*valid = {.Start = Time::SortKey(i->Start()),
+			          .End = !i->End() ? infinity : i->End()->SortKey(),
+			          .Tag = tagID,
+			          .Identification = i};
+			++valid;
+		}
+		// identifications of a same tag never overlap
+		std::sort(d_valids.begin() + d_offsets[tagID],
+		          valid,
+		          [](const ValidIdentification & a, const ValidIdentification & b) {
+			          return a.Start < b.Start;
+		          });
+	}
+	BuildSnapshots(maxSnapshotEntries);
+}
+
+void Identifier::Compiled::BuildSnapshots(size_t maxSnapshotEntries) {
+	const size_t nbTags = d_offsets.size() - 1;
+	std::vector<std::pair<Time::SortableKey,uint32_t>> starts,ends;
+	starts.reserve(d_valids.size());
+	ends.reserve(d_valids.size());
+	std::set<Time::SortableKey> boundaries = {Time::SortKey(Time::ConstPtr())};
+	for ( uint32_t i = 0; i < d_valids.size(); ++i ) {
+		const auto & v = d_valids[i];
+		starts.push_back(std::make_pair(v.Start,i));
+		ends.push_back(std::make_pair(v.End,i));
+		boundaries.insert(v.Start);
+		boundaries.insert(v.End);
+	}
+	boundaries.erase(std::make_pair(std::numeric_limits<int64_t>::max(),
+	                                std::numeric_limits<int32_t>::max()));
+	if ( boundaries.size() * nbTags > maxSnapshotEntries ) {
+		// IdentifyTags() will use Find() for each tag.
+		return;
+	}
+	std::sort(starts.begin(),starts.end());
+	std::sort(ends.begin(),ends.end());
+
+	std::vector<uint32_t> current(nbTags,UNIDENTIFIED);
+	d_snapshotStarts.reserve(boundaries.size());
+	d_snapshots.reserve(boundaries.size() * nbTags);
+	auto si = starts.cbegin();
+	auto ei = ends.cbegin();
+	for ( const auto & boundary : boundaries ) {
+		// validity ranges are [Start;End[, so we remove first
+		for ( ; ei != ends.cend() && ei->first <= boundary; ++ei ) {
+			auto tagID = d_valids[ei->second].Tag;
+			if ( current[tagID] == ei->second ) {
+				current[tagID] = UNIDENTIFIED;
+			}
+		}
+		for ( ; si != starts.cend() && si->first <= boundary; ++si ) {
+			current[d_valids[si->second].Tag] = si->second;
+		}
+		d_snapshotStarts.push_back(boundary);
+		d_snapshots.insert(d_snapshots.end(),current.begin(),current.end());
 	}
 }
 
+const uint32_t * Identifier::Compiled::SnapshotAt(const Time::SortableKey & time) const {
+	auto fi = std::upper_bound(d_snapshotStarts.begin(),
+	                           d_snapshotStarts.end(),
+	                           time);
+	// d_snapshotStarts.front() is -∞, fi is never begin()
+	return d_snapshots.data() + (fi - d_snapshotStarts.begin() - 1) * (d_offsets.size() - 1);
+}
+
 Identifier::Compiled::~Compiled() {
 }
 
+const Identifier::Compiled::ValidIdentification *
+Identifier::Compiled::Find(TagID tagID, const Time::SortableKey & time) const {
+	if ( tagID >= d_offsets.size() - 1 ) {
+		return nullptr;
+	}
+	auto begin = d_valids.begin() + d_offsets[tagID];
+	auto end = d_valids.begin() + d_offsets[tagID+1];
+	// finds the last interval starting before time
+	auto fi = std::upper_bound(begin,end,time,
+	                           [](const Time::SortableKey & t, const ValidIdentification & v) {
+		                           return t < v.Start;
+	                           });
+	if ( fi == begin || !(time < std::prev(fi)->End) ) {
+		return nullptr;
+	}
+	return &(*std::prev(fi));
+}
+
 Identification::ConstPtr Identifier::Compiled::Identify(TagID tagID, const Time & time) const {
-	try {
-		for ( const auto & i : d_identifications.at(tagID+1) ) {
-			if ( i->IsValid(time) == true ) {
-					return i;
-			}
+	auto valid = Find(tagID,time.SortKey());
+	if ( valid == nullptr ) {
+		return Identification::ConstPtr();
+	}
+	return valid->Identification;
+}
+
+void Identifier::Compiled::IdentifyTags(std::vector<const Identification*> & identifications,
+                                        const google::protobuf::RepeatedPtrField<fort::hermes::Tag> & tags,
+                                        const Time & time) const {
+	identifications.resize(tags.size());
+	auto res = identifications.begin();
+	if ( d_snapshotStarts.empty() == true ) {
+		const auto key = time.SortKey();
+		for ( const auto & t : tags ) {
+			auto valid = Find(t.id(),key);
+			*res = valid == nullptr ? nullptr : valid->Identification.get();
+			++res;
 		}
-	} catch ( const std::out_of_range & ) {
-		return Identification::Ptr();
+		return;
+	}
+	const size_t nbTags = d_offsets.size() - 1;
+	const uint32_t * snapshot = SnapshotAt(time.SortKey());
+	for ( const auto & t : tags ) {
+		uint32_t index = t.id() < nbTags ? snapshot[t.id()] : UNIDENTIFIED;
+		*res = index == UNIDENTIFIED ? nullptr : d_valids[index].Identification.get();
+		++res;
 	}
-	return Identification::Ptr();
 }
 
-Identifier::Compiled::ConstPtr Identifier::Compile() const {
-	return std::make_shared<Compiled>(d_identifications);
+Identifier::Compiled::ConstPtr Identifier::Compile(size_t maxSnapshotEntries) const {
+	return std::make_shared<Compiled>(d_identifications,maxSnapshotEntries);
 }
 
 std::map<AntID,TagID> Identifier::IdentificationsAt(const Time & time,
@@ -4,6 +4,8 @@
 #include <unordered_map>
 #include <set>
 
+#include <fort/hermes/FrameReadout.pb.h>
+
 #include "../Time.hpp"
 
 #include "Types.hpp"
@@ -33,6 +35,29 @@ public:
 	typedef std::shared_ptr<const IdentifierIF> ConstPtr;
 	virtual ~IdentifierIF();
 	virtual IdentificationConstPtr Identify(TagID tagID, const Time & time) const = 0;
+
+	// Identifies all tags of a frame
+	// @identifications set to the <Identification> of each tag in
+	//                  <tags>, or nullptr if the tag is not identified
+	// @tags the tags of the frame
+	// @time the <Time> of the frame
+	virtual void IdentifyTags(std::vector<const Identification*> & identifications,
+	                          const google::protobuf::RepeatedPtrField<fort::hermes::Tag> & tags,
+	                          const Time & time) const;
+
+	// Computes the position of all identified ants of a frame
+	// @positions the <PositionedAntList> to append ants to
+	// @tags the tags of the frame
+	// @time the <Time> of the frame
+	// @tagRegion if not nullptr, tags outside of this region are
+	//            ignored.
+	//
+	// Tags are identified with <IdentifyTags>, and ant poses are
+	// computed in a single batch.
+	void IdentifyAnts(PositionedAntList & positions,
+	                  const google::protobuf::RepeatedPtrField<fort::hermes::Tag> & tags,
+	                  const Time & time,
+	                  const AABB * tagRegion = nullptr) const;
 };
 
 
@@ -182,22 +207,105 @@ public:
 
 	void SetAntPositionUpdateCallback(const OnPositionUpdateCallback & callback);
 
+	// Defers ant pose updates during bulk edits
+	//
+	// While a PoseEditScope exists, changes of AntPoseEstimate or of
+	// Identification do not recompute ant poses right away. Instead
+	// each affected Identification is recomputed once, in parallel,
+	// when the outermost scope is committed. Scopes can be nested.
+	//
+	// A scope destroyed without <Commit>, for example while an
+	// exception unwinds, still tries to update the ant poses, but
+	// silently ignores any error.
+	class PoseEditScope {
+	public:
+		PoseEditScope(Identifier & identifier);
+		~PoseEditScope();
+
+		// Ends the scope
+		//
+		// Recomputes the deferred ant poses if this is the outermost
+		// scope. Any error, for example thrown by the position update
+		// callback, is propagated. Further calls have no effect.
+		void Commit();
+	private:
+		PoseEditScope(const PoseEditScope &) = delete;
+		PoseEditScope & operator=(const PoseEditScope &) = delete;
+
+		Identifier & d_identifier;
+		bool         d_committed;
+	};
+
 
 
+	// A compiled, read-only, Identifier
+	//
+	// All <Identification> are stored in a table indexed by
+	// <TagID>. Each tag has its validity intervals sorted, which are
+	// searched without ever throwing an exception.
+	//
+	// Time is also split in intervals where no <Identification>
+	// starts or ends. For each of these intervals, a snapshot maps
+	// every <TagID> to its <Identification>, so identifying a frame
+	// needs a single search for its snapshot, then one array lookup
+	// per tag.
+	//
+	// Snapshots cost O(B x T) in memory and build time, where B is
+	// the number of interval boundaries and T the largest identified
+	// <TagID> plus one. When B x T exceeds <maxSnapshotEntries>, no
+	// snapshot is built, and each tag of a frame is searched
+	// individually in its sorted intervals instead.
 	class Compiled : public IdentifierIF {
 	public:
 		typedef std::shared_ptr<const Compiled> ConstPtr;
-		Compiled(const std::unordered_map<TagID,IdentificationList> & identification);
+
+		// Default maximal number of snapshot entries, i.e. 64MiB
+		const static size_t MAX_SNAPSHOT_ENTRIES;
+
+		Compiled(const std::unordered_map<TagID,IdentificationList> & identification,
+		         size_t maxSnapshotEntries = MAX_SNAPSHOT_ENTRIES);
 		virtual ~Compiled();
 
 		IdentificationConstPtr Identify(TagID tagID, const Time & time) const override;
 
+		void IdentifyTags(std::vector<const Identification*> & identifications,
+		                  const google::protobuf::RepeatedPtrField<fort::hermes::Tag> & tags,
+		                  const Time & time) const override;
+
 	private:
-		typedef DenseMap<TagID,IdentificationConstList> IdentificationsByTagID;
-		IdentificationsByTagID d_identifications;
+		struct ValidIdentification {
+			Time::SortableKey      Start,End;
+			TagID                  Tag;
+			IdentificationConstPtr Identification;
+		};
+
+		const static uint32_t UNIDENTIFIED;
+
+		const ValidIdentification * Find(TagID tagID,
+		                                  const Time::SortableKey & time) const;
+
+		// Returns the snapshot for time, indexed by TagID.
+		const uint32_t * SnapshotAt(const Time::SortableKey & time) const;
+
+		void BuildSnapshots(size_t maxSnapshotEntries);
+
+		// intervals of tagID are d_valids[d_offsets[tagID]:d_offsets[tagID+1]]
+		std::vector<uint32_t>            d_offsets;
+		std::vector<ValidIdentification> d_valids;
+
+		// Snapshot i starts at d_snapshotStarts[i] and is stored in
+		// d_snapshots[i*NbTags:(i+1)*NbTags]. It holds the index in
+		// d_valids of each tag identification, or UNIDENTIFIED. Both
+		// are empty if snapshots would exceed the maximal size.
+		std::vector<Time::SortableKey>   d_snapshotStarts;
+		std::vector<uint32_t>            d_snapshots;
 	};
 
-	Compiled::ConstPtr Compile() const;
+	// Compiles the Identifier
+	// @maxSnapshotEntries the maximal size of <Compiled> snapshots
+	//
+	// @return a <Compiled> copy of the current <Identification>
+	Compiled::ConstPtr Compile(size_t maxSnapshotEntries = Compiled::MAX_SNAPSHOT_ENTRIES) const;
 
 
 	// Gets AntID <- TagID correspondances at a given time
@@ -229,6 +337,8 @@ private:
 
 	void UpdateIdentificationAntPosition(const IdentificationPtr & identification);
 
+	void UpdatePendingAntPositions();
+
 	typedef std::unordered_map<TagID,IdentificationList> IdentificationByTagID;
 
 	typedef std::set<AntPoseEstimateConstPtr,AntPoseEstimateComparator>     AntPoseEstimateList;
@@ -244,6 +354,10 @@ private:
 	IdentificationByTagID    d_identifications;
 	AntPoseEstimateByTagID   d_tagPoseEstimates;
 	OnPositionUpdateCallback d_callback;
+
+	size_t                             d_poseEditDepth;
+	std::vector<IdentificationPtr>     d_pendingPoseUpdates;
+	std::set<const Identification*>    d_pendingPoseSet;
 };
 
 
@@ -4,6 +4,7 @@
 #include "Ant.hpp"
 #include "AntShapeType.hpp"
 #include "AntMetadata.hpp"
+#include "AntPoseEstimate.hpp"
 
 #include <google/protobuf/util/time_util.h>
 
@@ -160,6 +161,106 @@ TEST_F(IdentifierUTest,CanIdentifyAntByTag) {
 }
 
 
+TEST_F(IdentifierUTest,CompilationSkipsEmptyIdentificationLists) {
+	auto identifier = std::make_shared<Identifier>();
+	auto shapeTypes = std::make_shared<AntShapeTypeContainer>();
+	auto metadata = std::make_shared<AntMetadata>();
+	auto a = identifier->CreateAnt(shapeTypes,metadata);
+	auto b = identifier->CreateAnt(shapeTypes,metadata);
+	auto low = Identifier::AddIdentification(identifier,a->AntID(),1,{},{});
+	auto high = Identifier::AddIdentification(identifier,b->AntID(),1000,{},{});
+
+	google::protobuf::RepeatedPtrField<fort::hermes::Tag> tags;
+	for ( TagID tagID : {1,1000,2000} ) {
+		tags.Add()->set_id(tagID);
+	}
+	std::vector<const Identification*> identifications;
+
+	// leaves an empty list for the largest TagID
+	ASSERT_NO_THROW(identifier->DeleteIdentification(high));
+	auto compiled = identifier->Compile();
+	compiled->IdentifyTags(identifications,tags,Time());
+	ASSERT_EQ(identifications.size(),3);
+	EXPECT_EQ(identifications[0],low.get());
+	EXPECT_EQ(identifications[1],nullptr);
+	EXPECT_EQ(identifications[2],nullptr);
+	EXPECT_FALSE(compiled->Identify(1000,Time()));
+
+	// only empty lists remain
+	ASSERT_NO_THROW(identifier->DeleteIdentification(low));
+	compiled = identifier->Compile();
+	compiled->IdentifyTags(identifications,tags,Time());
+	ASSERT_EQ(identifications.size(),3);
+	for ( const auto & identification : identifications ) {
+		EXPECT_EQ(identification,nullptr);
+	}
+}
+
+TEST_F(IdentifierUTest,PoseEditScopeDefersAntPoseUpdates) {
+	auto identifier = std::make_shared<Identifier>();
+	auto a = identifier->CreateAnt(std::make_shared<AntShapeTypeContainer>(),
+	                               std::make_shared<AntMetadata>());
+	auto ident = Identifier::AddIdentification(identifier,a->AntID(),1,
+	                                           Time::ConstPtr(),Time::ConstPtr());
+	size_t updates = 0;
+	identifier->SetAntPositionUpdateCallback([&updates](const Identification::Ptr &,
+	                                                    const std::vector<AntPoseEstimateConstPtr> &) {
+		                                         ++updates;
+	                                         });
+	auto estimate = [](FrameID frameID, double x) {
+		                return std::make_shared<AntPoseEstimate>(FrameReference("foo",frameID,Time::FromTimeT(frameID)),
+		                                                         1,
+		                                                         Eigen::Vector2d(x,0),
+		                                                         0.0);
+	                };
+
+	identifier->SetAntPoseEstimate(estimate(1,2.0));
+	EXPECT_EQ(updates,1);
+	EXPECT_TRUE(VectorAlmostEqual(ident->AntPosition(),Eigen::Vector2d(2,0)));
+
+	{
+		Identifier::PoseEditScope outer(*identifier);
+		{
+			Identifier::PoseEditScope inner(*identifier);
+			for ( size_t i = 2; i <= 10; ++i ) {
+				identifier->SetAntPoseEstimate(estimate(i,2.0 * i));
+			}
+			identifier->DeleteAntPoseEstimate(estimate(10,0.0));
+		}
+		EXPECT_EQ(updates,1);
+		EXPECT_TRUE(VectorAlmostEqual(ident->AntPosition(),Eigen::Vector2d(2,0)));
+	}
+	// mean of 2,4,...,18
+	EXPECT_EQ(updates,2);
+	EXPECT_TRUE(VectorAlmostEqual(ident->AntPosition(),Eigen::Vector2d(10,0)));
+
+	{
+		Identifier::PoseEditScope edits(*identifier);
+		identifier->SetAntPoseEstimate(estimate(11,30.0));
+		identifier->DeleteIdentification(ident);
+	}
+	EXPECT_EQ(updates,2);
+
+	ident = Identifier::AddIdentification(identifier,a->AntID(),1,
+	                                      Time::ConstPtr(),Time::ConstPtr());
+	identifier->SetAntPositionUpdateCallback([](const Identification::Ptr &,
+	                                            const std::vector<AntPoseEstimateConstPtr> &) {
+		                                         throw std::runtime_error("update failed");
+	                                         });
+	{
+		Identifier::PoseEditScope edits(*identifier);
+		identifier->SetAntPoseEstimate(estimate(12,40.0));
+		EXPECT_THROW(edits.Commit(),std::runtime_error);
+		// already committed, does nothing
+		EXPECT_NO_THROW(edits.Commit());
+	}
+
+	EXPECT_NO_THROW({
+			Identifier::PoseEditScope edits(*identifier);
+			identifier->SetAntPoseEstimate(estimate(13,50.0));
+		});
+}
+
 TEST_F(IdentifierUTest,Compilation) {
 	std::random_device r;
 	// Choose a random mean between 1 and 6
@@ -255,6 +356,31 @@ TEST_F(IdentifierUTest,Compilation) {
 		++i;
 	}
 
+	google::protobuf::RepeatedPtrField<fort::hermes::Tag> frameTags;
+	for ( const auto & t : tags ) {
+		frameTags.Add()->set_id(t);
+	}
+	// unknown tags
+	frameTags.Add()->set_id(*tags.rbegin() + 1);
+	frameTags.Add()->set_id(std::numeric_limits<TagID>::max() - 1);
+	std::vector<const Identification*> identifications;
+	// without any snapshot, tags are searched individually
+	auto withoutSnapshots = identifier->Compile(0);
+	for ( const auto & t : times ) {
+		// checks each side of every snapshot boundary
+		for ( const auto & time : {t.Add(-1),t,t.Add(1)} ) {
+			compiled->IdentifyTags(identifications,frameTags,time);
+			ASSERT_EQ(identifications.size(),frameTags.size());
+			for ( size_t i = 0; i < frameTags.size(); ++i ) {
+				auto expected = identifier->Identify(frameTags.Get(i).id(),time);
+				EXPECT_EQ(identifications[i],expected.get());
+			}
+			std::vector<const Identification*> searched;
+			withoutSnapshots->IdentifyTags(searched,frameTags,time);
+			EXPECT_EQ(searched,identifications);
+		}
+	}
+
 
 #ifdef MYRMIDON_TEST_TIMING
 	auto computeMean =
@@ -38,6 +38,11 @@ public:
 	template <typename OutputIter>
 	void ComputeCollisions(OutputIter & iter) const;
 
+	// Calls fn on every Object whose volume intersects volume. It
+	// only reads the tree, so it could be called concurrently.
+	template <typename Function>
+	void ForEachIntersecting(const AABB & volume, Function && fn) const;
+
 	size_t Depth() const;
 
 	void Debug(std::ostream & out) const;
@@ -76,6 +81,11 @@ private:
 	                                    ReminderList & reminders,
 	                                    OutputIter & output);
 
+	template <typename Function>
+	static void ForEachIntersectingNode(const typename Node::Ptr & node,
+	                                    const AABB & volume,
+	                                    Function & fn);
+
 	typename Node::Ptr d_root;
 };
 
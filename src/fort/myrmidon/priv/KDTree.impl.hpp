@@ -252,6 +252,29 @@ KDTree<T,Scalar,AmbientDim>::ComputeCollisions(OutputIter & iter) const {
 	ComputeCollisionForNode(d_root,{},reminders,iter);
 }
 
+template<typename T, typename Scalar, int AmbientDim>
+template <typename Function>
+inline void
+KDTree<T,Scalar,AmbientDim>::ForEachIntersectingNode(const typename Node::Ptr & node,
+                                                     const AABB & volume,
+                                                     Function & fn) {
+	if ( !node || node->Volume.intersects(volume) == false ) {
+		return;
+	}
+	if ( node->ObjectVolume.intersects(volume) ) {
+		fn(node->Object);
+	}
+	ForEachIntersectingNode(node->Lower,volume,fn);
+	ForEachIntersectingNode(node->Upper,volume,fn);
+}
+
+template<typename T, typename Scalar, int AmbientDim>
+template <typename Function>
+inline void
+KDTree<T,Scalar,AmbientDim>::ForEachIntersecting(const AABB & volume, Function && fn) const {
+	ForEachIntersectingNode(d_root,volume,fn);
+}
+
 template<typename T, typename Scalar, int AmbientDim>
 inline size_t
 KDTree<T,Scalar,AmbientDim>::Depth() const {
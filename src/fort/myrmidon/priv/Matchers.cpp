@@ -1,6 +1,10 @@
 #include "Matchers.hpp"
 #include "Ant.hpp"
 
+#include <algorithm>
+#include <set>
+#include <limits>
+
 
 namespace fort {
 namespace myrmidon {
@@ -8,190 +12,239 @@ namespace priv {
 
 Matcher::~Matcher() {}
 
-Matcher::Ptr Matcher::And(const std::vector<Ptr>  &matchers) {
-	class AndMatcher : public Matcher {
-	private:
-		std::vector<Ptr> d_matchers;
-	public:
-		AndMatcher(const std::vector<Ptr> & matchers)
-			: d_matchers(matchers) {
-		}
-		virtual ~AndMatcher() {}
-		void SetUpOnce(const ConstAntByID & ants) override {
-			std::for_each(d_matchers.begin(),d_matchers.end(),
-			              [&ants](const Ptr & matcher) { matcher->SetUpOnce(ants); });
-		}
+std::shared_ptr<const InteractionTypeSet> Matcher::InteractionTypeFilter() const {
+	return std::shared_ptr<const InteractionTypeSet>();
+}
 
-		void SetUp(const IdentifiedFrame::ConstPtr & identifiedFrame,
-		           const CollisionFrame::ConstPtr & collisionFrame) override {
-			std::for_each(d_matchers.begin(),d_matchers.end(),
-			              [&](const Ptr & matcher) { matcher->SetUp(identifiedFrame,collisionFrame); });
+// Reports if a Matcher may reject a pair because of its types. It is
+// defined after all matchers.
+static bool DependsOnTypes(const Matcher & matcher);
 
-		}
+class AndMatcher : public Matcher {
+private:
+	friend class CompiledMatcher;
+	friend bool DependsOnTypes(const Matcher & matcher);
+	std::vector<Ptr> d_matchers;
+public:
+	AndMatcher(const std::vector<Ptr> & matchers)
+		: d_matchers(matchers) {
+	}
+	virtual ~AndMatcher() {}
+	void SetUpOnce(const ConstAntByID & ants) override {
+		std::for_each(d_matchers.begin(),d_matchers.end(),
+		              [&ants](const Ptr & matcher) { matcher->SetUpOnce(ants); });
+	}
 
-		bool Match(fort::myrmidon::AntID ant1,
-		           fort::myrmidon::AntID ant2,
-		           const fort::myrmidon::InteractionTypes & type) override {
-			for ( const auto & m : d_matchers ) {
-				if ( m->Match(ant1,ant2,type) == false ) {
-					return false;
-				}
+	void SetUp(const IdentifiedFrame::ConstPtr & identifiedFrame,
+	           const CollisionFrame::ConstPtr & collisionFrame) override {
+		std::for_each(d_matchers.begin(),d_matchers.end(),
+		              [&](const Ptr & matcher) { matcher->SetUp(identifiedFrame,collisionFrame); });
+
+	}
+
+	bool Match(fort::myrmidon::AntID ant1,
+	           fort::myrmidon::AntID ant2,
+	           const fort::myrmidon::InteractionTypes & type) override {
+		for ( const auto & m : d_matchers ) {
+			if ( m->Match(ant1,ant2,type) == false ) {
+				return false;
 			}
-			return true;
 		}
+		return true;
+	}
+
+	void Format(std::ostream & out ) const override {
+		std::string prefix = "( ";
+		for ( const auto & m : d_matchers ) {
+			out << prefix;
+			m->Format(out);
+			prefix = " && ";
+		}
+		out << " )";
+	}
 
-		void Format(std::ostream & out ) const override {
-			std::string prefix = "( ";
-			for ( const auto & m : d_matchers ) {
-				out << prefix;
-				m->Format(out);
-				prefix = " && ";
+	// A type matcher only requires its pairing to be present, it
+	// does not exclude others: an interaction matching all children
+	// may contain any pairing of their sets, so we use their union. A
+	// child without filter may either not look at types, and then
+	// can be ignored, or accept any types through a nested type
+	// matcher, e.g. `Or({AntID(1),InteractionType(3,3)})`, and then
+	// no pairing can be left out.
+	std::shared_ptr<const InteractionTypeSet> InteractionTypeFilter() const override {
+		std::shared_ptr<InteractionTypeSet> res;
+		for ( const auto & m : d_matchers ) {
+			auto types = m->InteractionTypeFilter();
+			if ( !types ) {
+				if ( DependsOnTypes(*m) == true ) {
+					return types;
+				}
+				continue;
+			}
+			if ( !res ) {
+				res = std::make_shared<InteractionTypeSet>();
 			}
-			out << " )";
+			res->insert(types->begin(),types->end());
 		}
-	};
+		return res;
+	}
+};
 
-	return std::make_shared<AndMatcher>(matchers);
-}
+class OrMatcher : public Matcher {
+private:
+	friend class CompiledMatcher;
+	friend bool DependsOnTypes(const Matcher & matcher);
+	std::vector<Ptr> d_matchers;
+public:
+	OrMatcher(const std::vector<Ptr> &  matchers)
+		: d_matchers(matchers) {
+	}
+	virtual ~OrMatcher() {}
+	void SetUpOnce(const ConstAntByID & ants) override {
+		std::for_each(d_matchers.begin(),d_matchers.end(),
+		              [&ants](const Ptr & matcher) { matcher->SetUpOnce(ants); });
+	}
 
-Matcher::Ptr Matcher::Or(const std::vector<Ptr> & matchers) {
-	class OrMatcher : public Matcher {
-	private:
-		std::vector<Ptr> d_matchers;
-	public:
-		OrMatcher(const std::vector<Ptr> &  matchers)
-			: d_matchers(matchers) {
-		}
-		virtual ~OrMatcher() {}
-		void SetUpOnce(const ConstAntByID & ants) override {
-			std::for_each(d_matchers.begin(),d_matchers.end(),
-			              [&ants](const Ptr & matcher) { matcher->SetUpOnce(ants); });
-		}
+	void SetUp(const IdentifiedFrame::ConstPtr & identifiedFrame,
+	           const CollisionFrame::ConstPtr & collisionFrame) override {
+		std::for_each(d_matchers.begin(),d_matchers.end(),
+		              [&](const Ptr & matcher) { matcher->SetUp(identifiedFrame,collisionFrame); });
 
-		void SetUp(const IdentifiedFrame::ConstPtr & identifiedFrame,
-		           const CollisionFrame::ConstPtr & collisionFrame) override {
-			std::for_each(d_matchers.begin(),d_matchers.end(),
-			              [&](const Ptr & matcher) { matcher->SetUp(identifiedFrame,collisionFrame); });
+	}
 
+	bool Match(fort::myrmidon::AntID ant1,
+	           fort::myrmidon::AntID ant2,
+	           const fort::myrmidon::InteractionTypes & types) override {
+		for ( const auto & m : d_matchers ) {
+			if ( m->Match(ant1,ant2,types) == true ) {
+				return true;
+			}
 		}
+		return false;
+	}
 
-		bool Match(fort::myrmidon::AntID ant1,
-		           fort::myrmidon::AntID ant2,
-		           const fort::myrmidon::InteractionTypes & types) override {
-			for ( const auto & m : d_matchers ) {
-				if ( m->Match(ant1,ant2,types) == true ) {
-					return true;
-				}
-			}
-			return false;
+	void Format(std::ostream & out ) const override {
+		std::string prefix = "( ";
+		for ( const auto & m : d_matchers ) {
+			out << prefix;
+			m->Format(out);
+			prefix = " || ";
 		}
+		out << " )";
+	}
 
-		void Format(std::ostream & out ) const override {
-			std::string prefix = "( ";
-			for ( const auto & m : d_matchers ) {
-				out << prefix;
-				m->Format(out);
-				prefix = " || ";
+	std::shared_ptr<const InteractionTypeSet> InteractionTypeFilter() const override {
+		auto res = std::make_shared<InteractionTypeSet>();
+		for ( const auto & m : d_matchers ) {
+			auto types = m->InteractionTypeFilter();
+			if ( !types ) {
+				return types;
 			}
-			out << " )";
+			res->insert(types->begin(),types->end());
 		}
+		return res;
+	}
 
-	};
-	return std::make_shared<OrMatcher>(matchers);
-}
+};
 
-Matcher::Ptr Matcher::AntIDMatcher(AntID ID) {
-	class AntIDMatcher : public Matcher {
-	private:
-		AntID d_id;
-	public:
-		AntIDMatcher (AntID ant)
-			: d_id(ant) {
-		}
-		virtual ~AntIDMatcher() {}
-		void SetUpOnce(const ConstAntByID & ants) override {
-		}
+class AntIDEqualMatcher : public Matcher {
+private:
+	friend class CompiledMatcher;
+	AntID d_id;
+public:
+	AntIDEqualMatcher (AntID ant)
+		: d_id(ant) {
+	}
+	virtual ~AntIDEqualMatcher() {}
+	void SetUpOnce(const ConstAntByID & ants) override {
+	}
 
-		void SetUp(const IdentifiedFrame::ConstPtr & identifiedFrame,
-		           const CollisionFrame::ConstPtr & collisionFrame) override {
-		}
+	void SetUp(const IdentifiedFrame::ConstPtr & identifiedFrame,
+	           const CollisionFrame::ConstPtr & collisionFrame) override {
+	}
 
-		bool Match(fort::myrmidon::AntID ant1,
-		           fort::myrmidon::AntID ant2,
-		           const fort::myrmidon::InteractionTypes & types) override {
-			if ( ant2 != 0 && ant2 == d_id ) {
-				return true;
-			}
-			return ant1 == d_id;
+	bool Match(fort::myrmidon::AntID ant1,
+	           fort::myrmidon::AntID ant2,
+	           const fort::myrmidon::InteractionTypes & types) override {
+		if ( ant2 != 0 && ant2 == d_id ) {
+			return true;
 		}
+		return ant1 == d_id;
+	}
 
-		void Format(std::ostream & out ) const override {
-			out << "Ant.ID == " << Ant::FormatID(d_id);
-		}
+	void Format(std::ostream & out ) const override {
+		out << "Ant.ID == " << Ant::FormatID(d_id);
+	}
 
-	};
-	return std::make_shared<AntIDMatcher>(ID);
-}
+};
 
-Matcher::Ptr Matcher::AntColumnMatcher(const std::string & name, const AntStaticValue & value) {
-	class AntColumnMatcher : public Matcher {
-	private:
-		std::string    d_name;
-		AntStaticValue d_value;
-		ConstAntByID   d_ants;
-		Time           d_time;
-	public:
-		AntColumnMatcher (const std::string & name,
-		                  const AntStaticValue & value)
-			: d_name(name)
-			, d_value(value){
-		}
-		virtual ~AntColumnMatcher() {}
-		void SetUpOnce(const ConstAntByID & ants) override {
-			d_ants = ants;
-		}
-
-		void SetUp(const IdentifiedFrame::ConstPtr & identifiedFrame,
-		           const CollisionFrame::ConstPtr & collisionFrame) override {
-			if ( !identifiedFrame == false ) {
-				d_time = identifiedFrame->FrameTime;
-				return;
-			}
+class AntColumnEqualMatcher : public Matcher {
+private:
+	friend class CompiledMatcher;
+	std::string           d_name;
+	AntStaticValue        d_value;
+	ConstAntByID          d_ants;
+	AntMetadata::ColumnID d_column;
+	Time::SortableKey     d_time;
+public:
+	AntColumnEqualMatcher (const std::string & name,
+	                       const AntStaticValue & value)
+		: d_name(name)
+		, d_value(value)
+		, d_column(std::numeric_limits<AntMetadata::ColumnID>::max()) {
+	}
+	virtual ~AntColumnEqualMatcher() {}
+	void SetUpOnce(const ConstAntByID & ants) override {
+		d_ants = ants;
+		if ( d_ants.empty() ) {
+			return;
+		}
+		try {
+			d_column = d_ants.begin()->second->ColumnIDOf(d_name);
+		} catch ( const std::out_of_range & ) {
+			// unknown column will throw when matching, as GetValue would
+		}
+	}
 
-			if ( !collisionFrame == false ) {
-				d_time = collisionFrame->FrameTime;
-				return;
-			}
-			throw std::runtime_error("This matcher requires current time through ant position or interaction, but none is available in the current context");
+	void SetUp(const IdentifiedFrame::ConstPtr & identifiedFrame,
+	           const CollisionFrame::ConstPtr & collisionFrame) override {
+		if ( !identifiedFrame == false ) {
+			d_time = identifiedFrame->FrameTime.SortKey();
+			return;
+		}
 
+		if ( !collisionFrame == false ) {
+			d_time = collisionFrame->FrameTime.SortKey();
+			return;
 		}
+		throw std::runtime_error("This matcher requires current time through ant position or interaction, but none is available in the current context");
 
-		bool Match(fort::myrmidon::AntID ant1,
-		           fort::myrmidon::AntID ant2,
-		           const fort::myrmidon::InteractionTypes & types) override {
-			auto fi = d_ants.find(ant2);
-			if ( fi != d_ants.end()
-			     && fi->second->GetValue(d_name,d_time) == d_value ) {
-				return true;
-			}
+	}
 
-			fi = d_ants.find(ant1);
-			if ( fi == d_ants.end() ) {
-				return false;
-			}
-			return fi->second->GetValue(d_name,d_time) == d_value;
+	bool Match(fort::myrmidon::AntID ant1,
+	           fort::myrmidon::AntID ant2,
+	           const fort::myrmidon::InteractionTypes & types) override {
+		auto fi = d_ants.find(ant2);
+		if ( fi != d_ants.end()
+		     && fi->second->GetValue(d_column,d_time) == d_value ) {
+			return true;
 		}
 
-		void Format(std::ostream & out ) const override {
-			out << "Ant.'" << d_name << "' == " << d_value;
+		fi = d_ants.find(ant1);
+		if ( fi == d_ants.end() ) {
+			return false;
 		}
+		return fi->second->GetValue(d_column,d_time) == d_value;
+	}
 
-	};
-	return std::make_shared<AntColumnMatcher>(name,value);
-}
+	void Format(std::ostream & out ) const override {
+		out << "Ant.'" << d_name << "' == " << d_value;
+	}
+
+};
 
 class AntDistanceMatcher : public Matcher {
 private:
+	friend class CompiledMatcher;
 	double                                   d_distanceSquare;
 	DenseMap<AntID,std::pair<double,double>> d_positions;
 	bool                                     d_greater;
@@ -242,6 +295,7 @@ public:
 
 class AntAngleMatcher : public Matcher {
 private:
+	friend class CompiledMatcher;
 	double                 d_angle;
 	DenseMap<AntID,double> d_angles;
 	bool                   d_greater;
@@ -292,6 +346,7 @@ public:
 
 class InteractionTypeSingleMatcher : public Matcher {
 private:
+	friend class CompiledMatcher;
 	AntShapeTypeID d_type;
 public:
 	InteractionTypeSingleMatcher (AntShapeTypeID type)
@@ -320,10 +375,15 @@ public:
 	void Format(std::ostream & out ) const override {
 		out << "InteractionType (" << d_type << " - " << d_type << ")";
 	}
+
+	std::shared_ptr<const InteractionTypeSet> InteractionTypeFilter() const override {
+		return std::make_shared<InteractionTypeSet>(InteractionTypeSet{{d_type,d_type}});
+	}
 };
 
 class InteractionTypeDualMatcher : public Matcher {
 private:
+	friend class CompiledMatcher;
 	AntShapeTypeID d_type1,d_type2;
 public:
 	InteractionTypeDualMatcher(AntShapeTypeID type1,AntShapeTypeID type2) {
@@ -362,9 +422,547 @@ public:
 	void Format(std::ostream & out ) const override {
 		out << "InteractionType (" << d_type1 << " - " << d_type2 << ")";
 	}
+
+	std::shared_ptr<const InteractionTypeSet> InteractionTypeFilter() const override {
+		return std::make_shared<InteractionTypeSet>(InteractionTypeSet{{d_type1,d_type2}});
+	}
 };
 
 
+// A Matcher tree compiled in a flat program
+//
+// The tree is stored in prefix order, each <Instruction> knowing the
+// size of its subtree so it can be skipped. Children of And / Or
+// nodes are reordered from the cheapest to the most expensive to
+// evaluate, using a fixed cost per kind of predicate, as their
+// selectivity is not known before the query runs. Children that may
+// throw when matching, i.e. columns that may be unknown and matchers
+// of unknown kind, are kept in place and only the children between
+// them are reordered. So short-circuiting skips exactly the same
+// throwing children as the source tree.
+//
+// Ant metadata predicates are evaluated once for all ants over each
+// time span where no value changes, so matching is a bitset lookup
+// per ant. Ant positions and angles are stored per frame in flat
+// arrays indexed by AntID. When a <CollisionFrame> is given, distance
+// and angle predicates are evaluated for all its collisions at once
+// in branchless loops, and pairs are then matched in the frame
+// order. Other pairs are evaluated one by one.
+class CompiledMatcher : public Matcher {
+public:
+	CompiledMatcher(const Ptr & source)
+		: d_source(source)
+		, d_needsPositions(false)
+		, d_nbAnts(0)
+		, d_cursor(0) {
+		Emit(source);
+	}
+
+	virtual ~CompiledMatcher() {}
+
+	void SetUpOnce(const ConstAntByID & ants) override {
+		d_nbAnts = 0;
+		for ( const auto & [antID,ant] : ants ) {
+			d_nbAnts = std::max(d_nbAnts,size_t(antID) + 1);
+		}
+		for ( auto & c : d_columns ) {
+			BuildColumn(c,ants);
+		}
+		for ( const auto & m : d_others ) {
+			m->SetUpOnce(ants);
+		}
+	}
+
+	void SetUp(const IdentifiedFrame::ConstPtr & identifiedFrame,
+	           const CollisionFrame::ConstPtr & collisionFrame) override {
+		if ( d_columns.empty() == false ) {
+			Time::SortableKey key;
+			if ( !identifiedFrame == false ) {
+				key = identifiedFrame->FrameTime.SortKey();
+			} else if ( !collisionFrame == false ) {
+				key = collisionFrame->FrameTime.SortKey();
+			} else {
+				throw std::runtime_error("This matcher requires current time through ant position or interaction, but none is available in the current context");
+			}
+			for ( auto & c : d_columns ) {
+				auto fi = std::upper_bound(c.Starts.begin(),c.Starts.end(),key);
+				// c.Starts.front() is -∞, fi is never begin()
+				c.Current = c.Matches.data() + (fi - c.Starts.begin() - 1) * d_nbAnts;
+			}
+		}
+
+		d_pairs.clear();
+		d_cursor = 0;
+		if ( d_needsPositions == true ) {
+			if ( !identifiedFrame ) {
+				throw std::runtime_error("This matcher requires ant position, which are unavailable in the current context");
+			}
+			for ( const auto & antID : d_presents ) {
+				d_present[antID] = false;
+			}
+			d_presents.clear();
+			for ( const auto & pa : identifiedFrame->Positions ) {
+				if ( pa.ID >= d_present.size() ) {
+					d_x.resize(pa.ID + 1);
+					d_y.resize(pa.ID + 1);
+					d_angle.resize(pa.ID + 1);
+					d_present.resize(pa.ID + 1,false);
+				}
+				d_x[pa.ID] = pa.Position.x();
+				d_y[pa.ID] = pa.Position.y();
+				d_angle[pa.ID] = pa.Angle;
+				d_present[pa.ID] = true;
+				d_presents.push_back(pa.ID);
+			}
+			if ( !collisionFrame == false ) {
+				EvaluatePairs(*collisionFrame);
+			}
+		}
+
+		for ( const auto & m : d_others ) {
+			m->SetUp(identifiedFrame,collisionFrame);
+		}
+	}
+
+	bool Match(fort::myrmidon::AntID ant1,
+	           fort::myrmidon::AntID ant2,
+	           const fort::myrmidon::InteractionTypes & types) override {
+		return Evaluate(0,ant1,ant2,types,FindPair(ant1,ant2));
+	}
+
+	void Format(std::ostream & out) const override {
+		d_source->Format(out);
+	}
+
+	std::shared_ptr<const InteractionTypeSet> InteractionTypeFilter() const override {
+		return d_source->InteractionTypeFilter();
+	}
+
+private:
+	enum class Operation : uint8_t {
+		AND = 0,
+		OR,
+		ANT_ID,
+		ANT_COLUMN,
+		DISTANCE_SMALLER,
+		DISTANCE_GREATER,
+		ANGLE_SMALLER,
+		ANGLE_GREATER,
+		TYPE_SINGLE,
+		TYPE_DUAL,
+		// any other Matcher, evaluated through its virtual interface
+		OTHER,
+	};
+
+	struct Instruction {
+		Operation      Op;
+		// number of instructions in this subtree, itself included
+		uint32_t       Size;
+		// number of children for AND and OR
+		uint32_t       Arity;
+		// index in d_columns for ANT_COLUMN, d_others for OTHER, or
+		// the row of d_pairMatches for distance and angle predicates
+		uint32_t       Index;
+		AntID          ID;
+		AntShapeTypeID Type1,Type2;
+		// squared distance or angle threshold
+		double         Value;
+	};
+
+	struct Column {
+		std::string                    Name;
+		AntStaticValue                 Value;
+		// Matches[i*nbAnts + antID] tells if antID matches from
+		// Starts[i] until Starts[i+1]
+		std::vector<Time::SortableKey> Starts;
+		std::vector<uint8_t>           Matches;
+		const uint8_t *                Current = nullptr;
+		// the column does not exist: Matches only tells which ants
+		// exist, and matching them throws, as Ant::GetValue would
+		bool                           Unknown = false;
+	};
+
+	const static size_t NO_PAIR = std::numeric_limits<size_t>::max();
+
+	static size_t Cost(const Matcher & m) {
+		if ( auto a = dynamic_cast<const AndMatcher*>(&m) ) {
+			return ChildrenCost(a->d_matchers);
+		}
+		if ( auto o = dynamic_cast<const OrMatcher*>(&m) ) {
+			return ChildrenCost(o->d_matchers);
+		}
+		if ( dynamic_cast<const AntIDEqualMatcher*>(&m) != nullptr ) {
+			return 1;
+		}
+		if ( dynamic_cast<const AntColumnEqualMatcher*>(&m) != nullptr
+		     || dynamic_cast<const InteractionTypeSingleMatcher*>(&m) != nullptr
+		     || dynamic_cast<const InteractionTypeDualMatcher*>(&m) != nullptr ) {
+			return 2;
+		}
+		if ( dynamic_cast<const AntDistanceMatcher*>(&m) != nullptr
+		     || dynamic_cast<const AntAngleMatcher*>(&m) != nullptr ) {
+			return 4;
+		}
+		return 16;
+	}
+
+	static size_t ChildrenCost(const std::vector<Ptr> & matchers) {
+		size_t res = 0;
+		for ( const auto & m : matchers ) {
+			res += Cost(*m);
+		}
+		return res;
+	}
+
+	static bool MayThrow(const Matcher & m) {
+		if ( auto a = dynamic_cast<const AndMatcher*>(&m) ) {
+			return std::any_of(a->d_matchers.begin(),a->d_matchers.end(),
+			                   [](const Ptr & c) { return MayThrow(*c); });
+		}
+		if ( auto o = dynamic_cast<const OrMatcher*>(&m) ) {
+			return std::any_of(o->d_matchers.begin(),o->d_matchers.end(),
+			                   [](const Ptr & c) { return MayThrow(*c); });
+		}
+		return dynamic_cast<const AntIDEqualMatcher*>(&m) == nullptr
+			&& dynamic_cast<const AntDistanceMatcher*>(&m) == nullptr
+			&& dynamic_cast<const AntAngleMatcher*>(&m) == nullptr
+			&& dynamic_cast<const InteractionTypeSingleMatcher*>(&m) == nullptr
+			&& dynamic_cast<const InteractionTypeDualMatcher*>(&m) == nullptr;
+	}
+
+	void EmitChildren(Operation op, const std::vector<Ptr> & matchers) {
+		std::vector<Ptr> sorted = matchers;
+		auto sortRange = [](std::vector<Ptr>::iterator begin,
+		                    std::vector<Ptr>::iterator end) {
+			                 std::stable_sort(begin,end,
+			                                  [](const Ptr & a, const Ptr & b) {
+				                                  return Cost(*a) < Cost(*b);
+			                                  });
+		                 };
+		auto begin = sorted.begin();
+		for ( auto it = sorted.begin(); it != sorted.end(); ++it ) {
+			if ( MayThrow(**it) == true ) {
+				sortRange(begin,it);
+				begin = it + 1;
+			}
+		}
+		sortRange(begin,sorted.end());
+		size_t index = d_program.size();
+		d_program.push_back({.Op = op,.Arity = uint32_t(sorted.size())});
+		for ( const auto & m : sorted ) {
+			Emit(m);
+		}
+		d_program[index].Size = d_program.size() - index;
+	}
+
+	void Emit(const Ptr & matcher) {
+		const Matcher & m = *matcher;
+		if ( auto a = dynamic_cast<const AndMatcher*>(&m) ) {
+			EmitChildren(Operation::AND,a->d_matchers);
+			return;
+		}
+		if ( auto o = dynamic_cast<const OrMatcher*>(&m) ) {
+			EmitChildren(Operation::OR,o->d_matchers);
+			return;
+		}
+		Instruction ins = {.Size = 1};
+		if ( auto id = dynamic_cast<const AntIDEqualMatcher*>(&m) ) {
+			ins.Op = Operation::ANT_ID;
+			ins.ID = id->d_id;
+		} else if ( auto c = dynamic_cast<const AntColumnEqualMatcher*>(&m) ) {
+			ins.Op = Operation::ANT_COLUMN;
+			ins.Index = d_columns.size();
+			d_columns.push_back({.Name = c->d_name,.Value = c->d_value});
+		} else if ( auto d = dynamic_cast<const AntDistanceMatcher*>(&m) ) {
+			ins.Op = d->d_greater ? Operation::DISTANCE_GREATER : Operation::DISTANCE_SMALLER;
+			ins.Value = d->d_distanceSquare;
+			ins.Index = d_pairwise.size();
+			d_pairwise.push_back(d_program.size());
+			d_needsPositions = true;
+		} else if ( auto a = dynamic_cast<const AntAngleMatcher*>(&m) ) {
+			ins.Op = a->d_greater ? Operation::ANGLE_GREATER : Operation::ANGLE_SMALLER;
+			ins.Value = a->d_angle;
+			ins.Index = d_pairwise.size();
+			d_pairwise.push_back(d_program.size());
+			d_needsPositions = true;
+		} else if ( auto t = dynamic_cast<const InteractionTypeSingleMatcher*>(&m) ) {
+			ins.Op = Operation::TYPE_SINGLE;
+			ins.Type1 = t->d_type;
+			ins.Type2 = t->d_type;
+		} else if ( auto t = dynamic_cast<const InteractionTypeDualMatcher*>(&m) ) {
+			ins.Op = Operation::TYPE_DUAL;
+			ins.Type1 = t->d_type1;
+			ins.Type2 = t->d_type2;
+		} else {
+			ins.Op = Operation::OTHER;
+			ins.Index = d_others.size();
+			d_others.push_back(matcher);
+		}
+		d_program.push_back(ins);
+	}
+
+	void BuildColumn(Column & column, const ConstAntByID & ants) const {
+		std::set<Time::SortableKey> boundaries = {Time::SortKey(Time::ConstPtr())};
+		std::vector<const Ant::CompiledColumn*> values(d_nbAnts,nullptr);
+		column.Starts.clear();
+		column.Matches.clear();
+		column.Unknown = false;
+		try {
+			for ( const auto & [antID,ant] : ants ) {
+				values[antID] = &ant->CompiledValues(ant->ColumnIDOf(column.Name));
+				boundaries.insert(values[antID]->Times.begin(),
+				                  values[antID]->Times.end());
+			}
+		} catch ( const std::out_of_range & ) {
+			// unknown column will throw when matching, as GetValue would
+			column.Unknown = true;
+			column.Starts.push_back(*boundaries.begin());
+			column.Matches.resize(d_nbAnts,false);
+			for ( const auto & [antID,ant] : ants ) {
+				column.Matches[antID] = true;
+			}
+			column.Current = column.Matches.data();
+			return;
+		}
+		std::vector<uint8_t> current(d_nbAnts,false);
+		for ( const auto & boundary : boundaries ) {
+			for ( const auto & [antID,ant] : ants ) {
+				const auto & v = *values[antID];
+				auto fi = std::upper_bound(v.Times.begin(),v.Times.end(),boundary);
+				current[antID] = v.Values[fi - v.Times.begin() - 1] == column.Value;
+			}
+			// merges consecutive identical spans
+			if ( column.Starts.empty() == false
+			     && std::equal(current.begin(),current.end(),
+			                   column.Matches.end() - d_nbAnts) ) {
+				continue;
+			}
+			column.Starts.push_back(boundary);
+			column.Matches.insert(column.Matches.end(),current.begin(),current.end());
+		}
+		column.Current = column.Matches.data();
+	}
+
+	inline bool Present(AntID antID) const {
+		return antID < d_present.size() && d_present[antID];
+	}
+
+	void EvaluatePairs(const CollisionFrame & frame) {
+		if ( d_pairwise.empty() == true ) {
+			return;
+		}
+		const size_t size = frame.Collisions.size();
+		d_pairs.reserve(size);
+		d_dx.resize(size);
+		d_dy.resize(size);
+		d_dAngle.resize(size);
+		d_pairPresent.resize(size);
+		for ( size_t i = 0; i < size; ++i ) {
+			const auto & IDs = frame.Collisions[i].IDs;
+			d_pairs.push_back(IDs);
+			const bool present = Present(IDs.first) && Present(IDs.second);
+			d_pairPresent[i] = present;
+			d_dx[i] = present ? d_x[IDs.first] - d_x[IDs.second] : 0.0;
+			d_dy[i] = present ? d_y[IDs.first] - d_y[IDs.second] : 0.0;
+			d_dAngle[i] = present ? d_angle[IDs.first] - d_angle[IDs.second] : 0.0;
+		}
+
+		d_pairMatches.resize(d_pairwise.size() * size);
+		const double * dx = d_dx.data();
+		const double * dy = d_dy.data();
+		const double * dAngle = d_dAngle.data();
+		const uint8_t * present = d_pairPresent.data();
+		for ( const auto & pc : d_pairwise ) {
+			const auto & ins = d_program[pc];
+			const double value = ins.Value;
+			uint8_t * res = d_pairMatches.data() + ins.Index * size;
+			// predicates are true if any ant is missing, as in Evaluate
+			switch(ins.Op) {
+			case Operation::DISTANCE_SMALLER:
+				for ( size_t i = 0; i < size; ++i ) {
+					res[i] = (present[i] == 0) | (value > dx[i] * dx[i] + dy[i] * dy[i]);
+				}
+				break;
+			case Operation::DISTANCE_GREATER:
+				for ( size_t i = 0; i < size; ++i ) {
+					res[i] = (present[i] == 0) | (value < dx[i] * dx[i] + dy[i] * dy[i]);
+				}
+				break;
+			case Operation::ANGLE_SMALLER:
+				for ( size_t i = 0; i < size; ++i ) {
+					res[i] = (present[i] == 0) | (std::abs(dAngle[i]) < value);
+				}
+				break;
+			case Operation::ANGLE_GREATER:
+				for ( size_t i = 0; i < size; ++i ) {
+					res[i] = (present[i] == 0) | (std::abs(dAngle[i]) > value);
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	// Finds the collision of a pair in the last <CollisionFrame>, as
+	// queries match its collisions in order, it is the one following
+	// the last matched one.
+	size_t FindPair(AntID ant1, AntID ant2) {
+		if ( ant2 == 0 || d_pairs.empty() == true ) {
+			return NO_PAIR;
+		}
+		const InteractionID IDs(ant1,ant2);
+		if ( d_cursor > 0 && d_pairs[d_cursor-1] == IDs ) {
+			return d_cursor - 1;
+		}
+		for ( size_t i = d_cursor; i < d_pairs.size(); ++i ) {
+			if ( d_pairs[i] == IDs ) {
+				d_cursor = i + 1;
+				return i;
+			}
+		}
+		return NO_PAIR;
+	}
+
+	bool Evaluate(size_t pc,
+	              AntID ant1,
+	              AntID ant2,
+	              const InteractionTypes & types,
+	              size_t pair) {
+		const auto & ins = d_program[pc];
+		switch(ins.Op) {
+		case Operation::AND: {
+			size_t child = pc + 1;
+			for ( uint32_t i = 0; i < ins.Arity; ++i ) {
+				if ( Evaluate(child,ant1,ant2,types,pair) == false ) {
+					return false;
+				}
+				child += d_program[child].Size;
+			}
+			return true;
+		}
+		case Operation::OR: {
+			size_t child = pc + 1;
+			for ( uint32_t i = 0; i < ins.Arity; ++i ) {
+				if ( Evaluate(child,ant1,ant2,types,pair) == true ) {
+					return true;
+				}
+				child += d_program[child].Size;
+			}
+			return false;
+		}
+		case Operation::ANT_ID:
+			return ( ant2 != 0 && ant2 == ins.ID ) || ant1 == ins.ID;
+		case Operation::ANT_COLUMN: {
+			const auto & column = d_columns[ins.Index];
+			const bool matches = ( ant2 < d_nbAnts && column.Current[ant2] )
+				|| ( ant1 < d_nbAnts && column.Current[ant1] );
+			if ( matches == true && column.Unknown == true ) {
+				throw std::out_of_range("Unknown column '" + column.Name + "'");
+			}
+			return matches;
+		}
+		case Operation::DISTANCE_SMALLER:
+		case Operation::DISTANCE_GREATER: {
+			if ( pair != NO_PAIR ) {
+				return d_pairMatches[ins.Index * d_pairs.size() + pair];
+			}
+			if ( Present(ant1) == false || Present(ant2) == false ) {
+				return true;
+			}
+			double dx = d_x[ant1] - d_x[ant2];
+			double dy = d_y[ant1] - d_y[ant2];
+			double sDist = dx * dx + dy * dy;
+			return ins.Op == Operation::DISTANCE_GREATER ? ins.Value < sDist : ins.Value > sDist;
+		}
+		case Operation::ANGLE_SMALLER:
+		case Operation::ANGLE_GREATER: {
+			if ( pair != NO_PAIR ) {
+				return d_pairMatches[ins.Index * d_pairs.size() + pair];
+			}
+			if ( Present(ant1) == false || Present(ant2) == false ) {
+				return true;
+			}
+			double angle = std::abs(d_angle[ant1] - d_angle[ant2]);
+			return ins.Op == Operation::ANGLE_GREATER ? angle > ins.Value : angle < ins.Value;
+		}
+		case Operation::TYPE_SINGLE:
+		case Operation::TYPE_DUAL:
+			if ( ant2 == 0 ) {
+				return true;
+			}
+			for ( size_t i = 0; i < types.rows(); ++i ) {
+				if ( ( types(i,0) == ins.Type1 && types(i,1) == ins.Type2 )
+				     || ( types(i,0) == ins.Type2 && types(i,1) == ins.Type1 ) ) {
+					return true;
+				}
+			}
+			return false;
+		case Operation::OTHER:
+			return d_others[ins.Index]->Match(ant1,ant2,types);
+		}
+		return false;
+	}
+
+	Ptr                        d_source;
+	std::vector<Instruction>   d_program;
+	std::vector<Column>        d_columns;
+	std::vector<Ptr>           d_others;
+	bool                       d_needsPositions;
+	size_t                     d_nbAnts;
+	std::vector<double>        d_x,d_y,d_angle;
+	std::vector<uint8_t>       d_present;
+	std::vector<AntID>         d_presents;
+	// program indexes of the distance and angle predicates
+	std::vector<size_t>        d_pairwise;
+	std::vector<InteractionID> d_pairs;
+	size_t                     d_cursor;
+	std::vector<double>        d_dx,d_dy,d_dAngle;
+	std::vector<uint8_t>       d_pairPresent;
+	// d_pairMatches[Index * d_pairs.size() + i] is the result of the
+	// predicate for the collision i
+	std::vector<uint8_t>       d_pairMatches;
+};
+
+static bool DependsOnTypes(const Matcher & matcher) {
+	if ( auto a = dynamic_cast<const AndMatcher*>(&matcher) ) {
+		return std::any_of(a->d_matchers.begin(),a->d_matchers.end(),
+		                   [](const Matcher::Ptr & m) { return DependsOnTypes(*m); });
+	}
+	if ( auto o = dynamic_cast<const OrMatcher*>(&matcher) ) {
+		return std::any_of(o->d_matchers.begin(),o->d_matchers.end(),
+		                   [](const Matcher::Ptr & m) { return DependsOnTypes(*m); });
+	}
+	if ( dynamic_cast<const AntIDEqualMatcher*>(&matcher) != nullptr
+	     || dynamic_cast<const AntColumnEqualMatcher*>(&matcher) != nullptr
+	     || dynamic_cast<const AntDistanceMatcher*>(&matcher) != nullptr
+	     || dynamic_cast<const AntAngleMatcher*>(&matcher) != nullptr ) {
+		return false;
+	}
+	// type matchers, and any other matcher as we cannot know
+	return true;
+}
+
+Matcher::Ptr Matcher::Compile(const Ptr & matcher) {
+	return std::make_shared<CompiledMatcher>(matcher);
+}
+
+Matcher::Ptr Matcher::And(const std::vector<Ptr>  &matchers) {
+	return std::make_shared<AndMatcher>(matchers);
+}
+
+Matcher::Ptr Matcher::Or(const std::vector<Ptr> & matchers) {
+	return std::make_shared<OrMatcher>(matchers);
+}
+
+Matcher::Ptr Matcher::AntIDMatcher(AntID ID) {
+	return std::make_shared<AntIDEqualMatcher>(ID);
+}
+
+Matcher::Ptr Matcher::AntColumnMatcher(const std::string & name, const AntStaticValue & value) {
+	return std::make_shared<AntColumnEqualMatcher>(name,value);
+}
+
 Matcher::Ptr Matcher::AntDistanceSmallerThan(double distance) {
 	return std::make_shared<AntDistanceMatcher>(distance,false);
 }
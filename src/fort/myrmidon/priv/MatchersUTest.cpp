@@ -278,7 +278,220 @@ TEST_F(MatchersUTest,Formatting) {
 	}
 }
 
+TEST_F(MatchersUTest,InteractionTypeFilter) {
+	struct TestData {
+		Matcher::Ptr                 M;
+		bool                         Any;
+		InteractionTypeSet           Expected;
+	};
+
+	std::vector<TestData> testdata
+		= {
+		   {Matcher::AntIDMatcher(1),true,{}},
+		   {Matcher::InteractionType(1,1),false,{{1,1}}},
+		   {Matcher::InteractionType(2,1),false,{{1,2}}},
+		   {
+		    Matcher::And({Matcher::AntIDMatcher(1),
+		                  Matcher::InteractionType(1,1)}),
+		    false,
+		    {{1,1}},
+		   },
+		   {
+		    Matcher::And({Matcher::InteractionType(1,2),
+		                  Matcher::InteractionType(1,1)}),
+		    false,
+		    {{1,1},{1,2}},
+		   },
+		   {
+		    Matcher::And({Matcher::Or({Matcher::InteractionType(1,2),
+		                               Matcher::InteractionType(1,1)}),
+		                  Matcher::InteractionType(1,1)}),
+		    false,
+		    {{1,1},{1,2}},
+		   },
+		   {
+		    Matcher::Or({Matcher::InteractionType(1,2),
+		                 Matcher::InteractionType(1,1)}),
+		    false,
+		    {{1,1},{1,2}},
+		   },
+		   {
+		    Matcher::Or({Matcher::InteractionType(1,2),
+		                 Matcher::AntIDMatcher(1)}),
+		    true,
+		    {},
+		   },
+		   {
+		    Matcher::And({Matcher::InteractionType(1,2),
+		                  Matcher::Or({Matcher::AntIDMatcher(1),
+		                               Matcher::AntIDMatcher(2)})}),
+		    false,
+		    {{1,2}},
+		   },
+		   {
+		    // the Or accepts any type for ant 1, but still needs
+		    // (3,3) for the others
+		    Matcher::And({Matcher::InteractionType(1,2),
+		                  Matcher::Or({Matcher::AntIDMatcher(1),
+		                               Matcher::InteractionType(3,3)})}),
+		    true,
+		    {},
+		   },
+	};
+
+	for ( const auto & d : testdata ) {
+		auto types = d.M->InteractionTypeFilter();
+		std::ostringstream oss;
+		oss << *d.M;
+		if ( d.Any == true ) {
+			EXPECT_FALSE(types) << "for " << oss.str();
+			continue;
+		}
+		if ( !types ) {
+			ADD_FAILURE() << "Missing filter for " << oss.str();
+			continue;
+		}
+		EXPECT_EQ(*types,d.Expected) << "for " << oss.str();
+	}
+}
+
+
+TEST_F(MatchersUTest,CompiledMatcher) {
+	auto experiment = Experiment::Create(TestSetup::Basedir() / "compiled-matcher.myrmidon");
+	experiment->AddAntMetadataColumn("bar",AntMetadata::Type::INT);
+	std::vector<AntID> antIDs;
+	for ( size_t i = 0; i < 4; ++i ) {
+		auto a = experiment->CreateAnt();
+		a->SetValue("bar",int(i % 2),Time::ConstPtr());
+		a->SetValue("bar",int(i),std::make_shared<Time>(Time().Add(i * Duration::Second)));
+		antIDs.push_back(a->AntID());
+	}
+	antIDs.push_back(antIDs.back()+1);
+
+	std::vector<Matcher::Ptr> matchers
+		= {
+		   Matcher::AntIDMatcher(antIDs[1]),
+		   Matcher::AntColumnMatcher("bar",1),
+		   Matcher::And({Matcher::AntDistanceGreaterThan(10),
+		                 Matcher::AntColumnMatcher("bar",1),
+		                 Matcher::AntIDMatcher(antIDs[2])}),
+		   Matcher::Or({Matcher::AntAngleSmallerThan(0.5),
+		                Matcher::And({Matcher::InteractionType(1,2),
+		                              Matcher::AntDistanceSmallerThan(10)}),
+		                Matcher::InteractionType(1,1)}),
+		   Matcher::Or({StaticMatcher::Create(false),
+		                Matcher::And({StaticMatcher::Create(true),
+		                              Matcher::AntColumnMatcher("bar",0)})}),
+	};
 
+	std::vector<InteractionTypes> types(3);
+	types[1].resize(1,2);
+	types[1] << 1,1;
+	types[2].resize(2,2);
+	types[2] << 2,1,2,2;
+
+	for ( const auto & m : matchers ) {
+		auto compiled = Matcher::Compile(m);
+		std::ostringstream expected,formatted;
+		expected << *m;
+		formatted << *compiled;
+		EXPECT_EQ(formatted.str(),expected.str());
+		m->SetUpOnce(experiment->CIdentifier().CAnts());
+		compiled->SetUpOnce(experiment->CIdentifier().CAnts());
+		for ( int t = -1; t < 5; ++t ) {
+			auto identifiedFrame = std::make_shared<IdentifiedFrame>();
+			identifiedFrame->FrameTime = Time().Add(t * Duration::Second);
+			for ( size_t i = 0; i < 3; ++i ) {
+				identifiedFrame->Positions.push_back({{4.0 * i * (t+1),1.0},0.3 * i * t,antIDs[i]});
+			}
+			// odd times give all pairs as collisions, matched in
+			// order, to evaluate distances and angles in batch.
+			std::shared_ptr<CollisionFrame> collisionFrame;
+			if ( t % 2 != 0 ) {
+				collisionFrame = std::make_shared<CollisionFrame>();
+				collisionFrame->FrameTime = identifiedFrame->FrameTime;
+				for ( const auto & a : antIDs ) {
+					for ( const auto & b : antIDs ) {
+						collisionFrame->Collisions.push_back({.IDs = {a,b}});
+					}
+				}
+			}
+			m->SetUp(identifiedFrame,collisionFrame);
+			compiled->SetUp(identifiedFrame,collisionFrame);
+			for ( const auto & a : antIDs ) {
+				EXPECT_EQ(compiled->Match(a,0,{}),m->Match(a,0,{}))
+					<< "for " << expected.str() << " ant: " << a << " t: " << t;
+				for ( const auto & b : antIDs ) {
+					for ( const auto & type : types ) {
+						EXPECT_EQ(compiled->Match(a,b,type),m->Match(a,b,type))
+							<< "for " << expected.str() << " ants: " << a << "," << b << " t: " << t;
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST_F(MatchersUTest,CompiledMatcherUnknownColumn) {
+	auto experiment = Experiment::Create(TestSetup::Basedir() / "compiled-matcher-unknown.myrmidon");
+	auto a = experiment->CreateAnt();
+	auto identifiedFrame = std::make_shared<IdentifiedFrame>();
+
+	auto m = Matcher::AntColumnMatcher("foo",1);
+	auto compiled = Matcher::Compile(m);
+	// as the matcher, the compiled version only fails when matching
+	// a known ant
+	for ( const auto & matcher : {m,compiled} ) {
+		EXPECT_NO_THROW({
+				matcher->SetUpOnce(experiment->CIdentifier().CAnts());
+				matcher->SetUp(identifiedFrame,{});
+			});
+		EXPECT_FALSE(matcher->Match(a->AntID()+1,0,{}));
+		EXPECT_THROW({
+				matcher->Match(a->AntID(),0,{});
+			},std::out_of_range);
+		EXPECT_THROW({
+				matcher->Match(a->AntID()+1,a->AntID(),{});
+			},std::out_of_range);
+	}
+
+	// reordering must not change which conditions are evaluated
+	// before the one that throws.
+	auto b = experiment->CreateAnt();
+	auto outcome = [](const Matcher::Ptr & m, AntID ant) {
+		               try {
+			               return m->Match(ant,0,{}) ? 1 : 0;
+		               } catch ( const std::out_of_range & ) {
+			               return -1;
+		               }
+	               };
+	std::vector<Matcher::Ptr> matchers
+		= {
+		   Matcher::And({Matcher::AntColumnMatcher("foo",1),
+		                 Matcher::AntIDMatcher(a->AntID())}),
+		   Matcher::Or({Matcher::AntColumnMatcher("foo",1),
+		                Matcher::AntIDMatcher(a->AntID())}),
+		   Matcher::And({Matcher::Or({Matcher::AntIDMatcher(b->AntID()),
+		                              Matcher::AntColumnMatcher("foo",1)}),
+		                 Matcher::AntIDMatcher(a->AntID())}),
+		   Matcher::And({Matcher::AntIDMatcher(a->AntID()),
+		                 Matcher::AntColumnMatcher("foo",1),
+		                 Matcher::AntIDMatcher(b->AntID())}),
+	};
+	for ( const auto & m : matchers ) {
+		auto compiled = Matcher::Compile(m);
+		std::ostringstream oss;
+		oss << *m;
+		m->SetUpOnce(experiment->CIdentifier().CAnts());
+		compiled->SetUpOnce(experiment->CIdentifier().CAnts());
+		m->SetUp(identifiedFrame,{});
+		compiled->SetUp(identifiedFrame,{});
+		for ( const auto & ant : {a->AntID(),b->AntID()} ) {
+			EXPECT_EQ(outcome(compiled,ant),outcome(m,ant))
+				<< "for " << oss.str() << " ant: " << ant;
+		}
+	}
+}
 
 } // namespace priv
 } // namespace myrmidon
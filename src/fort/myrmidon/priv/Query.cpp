@@ -1,15 +1,26 @@
 #include "Query.hpp"
 
 #include <thread>
+#include <map>
+#include <tuple>
+#include <cmath>
+#include <numeric>
+#include <limits>
 
 #include <tbb/parallel_for.h>
 #include <tbb/pipeline.h>
+#include <tbb/enumerable_thread_specific.h>
 
 #include "TagStatistics.hpp"
 #include "TrackingDataDirectory.hpp"
 #include "Identifier.hpp"
 #include "RawFrame.hpp"
 #include "CollisionSolver.hpp"
+#include "Ant.hpp"
+#include "DenseMap.hpp"
+#include "KDTree.hpp"
+
+#include <fort/myrmidon/utils/ObjectPool.hpp>
 
 
 namespace fort {
@@ -17,13 +28,172 @@ namespace myrmidon {
 namespace priv {
 
 
-static void EnsureTagStatisticsAreComputed(const SpaceConstPtr & space) {
+// Per-frame objects of the query pipelines. They are given back to
+// these pools once the store functor released them.
+struct FramePools {
+	utils::ObjectPool<IdentifiedFrame> Identified;
+	utils::ObjectPool<CollisionFrame>  Collided;
+};
+
+static IdentifiedFrame::Ptr IdentifyRawFrame(FramePools & pools,
+                                             const RawFrame & raw,
+                                             SpaceID spaceID,
+                                             const IdentifierIF & identifier,
+                                             const CollisionSolver * collider) {
+	auto identified = pools.Identified.Get();
+	raw.IdentifyFrom(*identified,identifier,spaceID);
+	if ( collider ) {
+		auto zoner = collider->ZonerFor(identified);
+		identified->Zones.reserve(identified->Positions.size());
+		for ( const auto & p : identified->Positions ) {
+			identified->Zones.push_back(zoner->LocateAnt(p));
+		}
+	}
+	return identified;
+}
+
+static Query::CollisionData CollideRawFrame(FramePools & pools,
+                                            const RawFrame & raw,
+                                            SpaceID spaceID,
+                                            const IdentifierIF & identifier,
+                                            const CollisionSolver & solver,
+                                            const InteractionTypeSet * types,
+                                            double proximityMargin) {
+	auto identified = IdentifyRawFrame(pools,raw,spaceID,identifier,nullptr);
+	auto collided = pools.Collided.Get();
+	solver.ComputeCollisions(*collided,identified,types,proximityMargin);
+	return std::make_pair(identified,collided);
+}
+
+// Ant positions are indexed in a KDTree. Each ant queries the tree
+// with a square of half side r, and distances to the candidates are
+// computed at once. In k nearest neighbour mode, r starts from the
+// mean distance to the k-th neighbour of uniformly distributed ants,
+// and is doubled until k neighbours are found closer than r, as any
+// ant outside of the square is farther than r.
+AntNeighbours::Ptr Query::FindNeighbours(const IdentifiedFrame & frame,
+                                         size_t k,
+                                         double radius) {
+	typedef KDTree<uint32_t,double,2> KDT;
+	auto res = std::make_shared<AntNeighbours>();
+	res->FrameTime = frame.FrameTime;
+	res->Space = frame.Space;
+
+	const auto & positions = frame.Positions;
+	const size_t n = positions.size();
+	std::vector<uint32_t> byID(n);
+	std::iota(byID.begin(),byID.end(),0);
+	std::sort(byID.begin(),byID.end(),
+	          [&positions](uint32_t a, uint32_t b) {
+		          return positions[a].ID < positions[b].ID;
+	          });
+
+	std::vector<KDT::Element> nodes;
+	nodes.reserve(n);
+	KDT::AABB bounds;
+	for ( uint32_t i = 0; i < n; ++i ) {
+		nodes.push_back({.Object = i, .Volume = KDT::AABB(positions[i].Position,positions[i].Position)});
+		bounds.extend(positions[i].Position);
+	}
+	auto kdt = KDT::Build(nodes.begin(),nodes.end(),-1);
+
+	// r big enough for any square to cover all ants
+	const double coverAll = n > 0 ? std::max(bounds.diagonal().norm(),1.0) : 1.0;
+	double initial = coverAll;
+	if ( k > 0 && n > 1 ) {
+		initial = std::sqrt(bounds.volume() * (k + 1) / (M_PI * n));
+		initial = std::max(initial,1.0e-3 * coverAll);
+	}
+	const double maxRadius = radius > 0.0 ? radius : std::numeric_limits<double>::infinity();
+
+	std::vector<uint32_t> candidates;
+	Eigen::Matrix2Xd candidatePositions;
+	Eigen::VectorXd distances;
+	std::vector<uint32_t> order;
+	std::vector<std::tuple<AntID,AntID,double>> relations;
+
+	for ( uint32_t i : byID ) {
+		const auto & p = positions[i].Position;
+		const AntID antID = positions[i].ID;
+		double r = k > 0 ? std::min(initial,maxRadius) : radius;
+		for (;;) {
+			candidates.clear();
+			Eigen::Vector2d halfSide = Eigen::Vector2d::Constant(r);
+			kdt->ForEachIntersecting(KDT::AABB(p - halfSide,p + halfSide),
+			                         [&](uint32_t j) {
+				                         // in radius mode, pairs are reported once
+				                         if ( j == i || ( k == 0 && positions[j].ID <= antID ) ) {
+					                         return;
+				                         }
+				                         candidates.push_back(j);
+			                         });
+			candidatePositions.resize(2,candidates.size());
+			for ( size_t c = 0; c < candidates.size(); ++c ) {
+				candidatePositions.col(c) = positions[candidates[c]].Position;
+			}
+			distances = (candidatePositions.colwise() - p).colwise().norm().transpose();
+			if ( k == 0 || r >= maxRadius || r >= coverAll
+			     || size_t((distances.array() <= r).count()) >= k ) {
+				break;
+			}
+			r = std::min(2.0 * r,maxRadius);
+		}
+
+		// once the square covers all ants, any candidate is valid
+		// up to the query radius.
+		const double limit = r >= coverAll ? maxRadius : r;
+		order.clear();
+		for ( size_t c = 0; c < candidates.size(); ++c ) {
+			if ( distances(c) <= limit ) {
+				order.push_back(c);
+			}
+		}
+		auto closer = [&](uint32_t a, uint32_t b) {
+			              return std::make_pair(distances(a),positions[candidates[a]].ID)
+				              < std::make_pair(distances(b),positions[candidates[b]].ID);
+		              };
+		auto last = order.end();
+		if ( k > 0 && k < order.size() ) {
+			last = order.begin() + k;
+			std::partial_sort(order.begin(),last,order.end(),closer);
+		} else if ( k > 0 ) {
+			std::sort(order.begin(),order.end(),closer);
+		}
+		for ( auto it = order.begin(); it != last; ++it ) {
+			relations.push_back({antID,positions[candidates[*it]].ID,distances(*it)});
+		}
+	}
+
+	if ( k == 0 ) {
+		std::sort(relations.begin(),relations.end());
+	}
+	res->IDs.resize(relations.size(),2);
+	res->Distances.resize(relations.size());
+	for ( size_t i = 0; i < relations.size(); ++i ) {
+		res->IDs(i,0) = std::get<0>(relations[i]);
+		res->IDs(i,1) = std::get<1>(relations[i]);
+		res->Distances(i) = std::get<2>(relations[i]);
+	}
+	return res;
+}
+
+// Runs in parallel the loaders of the TrackingDataDirectory of a
+// space whose data is not computed yet. If <start> or <end> are set,
+// only the TrackingDataDirectory intersecting [<start>,<end>] are
+// considered.
+static void EnsureDataIsComputed(const SpaceConstPtr & space,
+                                 bool (TrackingDataDirectory::*computed)() const,
+                                 std::vector<TrackingDataDirectory::Loader> (TrackingDataDirectory::*prepareLoaders)(),
+                                 const Time::ConstPtr & start = Time::ConstPtr(),
+                                 const Time::ConstPtr & end = Time::ConstPtr()) {
 	std::vector<TrackingDataDirectory::Loader> loaders;
 	for ( const auto & tdd : space->TrackingDataDirectories() ) {
-		if ( tdd->TagStatisticsComputed() == true ) {
+		if ( ((*tdd).*computed)() == true
+		     || ( !start == false && tdd->EndDate().Before(*start) == true )
+		     || ( !end == false && end->Before(tdd->StartDate()) == true ) ) {
 			continue;
 		}
-		auto localLoaders = tdd->PrepareTagStatisticsLoaders();
+		auto localLoaders = ((*tdd).*prepareLoaders)();
 		loaders.insert(loaders.end(),localLoaders.begin(),localLoaders.end());
 	}
 	tbb::parallel_for(tbb::blocked_range<size_t>(0,loaders.size()),
@@ -41,7 +211,9 @@ void Query::ComputeTagStatistics(const Experiment::ConstPtr & experiment,TagStat
 
 	typedef std::vector<TagStatisticsHelper::Loader> StatisticLoaderList;
 	for ( const auto & [spaceID,space] : experiment->CSpaces() ) {
-		EnsureTagStatisticsAreComputed(space);
+		EnsureDataIsComputed(space,
+		                     &TrackingDataDirectory::TagStatisticsComputed,
+		                     &TrackingDataDirectory::PrepareTagStatisticsLoaders);
 		std::vector<TagStatisticsHelper::Timed> spaceResults;
 		for ( const auto & tdd : space->TrackingDataDirectories() ) {
 			spaceResults.push_back(tdd->TagStatistics());
@@ -135,24 +307,44 @@ Query::RawData Query::DataLoader::operator()() const {
 }
 
 
-inline bool MonoIDMismatch(const Time & a,
-                    const Time & b) {
-	if ( a.HasMono() ) {
-		if ( b.HasMono() ) {
-			return a.MonoID() != b.MonoID();
-		}
-		return true;
-	}
-	return b.HasMono() == false;
+// Reports if a trajectory or an interaction last seen at last
+// cannot be continued at current, as they are not on the same
+// monotonic clock or too far apart. A Time without monotonic value
+// never continues anything.
+inline bool MustTerminate(const PackedTime & current,
+                          const PackedTime & last,
+                          int64_t maxGap) {
+	return current.Clock == PackedTime::NO_CLOCK
+		|| current.SameClock(last) == false
+		|| current.Sub(last) > maxGap;
 }
 
 Query::BuildingTrajectory::BuildingTrajectory(const IdentifiedFrame::ConstPtr & frame,
+                                              const PackedTime & time,
                                               const PositionedAnt & ant,
-                                              const ZoneID * zone)
+                                              const ZoneID * zone,
+                                              const Resampling & sampling,
+                                              const Simplification & simplification,
+                                              const KinematicsOptions & kinematics)
 	: Trajectory(std::make_shared<AntTrajectory>())
-	, Last(frame->FrameTime)
+	, Start(time)
+	, Last(time)
 	, DataPoints({ant.Position.x(),ant.Position.y(),ant.Angle})
-	, Durations({0.0}) {
+	, Durations({0.0})
+	, Sampling(sampling)
+	, LastPose(ant.Position.x(),ant.Position.y(),ant.Angle)
+	, LastZone(zone != nullptr ? *zone : 0)
+	, NextSample(sampling.Period)
+	, Simplifying(simplification)
+	, AnchorTime(0)
+	, AnchorPose(ant.Position.x(),ant.Position.y(),ant.Angle)
+	, MinVelocity(Eigen::Vector3d::Constant(-std::numeric_limits<double>::infinity()))
+	, MaxVelocity(Eigen::Vector3d::Constant(std::numeric_limits<double>::infinity()))
+	, HasPending(false)
+	, MaximumError(0.0)
+	, MaximumAngularError(0.0)
+	, Detections(1)
+	, Kinematics(kinematics) {
 	Trajectory->Ant = ant.ID;
 	Trajectory->Start = frame->FrameTime;
 	Trajectory->Space = frame->Space;
@@ -165,11 +357,20 @@ Query::BuildingTrajectory::BuildingTrajectory(const IdentifiedFrame::ConstPtr &
 }
 
 
-void Query::BuildingTrajectory::Append(const IdentifiedFrame::ConstPtr & frame,
+void Query::BuildingTrajectory::Append(const PackedTime & time,
                                        const PositionedAnt & ant,
                                        const ZoneID * zone) {
-	Last = frame->FrameTime;
-	Durations.push_back(frame->FrameTime.Sub(Trajectory->Start).Seconds());
+	++Detections;
+	if ( Sampling.Period > 0 ) {
+		Resample(time,ant,zone);
+		return;
+	}
+	if ( Simplifying.Tolerance > 0.0 ) {
+		Simplify(time,ant,zone);
+		return;
+	}
+	Last = time;
+	Durations.push_back(time.Sub(Start) * 1.0e-9);
 	DataPoints.insert(DataPoints.end(),
 	                  {ant.Position.x(),ant.Position.y(),ant.Angle});
 	if ( zone != nullptr ) {
@@ -177,23 +378,169 @@ void Query::BuildingTrajectory::Append(const IdentifiedFrame::ConstPtr & frame,
 	}
 }
 
+void Query::BuildingTrajectory::Resample(const PackedTime & time,
+                                         const PositionedAnt & ant,
+                                         const ZoneID * zone) {
+	const int64_t current = time.Sub(Start);
+	const int64_t previous = Last.Sub(Start);
+	const int64_t gap = current - previous;
+	const Eigen::Vector3d pose(ant.Position.x(),ant.Position.y(),ant.Angle);
+	if ( Sampling.MaximumGap > 0 && gap > Sampling.MaximumGap ) {
+		// leaves the gap unfilled, samples are re-aligned on the
+		// period grid, resuming at its first point at or after this
+		// frame.
+		NextSample += ((current - NextSample + Sampling.Period - 1) / Sampling.Period) * Sampling.Period;
+	}
+	for ( ; NextSample <= current; NextSample += Sampling.Period ) {
+		const double alpha = gap > 0 ? double(NextSample - previous) / double(gap) : 1.0;
+		Durations.push_back(NextSample * 1.0e-9);
+		// angles are interpolated on the shortest arc
+		const double angle = LastPose.z() + alpha * std::remainder(pose.z() - LastPose.z(),2.0 * M_PI);
+		DataPoints.insert(DataPoints.end(),
+		                  {LastPose.x() + alpha * (pose.x() - LastPose.x()),
+		                   LastPose.y() + alpha * (pose.y() - LastPose.y()),
+		                   std::remainder(angle,2.0 * M_PI)});
+		if ( zone != nullptr ) {
+			Zones.push_back(NextSample == current ? *zone : LastZone);
+		}
+	}
+	Last = time;
+	LastPose = pose;
+	LastZone = zone != nullptr ? *zone : 0;
+}
+
+// Maximal number of detections dropped in a row by the
+// simplification, which bounds the memory used per ant.
+static const size_t SIMPLIFICATION_WINDOW = 1024;
+
+void Query::BuildingTrajectory::Simplify(const PackedTime & time,
+                                         const PositionedAnt & ant,
+                                         const ZoneID * zone) {
+	Last = time;
+	const double previousAngle = HasPending ? Pending.Pose.z() : AnchorPose.z();
+	const WindowPoint current = {.Time = time.Sub(Start),
+	                             .Pose = Eigen::Vector3d(ant.Position.x(),
+	                                                     ant.Position.y(),
+	                                                     previousAngle + std::remainder(ant.Angle - previousAngle,2.0 * M_PI))};
+	const ZoneID currentZone = zone != nullptr ? *zone : 0;
+	if ( HasPending == false ) {
+		HasPending = true;
+		Pending = current;
+		PendingZone = currentZone;
+		return;
+	}
+
+	// Pending can be dropped if the segment from the anchor to
+	// current passes close enough to it and to all dropped
+	// detections. Each one bounds the segment velocity per
+	// component, which guarantees the error in constant memory.
+	const double pendingDt = Pending.Time - AnchorTime;
+	const double currentDt = current.Time - AnchorTime;
+	const double angularTolerance = Simplifying.AngularTolerance > 0.0
+		? Simplifying.AngularTolerance
+		: std::numeric_limits<double>::infinity();
+	const Eigen::Vector3d tolerance(Simplifying.Tolerance / std::sqrt(2.0),
+	                                Simplifying.Tolerance / std::sqrt(2.0),
+	                                angularTolerance);
+	Eigen::Vector3d minVelocity = MinVelocity.cwiseMax((Pending.Pose - AnchorPose - tolerance) / pendingDt);
+	Eigen::Vector3d maxVelocity = MaxVelocity.cwiseMin((Pending.Pose - AnchorPose + tolerance) / pendingDt);
+	const Eigen::Vector3d velocity = (current.Pose - AnchorPose) / currentDt;
+
+	if ( pendingDt > 0.0
+	     && currentZone == PendingZone
+	     && Window.size() < SIMPLIFICATION_WINDOW
+	     && (velocity.array() >= minVelocity.array()).all()
+	     && (velocity.array() <= maxVelocity.array()).all() ) {
+		Window.push_back(Pending);
+		MinVelocity = minVelocity;
+		MaxVelocity = maxVelocity;
+	} else {
+		KeepPending();
+	}
+	Pending = current;
+	PendingZone = currentZone;
+}
+
+void Query::BuildingTrajectory::KeepPending() {
+	auto [error,angularError] = WindowErrors();
+	MaximumError = std::max(MaximumError,error);
+	MaximumAngularError = std::max(MaximumAngularError,angularError);
+
+	Durations.push_back(Pending.Time * 1.0e-9);
+	DataPoints.insert(DataPoints.end(),
+	                  {Pending.Pose.x(),Pending.Pose.y(),std::remainder(Pending.Pose.z(),2.0 * M_PI)});
+	if ( Zones.empty() == false ) {
+		Zones.push_back(PendingZone);
+	}
+	AnchorTime = Pending.Time;
+	AnchorPose = Pending.Pose;
+	MinVelocity.setConstant(-std::numeric_limits<double>::infinity());
+	MaxVelocity.setConstant(std::numeric_limits<double>::infinity());
+	Window.clear();
+}
+
+void Query::BuildingTrajectory::Flush() {
+	if ( HasPending == false ) {
+		return;
+	}
+	KeepPending();
+	HasPending = false;
+}
+
+std::pair<double,double> Query::BuildingTrajectory::WindowErrors() const {
+	double error(0.0),angularError(0.0);
+	for ( const auto & p : Window ) {
+		const double alpha = double(p.Time - AnchorTime) / double(Pending.Time - AnchorTime);
+		const Eigen::Vector3d diff = AnchorPose + alpha * (Pending.Pose - AnchorPose) - p.Pose;
+		error = std::max(error,diff.head<2>().norm());
+		angularError = std::max(angularError,std::abs(diff.z()));
+	}
+	return {error,angularError};
+}
+
+size_t Query::BuildingTrajectory::Size() const {
+	return Durations.size() + ( HasPending ? 1 : 0 );
+}
+
 AntTrajectory::ConstPtr Query::BuildingTrajectory::Terminate() const {
-	if ( Durations.size() < 2 ) {
+	size_t nPoints = Size();
+	if ( nPoints < 2 ) {
 		return AntTrajectory::ConstPtr();
 	}
-	size_t nPoints = Durations.size();
+	size_t nKept = Durations.size();
 	Trajectory->Positions.resize(nPoints,4);
-	Trajectory->Positions.block(0,1,nPoints,3) = Eigen::Map<const Eigen::Matrix<double,Eigen::Dynamic,3,Eigen::RowMajor>>(&DataPoints[0],nPoints,3);
-	Trajectory->Positions.block(0,0,nPoints,1) = Eigen::Map<const Eigen::VectorXd>(&Durations[0],nPoints);
+	Trajectory->Positions.block(0,1,nKept,3) = Eigen::Map<const Eigen::Matrix<double,Eigen::Dynamic,3,Eigen::RowMajor>>(&DataPoints[0],nKept,3);
+	Trajectory->Positions.block(0,0,nKept,1) = Eigen::Map<const Eigen::VectorXd>(&Durations[0],nKept);
 	Trajectory->Zones = Zones;
+	Trajectory->Detections = Detections;
+	Trajectory->MaximumError = MaximumError;
+	Trajectory->MaximumAngularError = MaximumAngularError;
+	if ( HasPending == true ) {
+		Trajectory->Positions.row(nKept) << Pending.Time * 1.0e-9,
+			Pending.Pose.x(),
+			Pending.Pose.y(),
+			std::remainder(Pending.Pose.z(),2.0 * M_PI);
+		if ( Zones.empty() == false ) {
+			Trajectory->Zones.push_back(PendingZone);
+		}
+		auto [error,angularError] = WindowErrors();
+		Trajectory->MaximumError = std::max(MaximumError,error);
+		Trajectory->MaximumAngularError = std::max(MaximumAngularError,angularError);
+	}
+	if ( Kinematics.Compute == true ) {
+		Trajectory->ComputeKinematics(Kinematics.SmoothingWindow);
+	}
 	return Trajectory;
 }
 
 Query::BuildingInteraction::BuildingInteraction(const Collision & collision,
-                                                const Time & curTime)
+                                                const Time & curTime,
+                                                const PackedTime & packedTime)
 	: IDs(collision.IDs)
 	, Start(curTime)
-	, Last(curTime) {
+	, Last(curTime)
+	, PackedStart(packedTime)
+	, PackedLast(packedTime) {
 	for ( size_t i = 0; i < collision.Types.rows(); ++i ) {
 		Types.insert(std::make_pair(collision.Types(i,0),
 		                            collision.Types(i,1)));
@@ -201,19 +548,23 @@ Query::BuildingInteraction::BuildingInteraction(const Collision & collision,
 }
 
 void Query::BuildingInteraction::Append(const Collision & collision,
-                                        const Time & curTime) {
+                                        const Time & curTime,
+                                        const PackedTime & packedTime) {
 	Last = curTime;
+	PackedLast = packedTime;
 	for ( size_t i = 0; i < collision.Types.rows(); ++i ) {
 		Types.insert(std::make_pair(collision.Types(i,0),
 		                            collision.Types(i,1)));
 	}
 }
 
-AntInteraction::ConstPtr Query::BuildingInteraction::Terminate(const BuildingTrajectory & a,
-                                                               const BuildingTrajectory & b ) const {
-	if (Start == Last ) {
+AntInteraction::ConstPtr Query::BuildingInteraction::Terminate(BuildingTrajectory & a,
+                                                               BuildingTrajectory & b ) const {
+	if ( PackedStart.SameClock(PackedLast) && PackedStart.Sub(PackedLast) == 0 ) {
 		return AntInteraction::ConstPtr();
 	}
+	a.Flush();
+	b.Flush();
 	auto res = std::make_shared<AntInteraction>();
 	res->IDs = IDs;
 	res->Space = a.Trajectory->Space;
@@ -226,7 +577,9 @@ AntInteraction::ConstPtr Query::BuildingInteraction::Terminate(const BuildingTra
 	}
 	auto findTrajectorySubSegment
 		= [this](const BuildingTrajectory & t) {
-			  double startTime = Start.Sub(t.Trajectory->Start).Seconds();
+			  double startTime = PackedStart.SameClock(t.Start)
+				  ? PackedStart.Sub(t.Start) * 1.0e-9
+				  : Start.Sub(t.Trajectory->Start).Seconds();
 			  auto startIter = t.Durations.cbegin();
 			  for ( ; startIter != t.Durations.cend(); ++startIter ) {
 				  if ( *startIter >= startTime ) {
@@ -252,14 +605,21 @@ std::function<void(const IdentifiedFrame::ConstPtr &)>
 Query::BuildTrajectories(std::function<void(const AntTrajectory::ConstPtr &)> storeResult,
                          BuildingTrajectoryData & building,
                          Duration maxGap,
-                         const Matcher::Ptr & matcher) {
+                         const Matcher::Ptr & matcher,
+                         const Resampling & sampling,
+                         const Simplification & simplification,
+                         const KinematicsOptions & kinematics) {
 	return [storeResult,
 	        &building,
 	        &matcher,
-	        maxGap]( const IdentifiedFrame::ConstPtr & data ) {
+	        sampling,
+	        simplification,
+	        kinematics,
+	        maxGap = maxGap.Nanoseconds()]( const IdentifiedFrame::ConstPtr & data ) {
 		       if ( matcher ) {
 			       matcher->SetUp(data,CollisionFrame::ConstPtr());
 		       }
+		       const auto curTime = PackedTime::From(data->FrameTime);
 		       size_t i = 0;
 		       for ( const auto & pa : data->Positions ) {
 			       const ZoneID * zone = nullptr;
@@ -268,15 +628,13 @@ Query::BuildTrajectories(std::function<void(const AntTrajectory::ConstPtr &)> st
 			       }
 			       ++i;
 
-			       auto & curTime = data->FrameTime;
 			       if ( matcher && matcher->Match(pa.ID,0,{}) == false ) {
 				       continue;
 			       }
 
 			       auto fi = building.find(pa.ID);
 			       if ( fi != building.end() ) {
-				       if ( MonoIDMismatch(curTime,fi->second.Last) == true
-				            || curTime.Sub(fi->second.Last) > maxGap
+				       if ( MustTerminate(curTime,fi->second.Last,maxGap)
 				            || data->Space != fi->second.Trajectory->Space) {
 					       auto res = fi->second.Terminate();
 					       if ( res ) {
@@ -285,12 +643,12 @@ Query::BuildTrajectories(std::function<void(const AntTrajectory::ConstPtr &)> st
 					       building.erase(fi);
 					       fi = building.end();
 				       } else {
-					       fi->second.Append(data,pa,zone);
+					       fi->second.Append(curTime,pa,zone);
 				       }
 			       }
 
 			       if ( fi == building.end() ) {
-				       building.insert(std::make_pair(pa.ID,BuildingTrajectory(data,pa,zone)));;
+				       building.insert(std::make_pair(pa.ID,BuildingTrajectory(data,curTime,pa,zone,sampling,simplification,kinematics)));;
 			       }
 		       }
 	       };
@@ -306,13 +664,17 @@ Query::BuildInteractions(std::function<void(const AntTrajectory::ConstPtr&)> sto
                          BuildingTrajectoryData & currentTrajectories,
                          BuildingInteractionData & currentInteractions,
                          Duration maxGap,
-                         const Matcher::Ptr & matcher) {
+                         const Matcher::Ptr & matcher,
+                         const Simplification & simplification,
+                         const KinematicsOptions & kinematics) {
 	return [storeTrajectory,
 	        storeInteraction,
 	        &currentTrajectories,
 	        &currentInteractions,
 	        &matcher,
-	        maxGap]( const CollisionData & data ) {
+	        simplification,
+	        kinematics,
+	        maxGap = maxGap.Nanoseconds()]( const CollisionData & data ) {
 		       if ( matcher ) {
 			       matcher->SetUp(std::get<0>(data),std::get<1>(data));
 		       }
@@ -320,6 +682,7 @@ Query::BuildInteractions(std::function<void(const AntTrajectory::ConstPtr&)> sto
 		       std::vector<std::pair<PositionedAnt,const ZoneID*>> toTerminate;
 
 		       auto & curTime = std::get<0>(data)->FrameTime;
+		       const auto curPacked = PackedTime::From(curTime);
 
 		       size_t i = 0;
 		       for (  const auto & pa : std::get<0>(data)->Positions ) {
@@ -335,8 +698,7 @@ Query::BuildInteractions(std::function<void(const AntTrajectory::ConstPtr&)> sto
 
 			       auto fi = currentTrajectories.find(pa.ID);
 			       if ( fi != currentTrajectories.end() ) {
-				       if ( MonoIDMismatch(curTime,fi->second.Last)
-				            || curTime.Sub(fi->second.Last) > maxGap
+				       if ( MustTerminate(curPacked,fi->second.Last,maxGap)
 				            || std::get<0>(data)->Space != fi->second.Trajectory->Space) {
 					       std::vector<InteractionID> toRemove;
 					       for ( const auto & [IDs,interaction] : currentInteractions ) {
@@ -358,10 +720,10 @@ Query::BuildInteractions(std::function<void(const AntTrajectory::ConstPtr&)> sto
 						       currentInteractions.erase(IDs);
 					       }
 				       } else {
-					       fi->second.Append(std::get<0>(data),pa,zone);
+					       fi->second.Append(curPacked,pa,zone);
 				       }
 			       } else {
-				       currentTrajectories.insert(std::make_pair(pa.ID,BuildingTrajectory(std::get<0>(data),pa,zone)));;
+				       currentTrajectories.insert(std::make_pair(pa.ID,BuildingTrajectory(std::get<0>(data),curPacked,pa,zone,{0,0},simplification,kinematics)));;
 			       }
 		       }
 
@@ -371,7 +733,7 @@ Query::BuildInteractions(std::function<void(const AntTrajectory::ConstPtr&)> sto
 			       if ( toStore ) {
 				       storeTrajectory(toStore);
 			       }
-			       curTraj = BuildingTrajectory(std::get<0>(data),pa,zone);
+			       curTraj = BuildingTrajectory(std::get<0>(data),curPacked,pa,zone,{0,0},simplification,kinematics);
 		       }
 
 
@@ -385,8 +747,7 @@ Query::BuildInteractions(std::function<void(const AntTrajectory::ConstPtr&)> sto
 			       auto fi = currentInteractions.find(pInter.IDs);
 			       static size_t here(0);
 			       if ( fi != currentInteractions.end() ) {
-				       if ( MonoIDMismatch(curTime,fi->second.Last) == true
-				            || curTime.Sub(fi->second.Last) > maxGap ) {
+				       if ( MustTerminate(curPacked,fi->second.PackedLast,maxGap) ) {
 					       try {
 						       auto toStore = fi->second.Terminate(currentTrajectories.at(pInter.IDs.first),
 						                                           currentTrajectories.at(pInter.IDs.second));
@@ -398,12 +759,12 @@ Query::BuildInteractions(std::function<void(const AntTrajectory::ConstPtr&)> sto
 					       currentInteractions.erase(fi);
 					       fi = currentInteractions.end();
 				       } else {
-					       fi->second.Append(pInter,curTime);
+					       fi->second.Append(pInter,curTime,curPacked);
 				       }
 			       }
 
 			       if ( fi == currentInteractions.end() ) {
-				       currentInteractions.insert(std::make_pair(pInter.IDs,BuildingInteraction(pInter,curTime)));
+				       currentInteractions.insert(std::make_pair(pInter.IDs,BuildingInteraction(pInter,curTime,curPacked)));
 			       }
 
 		       }
@@ -428,6 +789,7 @@ void Query::IdentifyFrames(const Experiment::ConstPtr & experiment,
 	if ( ranges.empty() ) {
 		return;
 	}
+	auto pools = std::make_shared<FramePools>();
 
 	if (singleThread == true ) {
 		DataLoader loader(ranges);
@@ -436,14 +798,8 @@ void Query::IdentifyFrames(const Experiment::ConstPtr & experiment,
 			if ( std::get<0>(raw) == 0 ) {
 				break;
 			}
-			auto identified = std::get<1>(raw)->IdentifyFrom(*identifier,std::get<0>(raw));
-			if ( collider ) {
-				auto zoner = collider->ZonerFor(identified);
-				identified->Zones.reserve(identified->Positions.size());
-				for ( const auto & p : identified->Positions ) {
-					identified->Zones.push_back(zoner->LocateAnt(p));
-				}
-			}
+			auto identified = IdentifyRawFrame(*pools,*std::get<1>(raw),std::get<0>(raw),
+			                                   *identifier,collider.get());
 			storeDataFunctor(identified);
 		}
 		return;
@@ -454,16 +810,9 @@ void Query::IdentifyFrames(const Experiment::ConstPtr & experiment,
 
 	tbb::filter_t<RawData,IdentifiedFrame::ConstPtr>
 		computeData(tbb::filter::parallel,
-		            [identifier,collider](const RawData & rawData ) -> IdentifiedFrame::ConstPtr {
-			            auto identified = std::get<1>(rawData)->IdentifyFrom(*identifier,std::get<0>(rawData));
-			            if ( collider ) {
-				            auto zoner = collider->ZonerFor(identified);
-				            identified->Zones.reserve(identified->Positions.size());
-				            for ( const auto & p : identified->Positions ) {
-					            identified->Zones.push_back(zoner->LocateAnt(p));
-				            }
-			            }
-			            return identified;
+		            [pools,identifier,collider](const RawData & rawData ) -> IdentifiedFrame::ConstPtr {
+			            return IdentifyRawFrame(*pools,*std::get<1>(rawData),std::get<0>(rawData),
+			                                    *identifier,collider.get());
 		            });
 
 
@@ -474,11 +823,169 @@ void Query::IdentifyFrames(const Experiment::ConstPtr & experiment,
 	tbb::parallel_pipeline(std::thread::hardware_concurrency()*2,loadData & computeData & storeData);
 }
 
+void Query::BuildRegionRange(const Experiment::ConstPtr & experiment,
+                             const Time::ConstPtr & start,
+                             const Time::ConstPtr & end,
+                             const AABB & tagRegion,
+                             const std::vector<TagID> & tagIDs,
+                             DataRangeBySpaceID & ranges) {
+	for ( const auto & [spaceID,space] : experiment->CSpaces() ) {
+		// the index is only built for the TrackingDataDirectory
+		// within the range, the others are skipped below.
+		EnsureDataIsComputed(space,
+		                     &TrackingDataDirectory::SpatialIndexComputed,
+		                     &TrackingDataDirectory::PrepareSpatialIndexLoaders,
+		                     start,
+		                     end);
+		for ( const auto & tdd : space->TrackingDataDirectories() ) {
+			// [first,last[ frames of the tdd within [start,end]
+			FrameID first(tdd->StartFrame()),last(tdd->EndFrame()+1);
+			if ( !start == false ) {
+				if ( tdd->EndDate().Before(*start) == true ) {
+					continue;
+				}
+				if ( start->After(tdd->StartDate()) == true ) {
+					auto iter = tdd->FrameAfter(*start);
+					if ( iter == tdd->end() ) {
+						continue;
+					}
+					first = (*iter)->Frame().FrameID();
+				}
+			}
+			if ( !end == false ) {
+				if ( end->Before(tdd->StartDate()) == true ) {
+					continue;
+				}
+				auto iter = tdd->FrameAfter(*end);
+				if ( iter != tdd->end() ) {
+					last = (*iter)->Frame().FrameID();
+				}
+			}
+
+			const auto & segments = tdd->SpatialIndex();
+			std::vector<std::pair<FrameID,FrameID>> selected;
+			for ( size_t i = 0; i < segments.size(); ++i ) {
+				FrameID segmentStart = std::max(segments[i].Start,first);
+				FrameID segmentEnd = i + 1 < segments.size()
+					? std::min(segments[i+1].Start,last)
+					: last;
+				if ( segmentStart >= segmentEnd
+				     || TagSpatialIndex::MayContain(segments[i],tagRegion,tagIDs) == false ) {
+					continue;
+				}
+				if ( selected.empty() == false && selected.back().second == segmentStart ) {
+					selected.back().second = segmentEnd;
+				} else {
+					selected.push_back(std::make_pair(segmentStart,segmentEnd));
+				}
+			}
+
+			for ( const auto & [a,b] : selected ) {
+				ranges[spaceID].push_back(std::make_pair(tdd->FrameAt(a),
+				                                         b > tdd->EndFrame() ? tdd->end() : tdd->FrameAt(b)));
+			}
+		}
+	}
+}
+
+void Query::IdentifyFramesInRegion(const Experiment::ConstPtr & experiment,
+                                   std::function<void (const IdentifiedFrame::ConstPtr &)> storeDataFunctor,
+                                   const Time::ConstPtr & start,
+                                   const Time::ConstPtr & end,
+                                   const AABB & region,
+                                   bool computeZones,
+                                   bool singleThread) {
+	if ( region.isEmpty() == true ) {
+		return;
+	}
+	// an ant is at most at the norm of its tag offset from its tag,
+	// so we only look for tags in the region extended by the
+	// largest offset.
+	std::vector<TagID> tagIDs;
+	double maxOffset = 0.0;
+	for ( const auto & [antID,ant] : experiment->CIdentifier().CAnts() ) {
+		for ( const auto & identification : ant->CIdentifications() ) {
+			tagIDs.push_back(identification->TagValue());
+			maxOffset = std::max(maxOffset,
+			                     identification->AntToTagTransform().translation().norm());
+		}
+	}
+	std::sort(tagIDs.begin(),tagIDs.end());
+	tagIDs.erase(std::unique(tagIDs.begin(),tagIDs.end()),tagIDs.end());
+	auto tagRegion = std::make_shared<AABB>(region.min() - Eigen::Vector2d::Constant(maxOffset),
+	                                        region.max() + Eigen::Vector2d::Constant(maxOffset));
+
+	DataRangeBySpaceID ranges;
+	BuildRegionRange(experiment,start,end,*tagRegion,tagIDs,ranges);
+	if ( ranges.empty() ) {
+		return;
+	}
+
+	auto identifier = experiment->CIdentifier().Compile();
+	CollisionSolver::ConstPtr collider;
+	if ( computeZones == true ) {
+		collider = experiment->CompileCollisionSolver();
+	}
+	auto pools = std::make_shared<FramePools>();
+
+	auto identify = [pools,identifier,collider,region,tagRegion](const RawData & rawData) -> IdentifiedFrame::ConstPtr {
+		                auto identified = pools->Identified.Get();
+		                std::get<1>(rawData)->IdentifyFrom(*identified,*identifier,std::get<0>(rawData),tagRegion.get());
+		                auto & positions = identified->Positions;
+		                positions.erase(std::remove_if(positions.begin(),positions.end(),
+		                                               [&region](const PositionedAnt & p) {
+			                                               return region.contains(p.Position) == false;
+		                                               }),
+		                                positions.end());
+		                if ( positions.empty() ) {
+			                return IdentifiedFrame::ConstPtr();
+		                }
+		                if ( collider ) {
+			                auto zoner = collider->ZonerFor(identified);
+			                identified->Zones.reserve(positions.size());
+			                for ( const auto & p : positions ) {
+				                identified->Zones.push_back(zoner->LocateAnt(p));
+			                }
+		                }
+		                return identified;
+	                };
+
+	auto storeData = [storeDataFunctor](const IdentifiedFrame::ConstPtr & identified) {
+		                 if ( identified ) {
+			                 storeDataFunctor(identified);
+		                 }
+	                 };
+
+	if (singleThread == true ) {
+		DataLoader loader(ranges);
+		for(;;) {
+			auto raw = loader();
+			if ( std::get<0>(raw) == 0 ) {
+				break;
+			}
+			storeData(identify(raw));
+		}
+		return;
+	}
+
+	tbb::filter_t<void,RawData>
+		loadData(tbb::filter::serial_in_order,DataLoader(ranges));
+
+	tbb::filter_t<RawData,IdentifiedFrame::ConstPtr>
+		computeData(tbb::filter::parallel,identify);
+
+	tbb::filter_t<IdentifiedFrame::ConstPtr,void>
+		store(tbb::filter::serial_in_order,storeData);
+
+	tbb::parallel_pipeline(std::thread::hardware_concurrency()*2,loadData & computeData & store);
+}
+
 void Query::CollideFrames(const Experiment::ConstPtr & experiment,
                           std::function<void (const CollisionData &)> storeDataFunctor,
                           const Time::ConstPtr & start,
                           const Time::ConstPtr & end,
-                          bool singleThreaded) {
+                          bool singleThreaded,
+                          double proximityMargin) {
 	auto identifier = experiment->CIdentifier().Compile();
 	auto solver = experiment->CompileCollisionSolver();
 	DataRangeBySpaceID ranges;
@@ -486,6 +993,7 @@ void Query::CollideFrames(const Experiment::ConstPtr & experiment,
 	if ( ranges.empty() ) {
 		return;
 	}
+	auto pools = std::make_shared<FramePools>();
 
 	if ( singleThreaded == true ) {
 		DataLoader loader(ranges);
@@ -494,9 +1002,8 @@ void Query::CollideFrames(const Experiment::ConstPtr & experiment,
 			if ( std::get<0>(raw) == 0 ) {
 				break;
 			}
-			auto identified = std::get<1>(raw)->IdentifyFrom(*identifier,std::get<0>(raw));
-			auto collided = solver->ComputeCollisions(identified);
-			storeDataFunctor({identified,collided});
+			storeDataFunctor(CollideRawFrame(*pools,*std::get<1>(raw),std::get<0>(raw),
+			                                 *identifier,*solver,nullptr,proximityMargin));
 		}
 		return;
 	}
@@ -507,10 +1014,9 @@ void Query::CollideFrames(const Experiment::ConstPtr & experiment,
 	tbb::filter_t<RawData,
 	              CollisionData>
 		computeData(tbb::filter::parallel,
-		            [identifier,solver](const RawData & rawData ) -> CollisionData {
-			            auto identified = std::get<1>(rawData)->IdentifyFrom(*identifier,std::get<0>(rawData));
-			            auto interacted = solver->ComputeCollisions(identified);
-			            return std::make_pair(identified,interacted);
+		            [pools,identifier,solver,proximityMargin](const RawData & rawData ) -> CollisionData {
+			            return CollideRawFrame(*pools,*std::get<1>(rawData),std::get<0>(rawData),
+			                                   *identifier,*solver,nullptr,proximityMargin);
 		            });
 
 
@@ -529,26 +1035,44 @@ void Query::ComputeTrajectories(const Experiment::ConstPtr & experiment,
                                 Duration maximumGap,
                                 const Matcher::Ptr & matcher,
                                 bool computeZones,
-                                bool singleThreaded) {
+                                bool singleThreaded,
+                                Duration samplingPeriod,
+                                Duration maximumInterpolationGap,
+                                double simplificationTolerance,
+                                double angularTolerance,
+                                bool computeKinematics,
+                                Duration smoothingWindow) {
+	if ( samplingPeriod > 0 && simplificationTolerance > 0.0 ) {
+		throw std::invalid_argument("Trajectories cannot be both resampled and simplified");
+	}
 	auto identifier = experiment->CIdentifier().Compile();
 	CollisionSolver::ConstPtr collider;
 	if ( computeZones == true ) {
 		collider = experiment->CompileCollisionSolver();
 	}
+	Matcher::Ptr compiledMatcher;
 	if ( matcher ) {
-		matcher->SetUpOnce(experiment->CIdentifier().CAnts());
+		compiledMatcher = Matcher::Compile(matcher);
+		compiledMatcher->SetUpOnce(experiment->CIdentifier().CAnts());
 	}
 	DataRangeBySpaceID ranges;
 	BuildRange(experiment,start,end,ranges);
 	if ( ranges.empty() ) {
 		return;
 	}
+	auto pools = std::make_shared<FramePools>();
 	BuildingTrajectoryData currentTrajectories;
 	auto computeTrajectoriesFunction =
 		BuildTrajectories(storeDataFunctor,
 		                  currentTrajectories,
 		                  maximumGap,
-		                  matcher);
+		                  compiledMatcher,
+		                  {.Period = samplingPeriod.Nanoseconds(),
+		                   .MaximumGap = maximumInterpolationGap.Nanoseconds()},
+		                  {.Tolerance = simplificationTolerance,
+		                   .AngularTolerance = angularTolerance},
+		                  {.Compute = computeKinematics,
+		                   .SmoothingWindow = smoothingWindow});
 	if ( singleThreaded == true ) {
 		DataLoader loader(ranges);
 		for (;;) {
@@ -556,14 +1080,8 @@ void Query::ComputeTrajectories(const Experiment::ConstPtr & experiment,
 			if ( std::get<0>(raw) == 0 ) {
 				break;
 			}
-			auto identified = std::get<1>(raw)->IdentifyFrom(*identifier,std::get<0>(raw));
-			if ( collider ) {
-				auto zoner = collider->ZonerFor(identified);
-				identified->Zones.reserve(identified->Positions.size());
-				for ( const auto & p : identified->Positions ) {
-					identified->Zones.push_back(zoner->LocateAnt(p));
-				}
-			}
+			auto identified = IdentifyRawFrame(*pools,*std::get<1>(raw),std::get<0>(raw),
+			                                   *identifier,collider.get());
 			computeTrajectoriesFunction(identified);
 		}
 	} else {
@@ -573,16 +1091,9 @@ void Query::ComputeTrajectories(const Experiment::ConstPtr & experiment,
 		std::string currentTddURI;
 		tbb::filter_t<RawData,IdentifiedFrame::ConstPtr>
 			computeData(tbb::filter::parallel,
-			            [identifier,collider](const RawData & rawData ) -> IdentifiedFrame::ConstPtr {
-				            auto identified = std::get<1>(rawData)->IdentifyFrom(*identifier,std::get<0>(rawData));
-				            if ( collider ) {
-					            auto zoner = collider->ZonerFor(identified);
-					            identified->Zones.reserve(identified->Positions.size());
-					            for ( const auto & p : identified->Positions ) {
-						            identified->Zones.push_back(zoner->LocateAnt(p));
-					            }
-				            }
-				            return identified;
+			            [pools,identifier,collider](const RawData & rawData ) -> IdentifiedFrame::ConstPtr {
+				            return IdentifyRawFrame(*pools,*std::get<1>(rawData),std::get<0>(rawData),
+				                                    *identifier,collider.get());
 			            });
 
 		tbb::filter_t<IdentifiedFrame::ConstPtr,void>
@@ -608,19 +1119,29 @@ void Query::ComputeAntInteractions(const Experiment::ConstPtr & experiment,
                                    const Time::ConstPtr & end,
                                    Duration maximumGap,
                                    const Matcher::Ptr & matcher,
-                                   bool singleThreaded) {
+                                   bool singleThreaded,
+                                   double proximityMargin,
+                                   double simplificationTolerance,
+                                   double angularTolerance,
+                                   bool computeKinematics,
+                                   Duration smoothingWindow) {
 
 	auto identifier = experiment->CIdentifier().Compile();
 	auto solver = experiment->CompileCollisionSolver();
 
+	std::shared_ptr<const InteractionTypeSet> types;
+	Matcher::Ptr compiledMatcher;
 	if ( matcher ) {
-		matcher->SetUpOnce(experiment->CIdentifier().CAnts());
+		compiledMatcher = Matcher::Compile(matcher);
+		compiledMatcher->SetUpOnce(experiment->CIdentifier().CAnts());
+		types = compiledMatcher->InteractionTypeFilter();
 	}
 	DataRangeBySpaceID ranges;
 	BuildRange(experiment,start,end,ranges);
 	if ( ranges.empty() ) {
 		return;
 	}
+	auto pools = std::make_shared<FramePools>();
 
 	BuildingTrajectoryData currentTrajectories;
 	BuildingInteractionData currentInteractions;
@@ -630,7 +1151,11 @@ void Query::ComputeAntInteractions(const Experiment::ConstPtr & experiment,
 		                  currentTrajectories,
 		                  currentInteractions,
 		                  maximumGap,
-		                  matcher);
+		                  compiledMatcher,
+		                  {.Tolerance = simplificationTolerance,
+		                   .AngularTolerance = angularTolerance},
+		                  {.Compute = computeKinematics,
+		                   .SmoothingWindow = smoothingWindow});
 
 	if ( singleThreaded == true ) {
 		DataLoader loader(ranges);
@@ -639,9 +1164,8 @@ void Query::ComputeAntInteractions(const Experiment::ConstPtr & experiment,
 			if ( std::get<0>(raw) == 0 ) {
 				break;
 			}
-			auto identified  = std::get<1>(raw)->IdentifyFrom(*identifier,std::get<0>(raw));
-			auto collided = solver->ComputeCollisions(identified);
-			buildInteractionsFunction({identified,collided});
+			buildInteractionsFunction(CollideRawFrame(*pools,*std::get<1>(raw),std::get<0>(raw),
+			                                          *identifier,*solver,types.get(),proximityMargin));
 		}
 	} else {
 
@@ -650,10 +1174,9 @@ void Query::ComputeAntInteractions(const Experiment::ConstPtr & experiment,
 
 		tbb::filter_t<RawData,CollisionData>
 			computeData(tbb::filter::parallel,
-			            [identifier,solver](const RawData & rawData ) -> CollisionData {
-				            auto identified  = std::get<1>(rawData)->IdentifyFrom(*identifier,std::get<0>(rawData));
-				            auto interacted = solver->ComputeCollisions(identified);
-				            return std::make_pair(identified,interacted);
+			            [pools,identifier,solver,types,proximityMargin](const RawData & rawData ) -> CollisionData {
+				            return CollideRawFrame(*pools,*std::get<1>(rawData),std::get<0>(rawData),
+				                                   *identifier,*solver,types.get(),proximityMargin);
 			            });
 
 
@@ -684,7 +1207,769 @@ void Query::ComputeAntInteractions(const Experiment::ConstPtr & experiment,
 
 
 
+void Query::ComputeAntInteractionSummaries(const Experiment::ConstPtr & experiment,
+                                           std::function<void (const AntInteractionSummary &)> storeSummary,
+                                           const Time::ConstPtr & start,
+                                           const Time::ConstPtr & end,
+                                           Duration maximumGap,
+                                           const Matcher::Ptr & matcher,
+                                           bool computeMeanPositions,
+                                           bool singleThreaded,
+                                           double proximityMargin) {
+	auto identifier = experiment->CIdentifier().Compile();
+	auto solver = experiment->CompileCollisionSolver();
+
+	std::shared_ptr<const InteractionTypeSet> types;
+	Matcher::Ptr compiledMatcher;
+	if ( matcher ) {
+		compiledMatcher = Matcher::Compile(matcher);
+		compiledMatcher->SetUpOnce(experiment->CIdentifier().CAnts());
+		types = compiledMatcher->InteractionTypeFilter();
+	}
+	DataRangeBySpaceID ranges;
+	BuildRange(experiment,start,end,ranges);
+	if ( ranges.empty() ) {
+		return;
+	}
+	auto pools = std::make_shared<FramePools>();
+
+	struct BuildingSummary {
+		Time       Start,Last;
+		PackedTime PackedStart,PackedLast;
+		SpaceID    Space;
+		size_t     Frames;
+		std::set<std::pair<AntShapeTypeID,AntShapeTypeID>> Types;
+		Eigen::Vector2d Sums[2];
+	};
+
+	const int64_t maxGap = maximumGap.Nanoseconds();
+	const double NaN = std::numeric_limits<double>::quiet_NaN();
+	std::map<InteractionID,BuildingSummary> building;
+	std::map<SpaceID,PackedTime> lastSweeps;
+	// index in the current frame positions of each AntID, plus one
+	std::vector<size_t> positionIndex;
+
+	auto terminate = [&](const InteractionID & IDs, const BuildingSummary & b) {
+		// like <AntInteraction>, single frame interactions are dropped.
+		if ( b.PackedStart.SameClock(b.PackedLast) && b.PackedStart.Sub(b.PackedLast) == 0 ) {
+			return;
+		}
+		AntInteractionSummary res
+			= {
+			   .IDs = IDs,
+			   .Types = InteractionTypes(b.Types.size(),2),
+			   .Start = b.Start,
+			   .End = b.Last,
+			   .Space = b.Space,
+			   .Frames = b.Frames,
+			   .MeanPositions = {Eigen::Vector2d(NaN,NaN),Eigen::Vector2d(NaN,NaN)},
+		};
+		size_t i = 0;
+		for ( const auto & type : b.Types ) {
+			res.Types(i,0) = type.first;
+			res.Types(i,1) = type.second;
+			++i;
+		}
+		if ( computeMeanPositions == true ) {
+			res.MeanPositions.first = b.Sums[0] / b.Frames;
+			res.MeanPositions.second = b.Sums[1] / b.Frames;
+		}
+		storeSummary(res);
+	};
+
+	auto summarize = [&](const CollisionData & data) {
+		const auto & frame = std::get<0>(data);
+		const auto & collisions = std::get<1>(data);
+		if ( compiledMatcher ) {
+			compiledMatcher->SetUp(frame,collisions);
+		}
+		const auto & curTime = frame->FrameTime;
+		const auto curPacked = PackedTime::From(curTime);
+
+		// sweeps the space at most once per maximumGap, so ended
+		// interactions are reported without waiting for the end of
+		// the query.
+		auto fiSweep = lastSweeps.find(frame->Space);
+		if ( fiSweep == lastSweeps.end() ) {
+			lastSweeps.insert(std::make_pair(frame->Space,curPacked));
+		} else if ( MustTerminate(curPacked,fiSweep->second,maxGap) ) {
+			fiSweep->second = curPacked;
+			for ( auto iter = building.begin(); iter != building.end(); ) {
+				if ( iter->second.Space != frame->Space
+				     || MustTerminate(curPacked,iter->second.PackedLast,maxGap) == false ) {
+					++iter;
+					continue;
+				}
+				terminate(iter->first,iter->second);
+				iter = building.erase(iter);
+			}
+		}
 
+		if ( computeMeanPositions == true ) {
+			std::fill(positionIndex.begin(),positionIndex.end(),0);
+			for ( size_t i = 0; i < frame->Positions.size(); ++i ) {
+				const auto antID = frame->Positions[i].ID;
+				if ( antID >= positionIndex.size() ) {
+					positionIndex.resize(antID + 1,0);
+				}
+				positionIndex[antID] = i + 1;
+			}
+		}
+
+		for ( const auto & collision : collisions->Collisions ) {
+			if ( compiledMatcher
+			     && compiledMatcher->Match(collision.IDs.first,
+			                               collision.IDs.second,
+			                               collision.Types) == false ) {
+				continue;
+			}
+
+			auto fi = building.find(collision.IDs);
+			if ( fi != building.end()
+			     && ( MustTerminate(curPacked,fi->second.PackedLast,maxGap)
+			          || fi->second.Space != frame->Space ) ) {
+				terminate(fi->first,fi->second);
+				building.erase(fi);
+				fi = building.end();
+			}
+			if ( fi == building.end() ) {
+				fi = building.insert(std::make_pair(collision.IDs,
+				                                    BuildingSummary{.Start = curTime,
+				                                                    .PackedStart = curPacked,
+				                                                    .Space = frame->Space,
+				                                                    .Frames = 0,
+				                                                    .Sums = {Eigen::Vector2d::Zero(),
+				                                                             Eigen::Vector2d::Zero()}})).first;
+			}
+			auto & b = fi->second;
+			b.Last = curTime;
+			b.PackedLast = curPacked;
+			++b.Frames;
+			for ( size_t i = 0; i < collision.Types.rows(); ++i ) {
+				b.Types.insert(std::make_pair(collision.Types(i,0),
+				                              collision.Types(i,1)));
+			}
+			if ( computeMeanPositions == true ) {
+				b.Sums[0] += frame->Positions[positionIndex[collision.IDs.first] - 1].Position;
+				b.Sums[1] += frame->Positions[positionIndex[collision.IDs.second] - 1].Position;
+			}
+		}
+	};
+
+	if ( singleThreaded == true ) {
+		DataLoader loader(ranges);
+		for (;;) {
+			auto raw = loader();
+			if ( std::get<0>(raw) == 0 ) {
+				break;
+			}
+			summarize(CollideRawFrame(*pools,*std::get<1>(raw),std::get<0>(raw),
+			                          *identifier,*solver,types.get(),proximityMargin));
+		}
+	} else {
+		tbb::filter_t<void,RawData>
+			loadData(tbb::filter::serial_in_order,DataLoader(ranges));
+
+		tbb::filter_t<RawData,CollisionData>
+			computeData(tbb::filter::parallel,
+			            [pools,identifier,solver,types,proximityMargin](const RawData & rawData ) -> CollisionData {
+				            return CollideRawFrame(*pools,*std::get<1>(rawData),std::get<0>(rawData),
+				                                   *identifier,*solver,types.get(),proximityMargin);
+			            });
+
+		tbb::filter_t<CollisionData,void>
+			storeData(tbb::filter::serial_in_order,summarize);
+
+		tbb::parallel_pipeline(std::thread::hardware_concurrency() * 2,
+		                       loadData & computeData & storeData);
+	}
+
+	for ( const auto & [IDs,b] : building ) {
+		terminate(IDs,b);
+	}
+}
+
+
+
+
+// Divides and rounds toward -∞
+inline int64_t FloorDiv(int64_t t, int64_t d) {
+	return t >= 0 ? t / d : -((-(t + 1)) / d) - 1;
+}
+
+// Accumulates values per time bin
+//
+// Values are keyed by their bin, then by Key. Once frames reach a
+// bin, values of bins that no interval lasting at most maxGap can
+// contribute to anymore are emitted, in bin order. Bins are aligned
+// on multiple of the bin size since the Unix epoch.
+template <typename Key, typename Value>
+class BinnedAccumulator {
+public:
+	BinnedAccumulator(Duration binSize,
+	                  Duration maxGap,
+	                  std::function<void (const Value &)> store)
+		: d_binNs(binSize.Nanoseconds())
+		, d_maxGap(std::max(maxGap.Nanoseconds(),int64_t(0)))
+		, d_currentBin(std::numeric_limits<int64_t>::min())
+		, d_store(store) {
+		if ( d_binNs <= 0 ) {
+			throw std::invalid_argument("Bin size must be strictly positive, got "
+			                            + std::to_string(d_binNs) + "ns");
+		}
+	}
+
+	// The wall time used to bin a frame time
+	// @time the frame time
+	// @return the wall time in nanoseconds
+	static int64_t WallOf(const Time & time) {
+		return PackSortKey(time.SortKey());
+	}
+
+	// Moves to the bin of a frame time
+	// @time the current frame time
+	// @return the bin of time
+	int64_t Advance(const Time & time) {
+		const int64_t wall = WallOf(time);
+		const int64_t bin = BinOf(wall);
+		if ( bin == d_currentBin ) {
+			return bin;
+		}
+		d_currentBin = bin;
+		// the oldest interval still open started at least maxGap
+		// ago, we keep one more bin to be robust to wall and
+		// monotonic clock drift.
+		int64_t oldest = wall < std::numeric_limits<int64_t>::min() + d_maxGap
+			? std::numeric_limits<int64_t>::min()
+			: wall - d_maxGap;
+		Flush(BinOf(oldest) - 1);
+		return bin;
+	}
+
+	// Gets the value for a bin and a key
+	// @bin the bin
+	// @key the key
+	// @return the value, and true if it was just created
+	std::pair<Value*,bool> At(int64_t bin, const Key & key) {
+		auto [fi,inserted] = d_values.insert(std::make_pair(std::make_pair(bin,key),Value()));
+		return std::make_pair(&(fi->second),inserted);
+	}
+
+	// The start of a bin
+	// @bin the bin
+	// @return the Time the bin starts
+	Time BinStart(int64_t bin) const {
+		return Time().Add(bin * d_binNs);
+	}
+
+	// Emits all remaining values
+	void Finish() {
+		Flush(std::numeric_limits<int64_t>::max());
+	}
+
+	// Splits an interval over the bins it spans
+	// @from the wall time the interval starts
+	// @to the wall time the interval ends
+	// @fn called with each bin and the fraction of the interval in it
+	template <typename Function>
+	void Split(int64_t from, int64_t to, Function fn) const {
+		const int64_t first = BinOf(from);
+		if ( to <= from ) {
+			fn(first,1.0);
+			return;
+		}
+		const int64_t last = BinOf(to);
+		if ( first == last ) {
+			fn(first,1.0);
+			return;
+		}
+		const double length = double(to - from);
+		for ( int64_t bin = first; bin <= last; ++bin ) {
+			const int64_t binStart = std::max(from,bin * d_binNs);
+			const int64_t binEnd = std::min(to,(bin + 1) * d_binNs);
+			if ( binEnd > binStart ) {
+				fn(bin,(binEnd - binStart) / length);
+			}
+		}
+	}
+
+private:
+	int64_t BinOf(int64_t t) const {
+		return FloorDiv(t,d_binNs);
+	}
+
+	void Flush(int64_t bin) {
+		while ( d_values.empty() == false
+		        && d_values.begin()->first.first < bin ) {
+			d_store(d_values.begin()->second);
+			d_values.erase(d_values.begin());
+		}
+	}
+
+	int64_t                                 d_binNs,d_maxGap,d_currentBin;
+	std::function<void (const Value &)>     d_store;
+	std::map<std::pair<int64_t,Key>,Value>  d_values;
+};
+
+void Query::ComputeAntZoneSummaries(const Experiment::ConstPtr & experiment,
+                                    std::function<void (const AntZoneSummary &)> storeSummary,
+                                    const Time::ConstPtr & start,
+                                    const Time::ConstPtr & end,
+                                    Duration binSize,
+                                    Duration maximumGap,
+                                    const Matcher::Ptr & matcher,
+                                    bool singleThreaded) {
+	BinnedAccumulator<std::tuple<AntID,SpaceID,ZoneID>,AntZoneSummary>
+		summaries(binSize,maximumGap,storeSummary);
+
+	Matcher::Ptr compiledMatcher;
+	if ( matcher ) {
+		compiledMatcher = Matcher::Compile(matcher);
+		compiledMatcher->SetUpOnce(experiment->CIdentifier().CAnts());
+	}
+
+	struct LastSeen {
+		PackedTime Time;
+		int64_t    Wall;
+		double     X,Y;
+		SpaceID    Space;
+		ZoneID     Zone;
+		int64_t    Bin;
+	};
+
+	const int64_t maxGap = maximumGap.Nanoseconds();
+	std::map<AntID,LastSeen> lastSeen;
+
+	auto summaryFor = [&summaries](int64_t bin, AntID antID, SpaceID spaceID, ZoneID zoneID) -> AntZoneSummary & {
+		                  auto [summary,created] = summaries.At(bin,std::make_tuple(antID,spaceID,zoneID));
+		                  if ( created == true ) {
+			                  *summary = {.Ant = antID,
+			                              .Space = spaceID,
+			                              .Zone = zoneID,
+			                              .BinStart = summaries.BinStart(bin),
+			                              .DwellTime = 0.0,
+			                              .Detections = 0,
+			                              .PathLength = 0.0};
+		                  }
+		                  return *summary;
+	                  };
+
+	auto accumulate =
+		[&](const IdentifiedFrame::ConstPtr & frame) {
+			const int64_t frameBin = summaries.Advance(frame->FrameTime);
+			if ( compiledMatcher ) {
+				compiledMatcher->SetUp(frame,CollisionFrame::ConstPtr());
+			}
+			const auto time = PackedTime::From(frame->FrameTime);
+			const int64_t wall = summaries.WallOf(frame->FrameTime);
+			for ( size_t i = 0; i < frame->Positions.size(); ++i ) {
+				const auto & pa = frame->Positions[i];
+				if ( compiledMatcher && compiledMatcher->Match(pa.ID,0,{}) == false ) {
+					continue;
+				}
+				ZoneID zone = frame->Zones.empty() ? 0 : frame->Zones[i];
+				summaryFor(frameBin,pa.ID,frame->Space,zone).Detections += 1;
+
+				LastSeen current = {.Time = time,
+				                    .Wall = wall,
+				                    .X = pa.Position.x(),
+				                    .Y = pa.Position.y(),
+				                    .Space = frame->Space,
+				                    .Zone = zone,
+				                    .Bin = frameBin};
+				auto [fi,inserted] = lastSeen.insert(std::make_pair(pa.ID,current));
+				if ( inserted == true ) {
+					continue;
+				}
+				const auto & last = fi->second;
+				if ( MustTerminate(time,last.Time,maxGap) == false
+				     && last.Space == frame->Space ) {
+					// the interval is split over the bins it spans,
+					// assuming a linear motion.
+					const double dwellTime = time.Sub(last.Time) * 1.0e-9;
+					const double pathLength = std::hypot(current.X - last.X,current.Y - last.Y);
+					summaries.Split(last.Wall,wall,
+					                [&](int64_t bin, double fraction) {
+						                auto & summary = summaryFor(bin,pa.ID,last.Space,last.Zone);
+						                summary.DwellTime += fraction * dwellTime;
+						                summary.PathLength += fraction * pathLength;
+					                });
+				}
+				fi->second = current;
+			}
+		};
+
+	IdentifyFrames(experiment,accumulate,start,end,true,singleThreaded);
+
+	summaries.Finish();
+}
+
+void Query::ComputeAntContactEdges(const Experiment::ConstPtr & experiment,
+                                   std::function<void (const AntContactEdge &)> storeEdge,
+                                   const Time::ConstPtr & start,
+                                   const Time::ConstPtr & end,
+                                   Duration windowSize,
+                                   Duration maximumGap,
+                                   const Matcher::Ptr & matcher,
+                                   bool splitByType,
+                                   bool singleThreaded) {
+	typedef std::tuple<AntID,AntID,AntShapeTypeID,AntShapeTypeID> EdgeKey;
+	BinnedAccumulator<EdgeKey,AntContactEdge> edges(windowSize,maximumGap,storeEdge);
+
+	Matcher::Ptr compiledMatcher;
+	if ( matcher ) {
+		compiledMatcher = Matcher::Compile(matcher);
+		compiledMatcher->SetUpOnce(experiment->CIdentifier().CAnts());
+	}
+
+	struct LastContact {
+		PackedTime Time;
+		int64_t    Wall;
+	};
+
+	const int64_t maxGap = maximumGap.Nanoseconds();
+	std::map<EdgeKey,LastContact> lastContacts;
+
+	auto edgeFor = [&edges](int64_t bin, const EdgeKey & key) -> AntContactEdge & {
+		               auto [edge,created] = edges.At(bin,key);
+		               if ( created == true ) {
+			               *edge = {.IDs = std::make_pair(std::get<0>(key),std::get<1>(key)),
+			                        .Types = std::make_pair(std::get<2>(key),std::get<3>(key)),
+			                        .WindowStart = edges.BinStart(bin),
+			                        .Count = 0,
+			                        .TotalDuration = 0.0,
+			                        .Frames = 0};
+		               }
+		               return *edge;
+	               };
+
+	auto accumulateKey =
+		[&](const EdgeKey & key, const PackedTime & time, int64_t wall, int64_t bin) {
+			auto & edge = edgeFor(bin,key);
+			edge.Frames += 1;
+			auto [fi,inserted] = lastContacts.insert(std::make_pair(key,LastContact{time,wall}));
+			if ( inserted == false
+			     && MustTerminate(time,fi->second.Time,maxGap) == false ) {
+				// the duration is split over the windows it spans
+				const double duration = time.Sub(fi->second.Time) * 1.0e-9;
+				edges.Split(fi->second.Wall,wall,
+				            [&](int64_t bin, double fraction) {
+					            edgeFor(bin,key).TotalDuration += fraction * duration;
+				            });
+			} else {
+				edge.Count += 1;
+			}
+			fi->second = {time,wall};
+		};
+
+	auto accumulate =
+		[&](const CollisionData & data) {
+			const auto & [identified,collided] = data;
+			const int64_t bin = edges.Advance(collided->FrameTime);
+			if ( compiledMatcher ) {
+				compiledMatcher->SetUp(identified,collided);
+			}
+			const auto time = PackedTime::From(collided->FrameTime);
+			const int64_t wall = edges.WallOf(collided->FrameTime);
+			for ( const auto & c : collided->Collisions ) {
+				if ( compiledMatcher
+				     && compiledMatcher->Match(c.IDs.first,c.IDs.second,c.Types) == false ) {
+					continue;
+				}
+				if ( splitByType == false ) {
+					accumulateKey(EdgeKey(c.IDs.first,c.IDs.second,0,0),time,wall,bin);
+					continue;
+				}
+				for ( size_t i = 0; i < c.Types.rows(); ++i ) {
+					accumulateKey(EdgeKey(c.IDs.first,c.IDs.second,c.Types(i,0),c.Types(i,1)),time,wall,bin);
+				}
+			}
+		};
+
+	CollideFrames(experiment,accumulate,start,end,singleThreaded);
+
+	edges.Finish();
+}
+
+void Query::ComputeAntNeighbours(const Experiment::ConstPtr & experiment,
+                                 std::function<void (const AntNeighbours::ConstPtr &)> storeNeighbours,
+                                 const Time::ConstPtr & start,
+                                 const Time::ConstPtr & end,
+                                 size_t k,
+                                 double radius,
+                                 bool singleThreaded) {
+	if ( k == 0 && radius <= 0.0 ) {
+		throw std::invalid_argument("Either k or radius must be strictly positive");
+	}
+	auto identifier = experiment->CIdentifier().Compile();
+	DataRangeBySpaceID ranges;
+	BuildRange(experiment,start,end,ranges);
+	if ( ranges.empty() ) {
+		return;
+	}
+	auto pools = std::make_shared<FramePools>();
+
+	if ( singleThreaded == true ) {
+		DataLoader loader(ranges);
+		for (;;) {
+			auto raw = loader();
+			if ( std::get<0>(raw) == 0 ) {
+				break;
+			}
+			auto identified = IdentifyRawFrame(*pools,*std::get<1>(raw),std::get<0>(raw),
+			                                   *identifier,nullptr);
+			storeNeighbours(FindNeighbours(*identified,k,radius));
+		}
+		return;
+	}
+
+	tbb::filter_t<void,RawData>
+		loadData(tbb::filter::serial_in_order,DataLoader(ranges));
+
+	tbb::filter_t<RawData,AntNeighbours::ConstPtr>
+		computeData(tbb::filter::parallel,
+		            [pools,identifier,k,radius](const RawData & rawData) -> AntNeighbours::ConstPtr {
+			            auto identified = IdentifyRawFrame(*pools,*std::get<1>(rawData),std::get<0>(rawData),
+			                                               *identifier,nullptr);
+			            return FindNeighbours(*identified,k,radius);
+		            });
+
+	tbb::filter_t<AntNeighbours::ConstPtr,void>
+		storeData(tbb::filter::serial_in_order,
+		          storeNeighbours);
+
+	tbb::parallel_pipeline(std::thread::hardware_concurrency()*2,loadData & computeData & storeData);
+}
+
+void Query::ComputeAntZoneTransitions(const Experiment::ConstPtr & experiment,
+                                      std::function<void (const AntZoneTransition &)> storeTransition,
+                                      const Time::ConstPtr & start,
+                                      const Time::ConstPtr & end,
+                                      Duration debounce,
+                                      Duration maximumGap,
+                                      const Matcher::Ptr & matcher,
+                                      bool singleThreaded) {
+	Matcher::Ptr compiledMatcher;
+	if ( matcher ) {
+		compiledMatcher = Matcher::Compile(matcher);
+		compiledMatcher->SetUpOnce(experiment->CIdentifier().CAnts());
+	}
+
+	struct ZoneState {
+		// last detection
+		PackedTime Last;
+		Time       LastTime;
+		SpaceID    Space;
+		// confirmed zone
+		ZoneID     Zone;
+		// zone the ant moved to, not confirmed until debounce
+		bool       HasCandidate;
+		ZoneID     Candidate;
+		PackedTime CandidateStart;
+		Time       CandidateTime;
+	};
+
+	const int64_t maxGap = maximumGap.Nanoseconds();
+	const int64_t debounceNs = debounce.Nanoseconds();
+	DenseMap<AntID,ZoneState> states;
+
+	auto track =
+		[&](const IdentifiedFrame::ConstPtr & frame) {
+			if ( compiledMatcher ) {
+				compiledMatcher->SetUp(frame,CollisionFrame::ConstPtr());
+			}
+			const auto time = PackedTime::From(frame->FrameTime);
+			for ( size_t i = 0; i < frame->Positions.size(); ++i ) {
+				const auto & pa = frame->Positions[i];
+				if ( compiledMatcher && compiledMatcher->Match(pa.ID,0,{}) == false ) {
+					continue;
+				}
+				const ZoneID zone = frame->Zones.empty() ? 0 : frame->Zones[i];
+				auto fi = states.find(pa.ID);
+				if ( fi != states.end()
+				     && ( MustTerminate(time,fi->second.Last,maxGap) == true
+				          || fi->second.Space != frame->Space ) ) {
+					const auto & s = fi->second;
+					storeTransition({.Ant = pa.ID,
+					                 .Space = s.Space,
+					                 .From = s.Zone,
+					                 .To = AntZoneTransition::UNDETECTED,
+					                 .FrameTime = s.LastTime});
+					states.erase(fi);
+					fi = states.end();
+				}
+				if ( fi == states.end() ) {
+					states.insert(std::make_pair(pa.ID,
+					                             ZoneState{.Last = time,
+					                                       .LastTime = frame->FrameTime,
+					                                       .Space = frame->Space,
+					                                       .Zone = zone,
+					                                       .HasCandidate = false}));
+					storeTransition({.Ant = pa.ID,
+					                 .Space = frame->Space,
+					                 .From = AntZoneTransition::UNDETECTED,
+					                 .To = zone,
+					                 .FrameTime = frame->FrameTime});
+					continue;
+				}
+				auto & s = fi->second;
+				s.Last = time;
+				s.LastTime = frame->FrameTime;
+				if ( zone == s.Zone ) {
+					s.HasCandidate = false;
+					continue;
+				}
+				if ( s.HasCandidate == false || s.Candidate != zone ) {
+					s.HasCandidate = true;
+					s.Candidate = zone;
+					s.CandidateStart = time;
+					s.CandidateTime = frame->FrameTime;
+				}
+				if ( time.Sub(s.CandidateStart) < debounceNs ) {
+					continue;
+				}
+				storeTransition({.Ant = pa.ID,
+				                 .Space = s.Space,
+				                 .From = s.Zone,
+				                 .To = zone,
+				                 .FrameTime = s.CandidateTime});
+				s.Zone = zone;
+				s.HasCandidate = false;
+			}
+		};
+
+	IdentifyFrames(experiment,track,start,end,true,singleThreaded);
+
+	// closes the stays still open at the end of the query, like a
+	// gap would.
+	for ( const auto & [antID,s] : states ) {
+		storeTransition({.Ant = antID,
+		                 .Space = s.Space,
+		                 .From = s.Zone,
+		                 .To = AntZoneTransition::UNDETECTED,
+		                 .FrameTime = s.LastTime});
+	}
+}
+
+void Query::ComputeAntOccupancyHeatmaps(const Experiment::ConstPtr & experiment,
+                                        std::function<void (const AntOccupancyHeatmap::ConstPtr &)> storeHeatmap,
+                                        const Time::ConstPtr & start,
+                                        const Time::ConstPtr & end,
+                                        double binSize,
+                                        Duration windowSize,
+                                        bool perAnt,
+                                        const std::string & groupColumn,
+                                        bool singleThreaded) {
+	if ( binSize <= 0.0 ) {
+		throw std::invalid_argument("Bin size must be strictly positive, got "
+		                            + std::to_string(binSize));
+	}
+	auto identifier = experiment->CIdentifier().Compile();
+	const auto & ants = experiment->CIdentifier().CAnts();
+	const bool grouped = groupColumn.empty() == false;
+	AntMetadata::ColumnID column(0);
+	if ( grouped == true ) {
+		column = experiment->AntMetadataConstPtr()->ColumnIDOf(groupColumn);
+	}
+	DataRangeBySpaceID ranges;
+	BuildRange(experiment,start,end,ranges);
+	if ( ranges.empty() ) {
+		return;
+	}
+	auto pools = std::make_shared<FramePools>();
+
+	typedef AntOccupancyHeatmap::Counts                            Counts;
+	typedef std::tuple<int64_t,SpaceID,AntID,AntStaticValue>       GridKey;
+	typedef std::map<GridKey,Counts>                               Grids;
+	struct LocalGrids {
+		Grids          Values;
+		Time::ConstPtr First;
+	};
+	tbb::enumerable_thread_specific<LocalGrids> locals;
+	const int64_t windowNs = windowSize.Nanoseconds();
+
+	auto addTo = [](Counts & grid, const Counts & other) {
+		             if ( grid.rows() < other.rows() || grid.cols() < other.cols() ) {
+			             grid.conservativeResizeLike(Counts::Zero(std::max(grid.rows(),other.rows()),
+			                                                      std::max(grid.cols(),other.cols())));
+		             }
+		             grid.block(0,0,other.rows(),other.cols()) += other;
+	             };
+
+	auto accumulate =
+		[&](const RawData & raw) {
+			auto frame = IdentifyRawFrame(*pools,*std::get<1>(raw),std::get<0>(raw),*identifier,nullptr);
+			auto & local = locals.local();
+			if ( !local.First || frame->FrameTime.Before(*local.First) ) {
+				local.First = std::make_shared<Time>(frame->FrameTime);
+			}
+			const int64_t window = windowNs > 0 ? FloorDiv(PackSortKey(frame->FrameTime.SortKey()),windowNs) : 0;
+			const Eigen::Index height = std::ceil(frame->Height / binSize);
+			const Eigen::Index width = std::ceil(frame->Width / binSize);
+			for ( const auto & pa : frame->Positions ) {
+				if ( pa.Position.x() < 0.0 || pa.Position.y() < 0.0 ) {
+					continue;
+				}
+				const Eigen::Index row = pa.Position.y() / binSize;
+				const Eigen::Index col = pa.Position.x() / binSize;
+				GridKey key(window,
+				            frame->Space,
+				            perAnt ? pa.ID : 0,
+				            grouped ? ants.at(pa.ID)->GetValue(column,frame->FrameTime.SortKey()) : AntStaticValue(false));
+				auto & grid = local.Values[key];
+				// grids cover the frame and any position outside of it
+				const Eigen::Index rows = std::max({grid.rows(),height,row+1});
+				const Eigen::Index cols = std::max({grid.cols(),width,col+1});
+				if ( grid.rows() < rows || grid.cols() < cols ) {
+					grid.conservativeResizeLike(Counts::Zero(rows,cols));
+				}
+				grid(row,col) += 1;
+			}
+		};
+
+	if ( singleThreaded == true ) {
+		DataLoader loader(ranges);
+		for (;;) {
+			auto raw = loader();
+			if ( std::get<0>(raw) == 0 ) {
+				break;
+			}
+			accumulate(raw);
+		}
+	} else {
+		tbb::filter_t<void,RawData>
+			loadData(tbb::filter::serial_in_order,DataLoader(ranges));
+
+		tbb::filter_t<RawData,void>
+			computeData(tbb::filter::parallel,accumulate);
+
+		tbb::parallel_pipeline(std::thread::hardware_concurrency() * 2,
+		                       loadData & computeData);
+	}
+
+	Grids result;
+	Time::ConstPtr first = start;
+	for ( const auto & local : locals ) {
+		if ( !start && local.First && ( !first || local.First->Before(*first) ) ) {
+			first = local.First;
+		}
+		for ( const auto & [key,grid] : local.Values ) {
+			addTo(result[key],grid);
+		}
+	}
+
+	for ( const auto & [key,grid] : result ) {
+		auto res = std::make_shared<AntOccupancyHeatmap>();
+		const auto & [window,spaceID,antID,group] = key;
+		res->Space = spaceID;
+		res->Ant = antID;
+		res->Group = group;
+		res->WindowStart = windowNs > 0 ? Time().Add(window * windowNs) : *first;
+		res->BinSize = binSize;
+		res->Detections = grid;
+		storeHeatmap(res);
+	}
+}
 
 } // namespace priv
 } // namespace myrmidon
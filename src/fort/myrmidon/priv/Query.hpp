@@ -6,6 +6,7 @@
 #include "Experiment.hpp"
 #include "TrackingDataDirectory.hpp"
 #include "Matchers.hpp"
+#include "TimeUtils.hpp"
 
 
 #include <tbb/pipeline.h>
@@ -29,12 +30,28 @@ public:
 	                           bool computeZones = false,
 	                           bool singleThreaded = false);
 
+	// Identifies only the ants located in region. The tracking
+	// segments where the <TagSpatialIndex> has none of the
+	// identified tags near region are not read, and only the tags
+	// near region are identified. Frames without any ant in region
+	// are not reported.
+	static void IdentifyFramesInRegion(const Experiment::ConstPtr & experiment,
+	                                   std::function<void (const IdentifiedFrame::ConstPtr &)> storeData,
+	                                   const Time::ConstPtr & start,
+	                                   const Time::ConstPtr & end,
+	                                   const AABB & region,
+	                                   bool computeZones = false,
+	                                   bool singleThreaded = false);
+
 	static void CollideFrames(const Experiment::ConstPtr & experiment,
 	                          std::function<void (const CollisionData & data) > storeData,
 	                          const Time::ConstPtr & start,
 	                          const Time::ConstPtr & end,
-	                          bool singleThreaded = false);
+	                          bool singleThreaded = false,
+	                          double proximityMargin = 0.0);
 
+	// samplingPeriod and simplificationTolerance are exclusive, an
+	// std::invalid_argument is thrown if both are strictly positive.
 	static void ComputeTrajectories(const Experiment::ConstPtr & experiment,
 	                                std::function<void (const AntTrajectory::ConstPtr &)> storeData,
 	                                const Time::ConstPtr & start,
@@ -42,7 +59,13 @@ public:
 	                                Duration maximumGap,
 	                                const Matcher::Ptr & matcher = Matcher::Ptr(),
 	                                bool computeZones = false,
-	                                bool singleThreaded = false);
+	                                bool singleThreaded = false,
+	                                Duration samplingPeriod = 0,
+	                                Duration maximumInterpolationGap = 0,
+	                                double simplificationTolerance = 0.0,
+	                                double angularTolerance = 0.0,
+	                                bool computeKinematics = false,
+	                                Duration smoothingWindow = 0);
 
 
 	// computes trajectories and interactions. Bad invariant
@@ -55,28 +78,189 @@ public:
 	                                   const Time::ConstPtr & end,
 	                                   Duration maximumGap,
 	                                   const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                   bool singleThreaded = false,
+	                                   double proximityMargin = 0.0,
+	                                   double simplificationTolerance = 0.0,
+	                                   double angularTolerance = 0.0,
+	                                   bool computeKinematics = false,
+	                                   Duration smoothingWindow = 0);
+
+	// Computes interactions without building any trajectory. Mean
+	// positions are only accumulated when requested. Summaries of
+	// a space are reported once maximumGap elapsed in that space
+	// since their last collision.
+	static void ComputeAntInteractionSummaries(const Experiment::ConstPtr & experiment,
+	                                           std::function<void (const AntInteractionSummary &)> storeSummary,
+	                                           const Time::ConstPtr & start,
+	                                           const Time::ConstPtr & end,
+	                                           Duration maximumGap,
+	                                           const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                           bool computeMeanPositions = false,
+	                                           bool singleThreaded = false,
+	                                           double proximityMargin = 0.0);
+
+	// Streams identified frames to summarize ant presence in zones
+	// per time bin. Summaries are reported ordered by bin, once no
+	// later frame can contribute to them.
+	static void ComputeAntZoneSummaries(const Experiment::ConstPtr & experiment,
+	                                    std::function<void (const AntZoneSummary &)> storeSummary,
+	                                    const Time::ConstPtr & start,
+	                                    const Time::ConstPtr & end,
+	                                    Duration binSize,
+	                                    Duration maximumGap,
+	                                    const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                    bool singleThreaded = false);
+
+	// Streams collision frames to aggregate contacts per ant pair
+	// and time window. Edges are reported ordered by window.
+	static void ComputeAntContactEdges(const Experiment::ConstPtr & experiment,
+	                                   std::function<void (const AntContactEdge &)> storeEdge,
+	                                   const Time::ConstPtr & start,
+	                                   const Time::ConstPtr & end,
+	                                   Duration windowSize,
+	                                   Duration maximumGap,
+	                                   const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                   bool splitByType = false,
 	                                   bool singleThreaded = false);
 
+	// Reports the zone changes of each ant, in time order for each
+	// ant. A change is only reported once the ant stayed at least
+	// debounce in its new zone.
+	static void ComputeAntZoneTransitions(const Experiment::ConstPtr & experiment,
+	                                      std::function<void (const AntZoneTransition &)> storeTransition,
+	                                      const Time::ConstPtr & start,
+	                                      const Time::ConstPtr & end,
+	                                      Duration debounce,
+	                                      Duration maximumGap,
+	                                      const Matcher::Ptr & matcher = Matcher::Ptr(),
+	                                      bool singleThreaded = false);
+
+	// Reports for each frame the k nearest neighbours of each ant,
+	// up to radius if strictly positive, or if k is 0 all pairs of
+	// ants closer than radius. Relations are computed with a KDTree
+	// in the parallel stage of the query.
+	static void ComputeAntNeighbours(const Experiment::ConstPtr & experiment,
+	                                 std::function<void (const AntNeighbours::ConstPtr &)> storeNeighbours,
+	                                 const Time::ConstPtr & start,
+	                                 const Time::ConstPtr & end,
+	                                 size_t k,
+	                                 double radius,
+	                                 bool singleThreaded = false);
+
+	// Finds the neighbours of the ants of a frame, as reported by
+	// <ComputeAntNeighbours>.
+	static AntNeighbours::Ptr FindNeighbours(const IdentifiedFrame & frame,
+	                                         size_t k,
+	                                         double radius);
+
+	// Accumulates 2D histograms of ant positions per space and time
+	// window, in thread local grids reduced once all frames are
+	// processed. A windowSize of zero or less gives a single window.
+	static void ComputeAntOccupancyHeatmaps(const Experiment::ConstPtr & experiment,
+	                                        std::function<void (const AntOccupancyHeatmap::ConstPtr &)> storeHeatmap,
+	                                        const Time::ConstPtr & start,
+	                                        const Time::ConstPtr & end,
+	                                        double binSize,
+	                                        Duration windowSize,
+	                                        bool perAnt = false,
+	                                        const std::string & groupColumn = "",
+	                                        bool singleThreaded = false);
+
 private:
 	typedef std::pair<TrackingDataDirectory::const_iterator,
 	                  TrackingDataDirectory::const_iterator> DataRange;
 	typedef std::map<Space::ID,std::vector<DataRange>>       DataRangeBySpaceID;
 	typedef std::pair<Space::ID,RawFrameConstPtr>            RawData;
 
+	// Resampling of trajectories at a fixed period. Samples are
+	// interpolated between the two surrounding detections, unless
+	// they are more than MaximumGap apart. A Period of zero or less
+	// keeps every detection, a MaximumGap of zero or less
+	// interpolates any gap.
+	struct Resampling {
+		int64_t Period;
+		int64_t MaximumGap;
+	};
+
+	// Online simplification of trajectories. A detection is dropped
+	// if the trajectory linearly interpolated between the kept ones
+	// stays within Tolerance pixels and AngularTolerance radians of
+	// it. A Tolerance of zero or less keeps every detection, an
+	// AngularTolerance of zero or less does not bound angles.
+	struct Simplification {
+		double Tolerance;
+		double AngularTolerance;
+	};
+
+	// Kinematics computed on terminated trajectories, see
+	// <AntTrajectory::ComputeKinematics>.
+	struct KinematicsOptions {
+		bool     Compute;
+		Duration SmoothingWindow;
+	};
+
 	struct BuildingTrajectory {
 		std::shared_ptr<AntTrajectory> Trajectory;
 
-		Time                  Last;
+		PackedTime            Start,Last;
 		std::vector<double>   DataPoints;
 		std::vector<double>   Durations;
 		std::vector<uint32_t> Zones;
 
+		// resampling state: the last detection, and the offset of the
+		// next sample from Start.
+		Resampling            Sampling;
+		Eigen::Vector3d       LastPose;
+		ZoneID                LastZone;
+		int64_t               NextSample;
+
+		// simplification state: the last kept point, the range of
+		// velocities towards the next one keeping the dropped
+		// detections within tolerance, and the last detection, not
+		// yet kept or dropped. Angles are unwrapped.
+		struct WindowPoint {
+			int64_t         Time;
+			Eigen::Vector3d Pose;
+		};
+		Simplification           Simplifying;
+		int64_t                  AnchorTime;
+		Eigen::Vector3d          AnchorPose;
+		Eigen::Vector3d          MinVelocity,MaxVelocity;
+		std::vector<WindowPoint> Window;
+		bool                     HasPending;
+		WindowPoint              Pending;
+		ZoneID                   PendingZone;
+		double                   MaximumError,MaximumAngularError;
+
+		size_t                   Detections;
+		KinematicsOptions        Kinematics;
+
 		BuildingTrajectory(const IdentifiedFrame::ConstPtr & frame,
+		                   const PackedTime & time,
 		                   const PositionedAnt & ant,
-		                   const ZoneID * zone);
-		void Append(const IdentifiedFrame::ConstPtr & frame,
+		                   const ZoneID * zone,
+		                   const Resampling & sampling = {0,0},
+		                   const Simplification & simplification = {0.0,0.0},
+		                   const KinematicsOptions & kinematics = {false,0});
+		void Append(const PackedTime & time,
 		            const PositionedAnt & ant,
 		            const ZoneID * zone);
+		void Resample(const PackedTime & time,
+		              const PositionedAnt & ant,
+		              const ZoneID * zone);
+		void Simplify(const PackedTime & time,
+		              const PositionedAnt & ant,
+		              const ZoneID * zone);
+		// keeps Pending, and makes it the new anchor
+		void KeepPending();
+		// keeps Pending if any, so indexes in the trajectory are
+		// final up to the last appended detection.
+		void Flush();
+		// errors of the dropped detections since the last kept point
+		std::pair<double,double> WindowErrors() const;
+
+		// Number of points of the trajectory, including Pending.
+		size_t Size() const;
 
 		AntTrajectory::ConstPtr Terminate() const;
 
@@ -85,16 +269,21 @@ private:
 	struct BuildingInteraction {
 		InteractionID             IDs;
 		Time Start,Last;
+		PackedTime PackedStart,PackedLast;
 		std::set<std::pair<AntShapeTypeID,AntShapeTypeID>> Types;
 		BuildingInteraction(const Collision & collision,
-		                    const Time & curTime);
+		                    const Time & curTime,
+		                    const PackedTime & packedTime);
 
 		void Append(const Collision & collision,
-		            const Time & curTime);
+		            const Time & curTime,
+		            const PackedTime & packedTime);
 
 
-		AntInteraction::ConstPtr Terminate(const BuildingTrajectory & a,
-		                                   const BuildingTrajectory & b) const;
+		// flushes both trajectories, as a pending point could be
+		// dropped later and shift the segment indexes.
+		AntInteraction::ConstPtr Terminate(BuildingTrajectory & a,
+		                                   BuildingTrajectory & b) const;
 	};
 
 	typedef std::map<AntID,BuildingTrajectory> BuildingTrajectoryData;
@@ -106,6 +295,16 @@ private:
 	                       const Time::ConstPtr & end,
 	                       DataRangeBySpaceID & ranges);
 
+	// Like <BuildRange>, but only with the tracking segments that
+	// may have one of tagIDs in tagRegion. Computes the
+	// <TagSpatialIndex> of the directories if needed.
+	static void BuildRegionRange(const Experiment::ConstPtr & experiment,
+	                             const Time::ConstPtr & start,
+	                             const Time::ConstPtr & end,
+	                             const AABB & tagRegion,
+	                             const std::vector<TagID> & tagIDs,
+	                             DataRangeBySpaceID & ranges);
+
 	class DataLoader {
 	public:
 		DataLoader(const DataRangeBySpaceID & dataRanges);
@@ -126,7 +325,10 @@ private:
 	BuildTrajectories(std::function<void(const AntTrajectory::ConstPtr&)> store,
 	                  BuildingTrajectoryData & building,
 	                  Duration maxGap,
-	                  const Matcher::Ptr & matcher);
+	                  const Matcher::Ptr & matcher,
+	                  const Resampling & sampling = {0,0},
+	                  const Simplification & simplification = {0.0,0.0},
+	                  const KinematicsOptions & kinematics = {false,0});
 
 
 	static std::function<void(const CollisionData &)>
@@ -135,7 +337,9 @@ private:
 	                  BuildingTrajectoryData & currentTrajectories,
 	                  BuildingInteractionData & currentInteractions,
 	                  Duration maxGap,
-	                  const Matcher::Ptr & matcher);
+	                  const Matcher::Ptr & matcher,
+	                  const Simplification & simplification = {0.0,0.0},
+	                  const KinematicsOptions & kinematics = {false,0});
 
 
 
@@ -1,8 +1,12 @@
 #include "QueryUTest.hpp"
 
+#include <random>
+
 #include "Query.hpp"
 #include "Ant.hpp"
 #include "Capsule.hpp"
+#include "Polygon.hpp"
+#include "Space.hpp"
 
 #include <fort/myrmidon/TestSetup.hpp>
 
@@ -105,6 +109,124 @@ TEST_F(QueryUTest,IdentifiedFrame) {
 	EXPECT_EQ(identifieds.size(),599);
 }
 
+TEST_F(QueryUTest,FramesInRegion) {
+	ASSERT_NO_THROW({
+			experiment->CreateAnt(1);
+			experiment->CreateAnt(2);
+			auto ident = Identifier::AddIdentification(experiment->Identifier(),1,123,{},{});
+			// ants are 20 pixels away from their tag
+			ident->SetUserDefinedAntPose(Eigen::Vector2d(20,0),0.0);
+			Identifier::AddIdentification(experiment->Identifier(),2,124,{},{});
+		});
+
+	auto inRegion = [](const AABB & region,
+	                   const std::vector<IdentifiedFrame::ConstPtr> & frames) {
+		                std::vector<IdentifiedFrame::ConstPtr> res;
+		                for ( const auto & frame : frames ) {
+			                auto filtered = std::make_shared<IdentifiedFrame>(*frame);
+			                filtered->Positions.clear();
+			                for ( const auto & p : frame->Positions ) {
+				                if ( region.contains(p.Position) ) {
+					                filtered->Positions.push_back(p);
+				                }
+			                }
+			                if ( filtered->Positions.empty() == false ) {
+				                res.push_back(filtered);
+			                }
+		                }
+		                return res;
+	                };
+
+	const auto & tdds = experiment->CSpaces().begin()->second->TrackingDataDirectories();
+	auto t = tdds.front()->StartDate();
+	auto start = std::make_shared<Time>(t.Add(3 * Duration::Second));
+	auto end = std::make_shared<Time>(t.Add(33 * Duration::Second));
+	// the index may have been cached by a previous run
+	std::vector<bool> computedBefore;
+	for ( const auto & tdd : tdds ) {
+		computedBefore.push_back(tdd->SpatialIndexComputed());
+	}
+
+	std::vector<IdentifiedFrame::ConstPtr> all;
+	ASSERT_NO_THROW({
+			Query::IdentifyFrames(experiment,
+			                      [&all] (const IdentifiedFrame::ConstPtr & i) {
+				                      all.push_back(i);
+			                      },
+			                      start,
+			                      end);
+		});
+
+	for ( const auto & region : {AABB(Eigen::Vector2d(100,100),Eigen::Vector2d(160,160)),
+	                             AABB(Eigen::Vector2d(40,40),Eigen::Vector2d(180,100)),
+	                             AABB(Eigen::Vector2d(2000,2000),Eigen::Vector2d(2200,2200))} ) {
+		auto expected = inRegion(region,all);
+		for ( bool singleThreaded : {false,true} ) {
+			std::vector<IdentifiedFrame::ConstPtr> frames;
+			ASSERT_NO_THROW({
+					Query::IdentifyFramesInRegion(experiment,
+					                              [&frames] (const IdentifiedFrame::ConstPtr & i) {
+						                              frames.push_back(i);
+					                              },
+					                              start,
+					                              end,
+					                              region,
+					                              false,
+					                              singleThreaded);
+				});
+			ASSERT_EQ(frames.size(),expected.size());
+			for ( size_t i = 0; i < frames.size(); ++i ) {
+				EXPECT_EQ(frames[i]->FrameTime,expected[i]->FrameTime);
+				EXPECT_EQ(frames[i]->Space,expected[i]->Space);
+				ASSERT_EQ(frames[i]->Positions.size(),expected[i]->Positions.size());
+				for ( size_t j = 0; j < frames[i]->Positions.size(); ++j ) {
+					EXPECT_EQ(frames[i]->Positions[j].ID,expected[i]->Positions[j].ID);
+					EXPECT_TRUE(VectorAlmostEqual(frames[i]->Positions[j].Position,
+					                              expected[i]->Positions[j].Position));
+				}
+			}
+		}
+	}
+	EXPECT_FALSE(all.empty());
+
+	// only the TrackingDataDirectory within the range are indexed
+	for ( size_t i = 0; i < tdds.size(); ++i ) {
+		if ( tdds[i]->StartDate().After(*end) == true ) {
+			EXPECT_EQ(tdds[i]->SpatialIndexComputed(),computedBefore[i]);
+		} else {
+			EXPECT_TRUE(tdds[i]->SpatialIndexComputed());
+		}
+	}
+	ASSERT_NO_THROW({
+			Query::IdentifyFramesInRegion(experiment,
+			                              [] (const IdentifiedFrame::ConstPtr & ) {},
+			                              Time::ConstPtr(),
+			                              Time::ConstPtr(),
+			                              AABB(Eigen::Vector2d(2000,2000),Eigen::Vector2d(2200,2200)),
+			                              false,
+			                              false);
+		});
+
+	for ( const auto & tdd : tdds ) {
+		ASSERT_TRUE(tdd->SpatialIndexComputed());
+		const auto & index = tdd->SpatialIndex();
+		ASSERT_EQ(index.size(),tdd->TrackingSegments().Segments().size());
+		for ( const auto & segment : index ) {
+			// all tags are around (100,100)
+			EXPECT_FALSE(TagSpatialIndex::MayContain(segment,
+			                                         AABB(Eigen::Vector2d(2000,2000),Eigen::Vector2d(2200,2200)),
+			                                         {123,124}));
+			EXPECT_EQ(TagSpatialIndex::MayContain(segment,
+			                                      AABB(Eigen::Vector2d(0,0),Eigen::Vector2d(200,200)),
+			                                      {123,124}),
+			          segment.Tags.empty() == false);
+			EXPECT_FALSE(TagSpatialIndex::MayContain(segment,
+			                                         AABB(Eigen::Vector2d(0,0),Eigen::Vector2d(200,200)),
+			                                         {1}));
+		}
+	}
+}
+
 TEST_F(QueryUTest,InteractionFrame) {
 	ASSERT_NO_THROW({
 			auto a1 = experiment->CreateAnt(1);
@@ -231,6 +353,203 @@ TEST_F(QueryUTest,InteractionComputation) {
 }
 
 
+TEST_F(QueryUTest,InteractionSummaries) {
+	ASSERT_NO_THROW({
+			auto a1 = experiment->CreateAnt(1);
+			auto a2 = experiment->CreateAnt(2);
+			Identifier::AddIdentification(experiment->Identifier(),1,123,{},{});
+			Identifier::AddIdentification(experiment->Identifier(),2,124,{},{});
+			experiment->CreateAntShapeType("body",1);
+
+			for ( const auto & ant : {a1,a2} ) {
+				ant->AddCapsule(1,Capsule(Eigen::Vector2d(0,10),
+				                          Eigen::Vector2d(0,-10),
+				                          10,10));
+			}
+		});
+
+	std::vector<AntTrajectory::ConstPtr> trajectories;
+	std::vector<AntInteraction::ConstPtr> interactions;
+	std::vector<AntInteractionSummary> summaries,singleThreaded;
+	std::vector<Query::CollisionData> collisionData;
+	ASSERT_NO_THROW({
+			Query::ComputeAntInteractions(experiment,
+			                              [&trajectories]( const AntTrajectory::ConstPtr & t) {
+				                              trajectories.push_back(t);
+			                              },
+			                              [&interactions]( const AntInteraction::ConstPtr & i) {
+				                              interactions.push_back(i);
+			                              },
+			                              {},
+			                              {},
+			                              220 * Duration::Millisecond,
+			                              {});
+			Query::ComputeAntInteractionSummaries(experiment,
+			                                      [&summaries]( const AntInteractionSummary & s) {
+				                                      summaries.push_back(s);
+			                                      },
+			                                      {},
+			                                      {},
+			                                      220 * Duration::Millisecond,
+			                                      {},
+			                                      true);
+			Query::ComputeAntInteractionSummaries(experiment,
+			                                      [&singleThreaded]( const AntInteractionSummary & s) {
+				                                      singleThreaded.push_back(s);
+			                                      },
+			                                      {},
+			                                      {},
+			                                      220 * Duration::Millisecond,
+			                                      {},
+			                                      false,
+			                                      true);
+			Query::CollideFrames(experiment,
+			                     [&collisionData] (const Query::CollisionData & data) {
+				                     collisionData.push_back(data);
+			                     },
+			                     {},{});
+		});
+
+	auto byStart = [](const auto & a, const auto & b) {
+		               return a.Start.Before(b.Start);
+	               };
+	std::sort(interactions.begin(),interactions.end(),
+	          [&byStart](const AntInteraction::ConstPtr & a, const AntInteraction::ConstPtr & b) {
+		          return byStart(*a,*b);
+	          });
+	std::sort(summaries.begin(),summaries.end(),byStart);
+	std::sort(singleThreaded.begin(),singleThreaded.end(),byStart);
+
+	ASSERT_EQ(summaries.size(),interactions.size());
+	ASSERT_EQ(singleThreaded.size(),interactions.size());
+	for ( size_t i = 0; i < summaries.size(); ++i ) {
+		const auto & s = summaries[i];
+		const auto & expected = *interactions[i];
+		EXPECT_EQ(s.IDs,expected.IDs);
+		EXPECT_EQ(s.Space,expected.Space);
+		EXPECT_EQ(s.Start,expected.Start);
+		EXPECT_EQ(s.End,expected.End);
+		EXPECT_TRUE(s.Types == expected.Types);
+		EXPECT_EQ(singleThreaded[i].Start,expected.Start);
+		EXPECT_EQ(singleThreaded[i].End,expected.End);
+		EXPECT_EQ(singleThreaded[i].Frames,s.Frames);
+		EXPECT_TRUE(std::isnan(singleThreaded[i].MeanPositions.first.x()));
+
+		// recomputes the mean positions from the collision frames
+		size_t frames = 0;
+		Eigen::Vector2d first(0,0),second(0,0);
+		for ( const auto & [positions,collisions] : collisionData ) {
+			if ( positions->FrameTime.Before(s.Start) || s.End.Before(positions->FrameTime) ) {
+				continue;
+			}
+			bool colliding = false;
+			for ( const auto & c : collisions->Collisions ) {
+				colliding = colliding || c.IDs == s.IDs;
+			}
+			if ( colliding == false ) {
+				continue;
+			}
+			++frames;
+			for ( const auto & pa : positions->Positions ) {
+				if ( pa.ID == s.IDs.first ) {
+					first += pa.Position;
+				}
+				if ( pa.ID == s.IDs.second ) {
+					second += pa.Position;
+				}
+			}
+		}
+		ASSERT_EQ(s.Frames,frames);
+		EXPECT_NEAR(s.MeanPositions.first.x(),first.x() / frames,1.0e-6);
+		EXPECT_NEAR(s.MeanPositions.first.y(),first.y() / frames,1.0e-6);
+		EXPECT_NEAR(s.MeanPositions.second.x(),second.x() / frames,1.0e-6);
+		EXPECT_NEAR(s.MeanPositions.second.y(),second.y() / frames,1.0e-6);
+	}
+}
+
+TEST_F(QueryUTest,InteractionTypePushdown) {
+	ASSERT_NO_THROW({
+			auto a1 = experiment->CreateAnt(1);
+			auto a2 = experiment->CreateAnt(2);
+			Identifier::AddIdentification(experiment->Identifier(),1,123,{},{});
+			Identifier::AddIdentification(experiment->Identifier(),2,124,{},{});
+			experiment->CreateAntShapeType("head",1);
+			experiment->CreateAntShapeType("body",2);
+
+			for ( const auto & ant : {a1,a2} ) {
+				ant->AddCapsule(1,Capsule(Eigen::Vector2d(0,0),
+				                          Eigen::Vector2d(0,15),
+				                          10,10));
+				ant->AddCapsule(2,Capsule(Eigen::Vector2d(0,0),
+				                          Eigen::Vector2d(0,-15),
+				                          10,10));
+			}
+		});
+
+	std::vector<Query::CollisionData> collisionData;
+	ASSERT_NO_THROW({
+			Query::CollideFrames(experiment,
+			                     [&collisionData] (const Query::CollisionData & data) {
+				                     collisionData.push_back(data);
+			                     },
+			                     {},{});
+		});
+	auto solver = experiment->CompileCollisionSolver();
+
+	std::vector<Matcher::Ptr> matchers
+		= {
+		   // a matcher on a pair of types does not exclude other pairs
+		   Matcher::And({Matcher::InteractionType(1,2),
+		                 Matcher::InteractionType(1,1)}),
+		   // the Or needs (1,1) as there is no ant 42, but gives no filter
+		   Matcher::And({Matcher::InteractionType(1,2),
+		                 Matcher::Or({Matcher::AntIDMatcher(42),
+		                              Matcher::InteractionType(1,1)})}),
+	};
+
+	for ( const auto & matcher : matchers ) {
+		std::ostringstream oss;
+		oss << *matcher;
+		auto types = matcher->InteractionTypeFilter();
+		matcher->SetUpOnce(experiment->CIdentifier().CAnts());
+
+		size_t matched = 0;
+		for ( const auto & [identified,collided] : collisionData ) {
+			auto filtered = solver->ComputeCollisions(std::make_shared<IdentifiedFrame>(*identified),
+			                                          types.get());
+			matcher->SetUp(identified,filtered);
+			std::vector<InteractionID> expected,result;
+			for ( const auto & c : collided->Collisions ) {
+				if ( matcher->Match(c.IDs.first,c.IDs.second,c.Types) ) {
+					expected.push_back(c.IDs);
+				}
+			}
+			for ( const auto & c : filtered->Collisions ) {
+				if ( matcher->Match(c.IDs.first,c.IDs.second,c.Types) ) {
+					result.push_back(c.IDs);
+				}
+			}
+			EXPECT_EQ(result,expected) << "for " << oss.str();
+			matched += expected.size();
+		}
+		EXPECT_GT(matched,0) << "for " << oss.str();
+
+		std::vector<AntInteraction::ConstPtr> interactions;
+		ASSERT_NO_THROW({
+				Query::ComputeAntInteractions(experiment,
+				                              [](const AntTrajectory::ConstPtr &) {},
+				                              [&interactions]( const AntInteraction::ConstPtr & i) {
+					                              interactions.push_back(i);
+				                              },
+				                              {},
+				                              {},
+				                              220 * Duration::Millisecond,
+				                              matcher);
+			});
+		EXPECT_FALSE(interactions.empty()) << "for " << oss.str();
+	}
+}
+
 TEST_F(QueryUTest,FrameSelection) {
 	ASSERT_NO_THROW({
 			experiment->CreateAnt(1);
@@ -280,6 +599,808 @@ TEST_F(QueryUTest,FrameSelection) {
 
 }
 
+TEST_F(QueryUTest,ResampledTrajectories) {
+	ASSERT_NO_THROW({
+			experiment->CreateAnt(1);
+			Identifier::AddIdentification(experiment->Identifier(),1,123,{},{});
+		});
+	auto maximumGap = 20000 * Duration::Millisecond;
+
+	std::vector<AntTrajectory::ConstPtr> full,resampled,unfilled;
+	ASSERT_NO_THROW({
+			Query::ComputeTrajectories(experiment,
+			                           [&full]( const AntTrajectory::ConstPtr & t) {
+				                           full.push_back(t);
+			                           },
+			                           {},
+			                           {},
+			                           maximumGap);
+			Query::ComputeTrajectories(experiment,
+			                           [&resampled]( const AntTrajectory::ConstPtr & t) {
+				                           resampled.push_back(t);
+			                           },
+			                           {},
+			                           {},
+			                           maximumGap,
+			                           {},
+			                           true,
+			                           false,
+			                           250 * Duration::Millisecond);
+			// detections are 100ms apart, no gap can be filled
+			Query::ComputeTrajectories(experiment,
+			                           [&unfilled]( const AntTrajectory::ConstPtr & t) {
+				                           unfilled.push_back(t);
+			                           },
+			                           {},
+			                           {},
+			                           maximumGap,
+			                           {},
+			                           false,
+			                           false,
+			                           250 * Duration::Millisecond,
+			                           50 * Duration::Millisecond);
+		});
+
+	ASSERT_FALSE(full.empty());
+	ASSERT_EQ(resampled.size(),full.size());
+	ASSERT_FALSE(unfilled.empty());
+	ASSERT_LE(unfilled.size(),full.size());
+	for ( size_t i = 0; i < full.size(); ++i ) {
+		const auto & f = full[i]->Positions;
+		const auto & r = resampled[i]->Positions;
+		EXPECT_EQ(resampled[i]->Ant,full[i]->Ant);
+		EXPECT_TRUE(TimeEqual(resampled[i]->Start,full[i]->Start));
+		ASSERT_EQ(r.rows(),size_t(f(f.rows()-1,0) / 0.25) + 1);
+		ASSERT_EQ(resampled[i]->Zones.size(),r.rows());
+		size_t j = 0;
+		for ( size_t s = 0; s < r.rows(); ++s ) {
+			EXPECT_NEAR(r(s,0),0.25 * s,1.0e-9);
+			while ( j + 1 < f.rows() && f(j+1,0) < r(s,0) ) {
+				++j;
+			}
+			Eigen::Vector3d expected = f.block<1,3>(j,1).transpose();
+			if ( j + 1 < f.rows() ) {
+				double alpha = (r(s,0) - f(j,0)) / (f(j+1,0) - f(j,0));
+				expected += alpha * (f.block<1,3>(j+1,1).transpose() - expected);
+			}
+			for ( size_t c = 0; c < 3; ++c ) {
+				EXPECT_NEAR(r(s,c+1),expected(c),1.0e-6) << " at sample " << s;
+			}
+		}
+	}
+	for ( const auto & t : unfilled ) {
+		const auto & f = std::find_if(full.begin(),full.end(),
+		                              [&t](const AntTrajectory::ConstPtr & f) {
+			                              return TimeEqual(f->Start,t->Start);
+		                              })->get()->Positions;
+		for ( size_t s = 0; s < t->Positions.rows(); ++s ) {
+			// only samples on a detection are kept
+			EXPECT_NEAR((f.col(0).array() - t->Positions(s,0)).abs().minCoeff(),0.0,1.0e-9);
+		}
+		EXPECT_TRUE(t->Zones.empty());
+	}
+}
+
+TEST_F(QueryUTest,SimplifiedTrajectories) {
+	ASSERT_NO_THROW({
+			auto a1 = experiment->CreateAnt(1);
+			auto a2 = experiment->CreateAnt(2);
+			Identifier::AddIdentification(experiment->Identifier(),1,123,{},{});
+			Identifier::AddIdentification(experiment->Identifier(),2,124,{},{});
+			experiment->CreateAntShapeType("body",1);
+			for ( const auto & ant : {a1,a2} ) {
+				ant->AddCapsule(1,Capsule(Eigen::Vector2d(0,10),
+				                          Eigen::Vector2d(0,-10),
+				                          10,10));
+			}
+		});
+	auto maximumGap = 20000 * Duration::Millisecond;
+	const double tolerance = 2.0;
+
+	std::vector<AntTrajectory::ConstPtr> full,simplified,interactionTrajectories;
+	std::vector<AntInteraction::ConstPtr> interactions,simplifiedInteractions;
+	ASSERT_NO_THROW({
+			Query::ComputeTrajectories(experiment,
+			                           [&full]( const AntTrajectory::ConstPtr & t) {
+				                           full.push_back(t);
+			                           },
+			                           {},
+			                           {},
+			                           maximumGap,
+			                           {},
+			                           true);
+			Query::ComputeTrajectories(experiment,
+			                           [&simplified]( const AntTrajectory::ConstPtr & t) {
+				                           simplified.push_back(t);
+			                           },
+			                           {},
+			                           {},
+			                           maximumGap,
+			                           {},
+			                           true,
+			                           false,
+			                           0,
+			                           0,
+			                           tolerance,
+			                           0.1);
+			Query::ComputeAntInteractions(experiment,
+			                              [](const AntTrajectory::ConstPtr &) {},
+			                              [&interactions]( const AntInteraction::ConstPtr & i) {
+				                              interactions.push_back(i);
+			                              },
+			                              {},
+			                              {},
+			                              maximumGap,
+			                              {});
+			Query::ComputeAntInteractions(experiment,
+			                              [&interactionTrajectories](const AntTrajectory::ConstPtr & t) {
+				                              interactionTrajectories.push_back(t);
+			                              },
+			                              [&simplifiedInteractions]( const AntInteraction::ConstPtr & i) {
+				                              simplifiedInteractions.push_back(i);
+			                              },
+			                              {},
+			                              {},
+			                              maximumGap,
+			                              {},
+			                              false,
+			                              0.0,
+			                              tolerance,
+			                              0.1);
+		});
+
+	ASSERT_FALSE(full.empty());
+	ASSERT_EQ(simplified.size(),full.size());
+	size_t detections(0),points(0);
+	for ( size_t i = 0; i < full.size(); ++i ) {
+		const auto & f = *full[i];
+		const auto & s = *simplified[i];
+		EXPECT_EQ(s.Ant,f.Ant);
+		EXPECT_TRUE(TimeEqual(s.Start,f.Start));
+		EXPECT_EQ(f.Detections,f.Positions.rows());
+		EXPECT_EQ(f.MaximumError,0.0);
+		EXPECT_EQ(s.Detections,f.Positions.rows());
+		EXPECT_EQ(s.Zones.size(),s.Positions.rows());
+		ASSERT_GE(s.Positions.rows(),2);
+		EXPECT_TRUE(s.Positions.row(0) == f.Positions.row(0));
+		EXPECT_NEAR((s.Positions.bottomRows(1) - f.Positions.bottomRows(1)).norm(),0.0,1.0e-9);
+		EXPECT_LE(s.MaximumError,tolerance);
+		EXPECT_LE(s.MaximumAngularError,0.1);
+		detections += s.Detections;
+		points += s.Positions.rows();
+
+		// measures the error from the full resolution trajectory
+		double maxError(0.0);
+		size_t j = 0;
+		for ( size_t k = 0; k < f.Positions.rows(); ++k ) {
+			const double t = f.Positions(k,0);
+			while ( j + 2 < s.Positions.rows() && s.Positions(j+1,0) < t ) {
+				++j;
+			}
+			const double alpha = (t - s.Positions(j,0)) / (s.Positions(j+1,0) - s.Positions(j,0));
+			Eigen::Vector2d expected = s.Positions.block<1,2>(j,1).transpose()
+				+ alpha * (s.Positions.block<1,2>(j+1,1) - s.Positions.block<1,2>(j,1)).transpose();
+			maxError = std::max(maxError,(expected - f.Positions.block<1,2>(k,1).transpose()).norm());
+		}
+		EXPECT_NEAR(maxError,s.MaximumError,1.0e-6);
+	}
+	// ants moves on a circle, a 2 pixels tolerance still drops most points
+	EXPECT_LT(points * 2,detections);
+
+	ASSERT_EQ(simplifiedInteractions.size(),interactions.size());
+	for ( size_t i = 0; i < interactions.size(); ++i ) {
+		const auto & si = simplifiedInteractions[i];
+		EXPECT_EQ(si->IDs,interactions[i]->IDs);
+		EXPECT_TRUE(TimeEqual(si->Start,interactions[i]->Start));
+		EXPECT_TRUE(TimeEqual(si->End,interactions[i]->End));
+		for ( const auto & segment : {si->Trajectories.first,si->Trajectories.second} ) {
+			EXPECT_LE(segment.Begin,segment.End);
+			ASSERT_GE(segment.End,1);
+			ASSERT_LE(segment.End,segment.Trajectory->Positions.rows());
+			// the last detection of the interaction is kept
+			EXPECT_NEAR(segment.Trajectory->Positions(segment.End-1,0),
+			            si->End.Sub(segment.Trajectory->Start).Seconds(),
+			            1.0e-6);
+		}
+	}
+
+	EXPECT_THROW({
+			Query::ComputeTrajectories(experiment,
+			                           [](const AntTrajectory::ConstPtr &) {},
+			                           {},
+			                           {},
+			                           maximumGap,
+			                           {},
+			                           false,
+			                           false,
+			                           100 * Duration::Millisecond,
+			                           0,
+			                           tolerance);
+		},std::invalid_argument);
+}
+
+TEST_F(QueryUTest,TrajectoryKinematics) {
+	AntTrajectory t;
+	t.Positions.resize(5,4);
+	t.Positions <<
+		0.0, 0.0, 0.0, 3.0,
+		1.0, 3.0, 4.0, -3.0,
+		2.0, 3.0, 4.0, -3.0,
+		4.0, 3.0, 8.0, -2.0,
+		5.0, 3.0, 10.0, -2.0;
+	t.ComputeKinematics(0);
+	ASSERT_EQ(t.Kinematics.rows(),5);
+	for ( size_t c = 0; c < 4; ++c ) {
+		EXPECT_TRUE(std::isnan(t.Kinematics(0,c)));
+	}
+	Eigen::Vector4d speeds(5.0,0.0,2.0,2.0);
+	EXPECT_TRUE(t.Kinematics.block(1,0,4,1).isApprox(speeds));
+	EXPECT_TRUE(t.Kinematics.block(1,1,4,1).isApprox(speeds));
+	EXPECT_TRUE(std::isnan(t.Kinematics(1,2)));
+	EXPECT_DOUBLE_EQ(t.Kinematics(2,2),-5.0);
+	EXPECT_DOUBLE_EQ(t.Kinematics(3,2),1.0);
+	EXPECT_DOUBLE_EQ(t.Kinematics(4,2),0.0);
+	// turns on the shortest arc
+	EXPECT_NEAR(t.Kinematics(1,3),2 * M_PI - 6.0,1.0e-12);
+	EXPECT_DOUBLE_EQ(t.Kinematics(2,3),0.0);
+	EXPECT_DOUBLE_EQ(t.Kinematics(3,3),0.5);
+
+	t.ComputeKinematics(2 * Duration::Second);
+	EXPECT_DOUBLE_EQ(t.Kinematics(0,1),5.0);
+	EXPECT_DOUBLE_EQ(t.Kinematics(1,1),2.5);
+	EXPECT_DOUBLE_EQ(t.Kinematics(2,1),2.5);
+	EXPECT_DOUBLE_EQ(t.Kinematics(3,1),2.0);
+	EXPECT_DOUBLE_EQ(t.Kinematics(4,1),2.0);
+	EXPECT_DOUBLE_EQ(t.Kinematics(1,2),-2.5);
+
+	ASSERT_NO_THROW({
+			experiment->CreateAnt(1);
+			Identifier::AddIdentification(experiment->Identifier(),1,123,{},{});
+		});
+	std::vector<AntTrajectory::ConstPtr> trajectories;
+	ASSERT_NO_THROW({
+			Query::ComputeTrajectories(experiment,
+			                           [&trajectories]( const AntTrajectory::ConstPtr & t) {
+				                           trajectories.push_back(t);
+			                           },
+			                           {},
+			                           {},
+			                           20000 * Duration::Millisecond,
+			                           {},
+			                           false,
+			                           false,
+			                           0,
+			                           0,
+			                           0.0,
+			                           0.0,
+			                           true,
+			                           Duration::Second);
+		});
+	ASSERT_FALSE(trajectories.empty());
+	for ( const auto & t : trajectories ) {
+		ASSERT_EQ(t->Kinematics.rows(),t->Positions.rows());
+		AntTrajectory expected = *t;
+		expected.ComputeKinematics(Duration::Second);
+		for ( size_t i = 1; i < t->Kinematics.rows(); ++i ) {
+			const auto & p = t->Positions;
+			EXPECT_DOUBLE_EQ(t->Kinematics(i,0),
+			                 (p.block<1,2>(i,1) - p.block<1,2>(i-1,1)).norm() / (p(i,0) - p(i-1,0)));
+			EXPECT_DOUBLE_EQ(t->Kinematics(i,1),expected.Kinematics(i,1));
+			EXPECT_NEAR(t->Kinematics(i,3),0.0,1.0e-9);
+		}
+	}
+}
+
+TEST_F(QueryUTest,AntZoneSummaries) {
+	ASSERT_NO_THROW({
+			experiment->CreateAnt(1);
+			Identifier::AddIdentification(experiment->Identifier(),1,123,{},{});
+		});
+	auto maximumGap = 20000 * Duration::Millisecond;
+
+	std::vector<AntTrajectory::ConstPtr> trajectories;
+	std::vector<AntZoneSummary> summaries;
+	ASSERT_NO_THROW({
+			Query::ComputeTrajectories(experiment,
+			                           [&trajectories]( const AntTrajectory::ConstPtr & t) {
+				                           trajectories.push_back(t);
+			                           },
+			                           {},
+			                           {},
+			                           maximumGap);
+			Query::ComputeAntZoneSummaries(experiment,
+			                               [&summaries](const AntZoneSummary & s) {
+				                               summaries.push_back(s);
+			                               },
+			                               {},
+			                               {},
+			                               10 * Duration::Second,
+			                               maximumGap);
+		});
+
+	double expectedDwell(0.0),expectedPath(0.0);
+	for ( const auto & t : trajectories ) {
+		expectedDwell += t->Positions.bottomRows(1)(0,0);
+		for ( size_t i = 1; i < t->Positions.rows(); ++i ) {
+			expectedPath += (t->Positions.block<1,2>(i,1) - t->Positions.block<1,2>(i-1,1)).norm();
+		}
+	}
+
+	ASSERT_FALSE(summaries.empty());
+	double dwell(0.0),path(0.0);
+	size_t detections(0);
+	for ( size_t i = 0; i < summaries.size(); ++i ) {
+		const auto & s = summaries[i];
+		EXPECT_EQ(s.Ant,1);
+		EXPECT_EQ(s.Space,1);
+		EXPECT_EQ(s.Zone,0);
+		EXPECT_EQ(s.BinStart.Sub(Time()).Nanoseconds() % (10 * Duration::Second).Nanoseconds(),0);
+		if ( i > 0 ) {
+			EXPECT_TRUE(summaries[i-1].BinStart.Before(s.BinStart));
+		}
+		dwell += s.DwellTime;
+		path += s.PathLength;
+		detections += s.Detections;
+	}
+	EXPECT_EQ(detections,600);
+	EXPECT_NEAR(dwell,expectedDwell,1.0e-6);
+	EXPECT_NEAR(path,expectedPath,1.0e-6);
+
+	// bins shorter than the frame period split the intervals
+	const auto shortBin = 40 * Duration::Millisecond;
+	summaries.clear();
+	ASSERT_NO_THROW({
+			Query::ComputeAntZoneSummaries(experiment,
+			                               [&summaries](const AntZoneSummary & s) {
+				                               summaries.push_back(s);
+			                               },
+			                               {},
+			                               {},
+			                               shortBin,
+			                               maximumGap);
+		});
+	dwell = 0.0;
+	path = 0.0;
+	for ( const auto & s : summaries ) {
+		EXPECT_LE(s.DwellTime,shortBin.Seconds() + 1.0e-9);
+		dwell += s.DwellTime;
+		path += s.PathLength;
+	}
+	EXPECT_NEAR(dwell,expectedDwell,1.0e-6);
+	EXPECT_NEAR(path,expectedPath,1.0e-6);
+
+	EXPECT_THROW({
+			Query::ComputeAntZoneSummaries(experiment,
+			                               [](const AntZoneSummary &) {},
+			                               {},
+			                               {},
+			                               0,
+			                               maximumGap);
+		},std::invalid_argument);
+}
+
+TEST_F(QueryUTest,AntContactEdges) {
+	ASSERT_NO_THROW({
+			auto a1 = experiment->CreateAnt(1);
+			auto a2 = experiment->CreateAnt(2);
+			Identifier::AddIdentification(experiment->Identifier(),1,123,{},{});
+			Identifier::AddIdentification(experiment->Identifier(),2,124,{},{});
+			experiment->CreateAntShapeType("body",1);
+
+			for ( const auto & ant : {a1,a2} ) {
+				ant->AddCapsule(1,Capsule(Eigen::Vector2d(0,10),
+				                          Eigen::Vector2d(0,-10),
+				                          10,10));
+			}
+		});
+	auto maximumGap = 220 * Duration::Millisecond;
+
+	std::vector<AntInteraction::ConstPtr> interactions;
+	size_t collidingFrames(0);
+	std::vector<AntContactEdge> edges,typedEdges;
+	ASSERT_NO_THROW({
+			Query::ComputeAntInteractions(experiment,
+			                              [](const AntTrajectory::ConstPtr &) {},
+			                              [&interactions]( const AntInteraction::ConstPtr & i) {
+				                              interactions.push_back(i);
+			                              },
+			                              {},
+			                              {},
+			                              maximumGap,
+			                              {});
+			Query::CollideFrames(experiment,
+			                     [&collidingFrames](const Query::CollisionData & data) {
+				                     collidingFrames += std::get<1>(data)->Collisions.size();
+			                     },
+			                     {},
+			                     {});
+			Query::ComputeAntContactEdges(experiment,
+			                              [&edges](const AntContactEdge & e) {
+				                              edges.push_back(e);
+			                              },
+			                              {},
+			                              {},
+			                              Duration::Hour,
+			                              maximumGap);
+			Query::ComputeAntContactEdges(experiment,
+			                              [&typedEdges](const AntContactEdge & e) {
+				                              typedEdges.push_back(e);
+			                              },
+			                              {},
+			                              {},
+			                              Duration::Hour,
+			                              maximumGap,
+			                              {},
+			                              true);
+		});
+
+	double expectedDuration(0.0);
+	for ( const auto & i : interactions ) {
+		expectedDuration += i->End.Sub(i->Start).Seconds();
+	}
+
+	ASSERT_FALSE(edges.empty());
+	ASSERT_EQ(typedEdges.size(),edges.size());
+	size_t count(0),frames(0);
+	double duration(0.0);
+	for ( size_t i = 0; i < edges.size(); ++i ) {
+		const auto & e = edges[i];
+		EXPECT_EQ(e.IDs,InteractionID(1,2));
+		EXPECT_EQ(e.Types,std::make_pair(0U,0U));
+		EXPECT_EQ(typedEdges[i].Types,std::make_pair(1U,1U));
+		EXPECT_EQ(typedEdges[i].Count,e.Count);
+		EXPECT_EQ(typedEdges[i].Frames,e.Frames);
+		count += e.Count;
+		frames += e.Frames;
+		duration += e.TotalDuration;
+	}
+	// single frame contacts are not reported as interactions
+	EXPECT_GE(count,interactions.size());
+	EXPECT_EQ(frames,collidingFrames);
+	EXPECT_NEAR(duration,expectedDuration,1.0e-6);
+
+	// windows shorter than the frame period split the contacts
+	const auto shortWindow = 40 * Duration::Millisecond;
+	edges.clear();
+	ASSERT_NO_THROW({
+			Query::ComputeAntContactEdges(experiment,
+			                              [&edges](const AntContactEdge & e) {
+				                              edges.push_back(e);
+			                              },
+			                              {},
+			                              {},
+			                              shortWindow,
+			                              maximumGap);
+		});
+	duration = 0.0;
+	for ( const auto & e : edges ) {
+		EXPECT_LE(e.TotalDuration,shortWindow.Seconds() + 1.0e-9);
+		duration += e.TotalDuration;
+	}
+	EXPECT_NEAR(duration,expectedDuration,1.0e-6);
+}
+
+TEST_F(QueryUTest,FindNeighboursMatchesBruteForce) {
+	std::default_random_engine generator(42);
+	std::uniform_real_distribution<double> coordinate(0.0,1000.0);
+	IdentifiedFrame frame;
+	frame.Space = 1;
+	for ( AntID antID = 300; antID > 0; --antID ) {
+		frame.Positions.push_back({.Position = Eigen::Vector2d(coordinate(generator),coordinate(generator)),
+		                           .Angle = 0.0,
+		                           .ID = antID});
+	}
+	// a few ants on the same spot
+	for ( AntID antID = 301; antID < 305; ++antID ) {
+		frame.Positions.push_back({.Position = Eigen::Vector2d(500,500),
+		                           .Angle = 0.0,
+		                           .ID = antID});
+	}
+
+	typedef std::tuple<AntID,AntID,double> Relation;
+	auto bruteForce = [&frame](size_t k, double radius) {
+		                  std::vector<Relation> res;
+		                  std::map<AntID,std::vector<std::pair<double,AntID>>> byAnt;
+		                  for ( const auto & a : frame.Positions ) {
+			                  for ( const auto & b : frame.Positions ) {
+				                  double d = (a.Position - b.Position).norm();
+				                  if ( a.ID == b.ID || ( radius > 0.0 && d > radius ) ) {
+					                  continue;
+				                  }
+				                  byAnt[a.ID].push_back({d,b.ID});
+			                  }
+		                  }
+		                  for ( auto & [antID,neighbours] : byAnt ) {
+			                  std::sort(neighbours.begin(),neighbours.end());
+			                  for ( size_t i = 0; i < neighbours.size(); ++i ) {
+				                  if ( k > 0 && i >= k ) {
+					                  break;
+				                  }
+				                  if ( k == 0 && neighbours[i].second < antID ) {
+					                  continue;
+				                  }
+				                  res.push_back({antID,neighbours[i].second,neighbours[i].first});
+			                  }
+		                  }
+		                  if ( k == 0 ) {
+			                  std::sort(res.begin(),res.end());
+		                  }
+		                  return res;
+	                  };
+
+	for ( const auto & [k,radius] : std::vector<std::pair<size_t,double>>({{1,0.0},{5,0.0},{5,40.0},{0,50.0}}) ) {
+		auto expected = bruteForce(k,radius);
+		AntNeighbours::Ptr res;
+		ASSERT_NO_THROW(res = Query::FindNeighbours(frame,k,radius));
+		ASSERT_EQ(res->IDs.rows(),expected.size()) << " for k: " << k << " radius: " << radius;
+		ASSERT_EQ(res->Distances.size(),expected.size());
+		for ( size_t i = 0; i < expected.size(); ++i ) {
+			EXPECT_EQ(res->IDs(i,0),std::get<0>(expected[i])) << " for k: " << k << " radius: " << radius << " at " << i;
+			EXPECT_EQ(res->IDs(i,1),std::get<1>(expected[i])) << " for k: " << k << " radius: " << radius << " at " << i;
+			EXPECT_DOUBLE_EQ(res->Distances(i),std::get<2>(expected[i]));
+		}
+	}
+}
+
+TEST_F(QueryUTest,FindNeighboursBeyondTheBoundingBox) {
+	IdentifiedFrame frame;
+	frame.Space = 1;
+	frame.Positions.push_back({.Position = Eigen::Vector2d(0,0),.Angle = 0.0,.ID = 1});
+	frame.Positions.push_back({.Position = Eigen::Vector2d(10,10),.Angle = 0.0,.ID = 2});
+
+	// the ants are farther than the longest side of their bounding box
+	for ( size_t k : {1,3} ) {
+		auto res = Query::FindNeighbours(frame,k,0.0);
+		ASSERT_EQ(res->IDs.rows(),2);
+		EXPECT_EQ(res->IDs(0,0),1);
+		EXPECT_EQ(res->IDs(0,1),2);
+		EXPECT_EQ(res->IDs(1,0),2);
+		EXPECT_EQ(res->IDs(1,1),1);
+		EXPECT_NEAR(res->Distances(0),std::sqrt(200.0),1.0e-9);
+		EXPECT_NEAR(res->Distances(1),std::sqrt(200.0),1.0e-9);
+	}
+
+	EXPECT_EQ(Query::FindNeighbours(frame,1,15.0)->IDs.rows(),2);
+	EXPECT_EQ(Query::FindNeighbours(frame,1,12.0)->IDs.rows(),0);
+}
+
+TEST_F(QueryUTest,AntNeighbours) {
+	ASSERT_NO_THROW({
+			experiment->CreateAnt(1);
+			experiment->CreateAnt(2);
+			Identifier::AddIdentification(experiment->Identifier(),1,123,{},{});
+			Identifier::AddIdentification(experiment->Identifier(),2,124,{},{});
+		});
+	std::vector<IdentifiedFrame::ConstPtr> frames;
+	std::vector<AntNeighbours::ConstPtr> nearest,pairs;
+	ASSERT_NO_THROW({
+			Query::IdentifyFrames(experiment,
+			                      [&frames](const IdentifiedFrame::ConstPtr & f) {
+				                      frames.push_back(f);
+			                      },
+			                      {},
+			                      {});
+			Query::ComputeAntNeighbours(experiment,
+			                            [&nearest](const AntNeighbours::ConstPtr & n) {
+				                            nearest.push_back(n);
+			                            },
+			                            {},
+			                            {},
+			                            1,
+			                            0.0);
+			Query::ComputeAntNeighbours(experiment,
+			                            [&pairs](const AntNeighbours::ConstPtr & n) {
+				                            pairs.push_back(n);
+			                            },
+			                            {},
+			                            {},
+			                            0,
+			                            50.0);
+		});
+	ASSERT_FALSE(frames.empty());
+	ASSERT_EQ(nearest.size(),frames.size());
+	ASSERT_EQ(pairs.size(),frames.size());
+	for ( size_t i = 0; i < frames.size(); ++i ) {
+		const auto & f = frames[i];
+		EXPECT_TRUE(TimeEqual(nearest[i]->FrameTime,f->FrameTime));
+		EXPECT_EQ(nearest[i]->Space,f->Space);
+		ASSERT_EQ(f->Positions.size(),2);
+		double d = (f->Positions[0].Position - f->Positions[1].Position).norm();
+		ASSERT_EQ(nearest[i]->IDs.rows(),2);
+		EXPECT_EQ(nearest[i]->IDs(0,0),1);
+		EXPECT_EQ(nearest[i]->IDs(0,1),2);
+		EXPECT_EQ(nearest[i]->IDs(1,0),2);
+		EXPECT_EQ(nearest[i]->IDs(1,1),1);
+		EXPECT_DOUBLE_EQ(nearest[i]->Distances(0),d);
+		EXPECT_EQ(pairs[i]->IDs.rows(),d <= 50.0 ? 1 : 0);
+	}
+
+	EXPECT_THROW({
+			Query::ComputeAntNeighbours(experiment,
+			                            [](const AntNeighbours::ConstPtr &) {},
+			                            {},
+			                            {},
+			                            0,
+			                            0.0);
+		},std::invalid_argument);
+}
+
+TEST_F(QueryUTest,AntZoneTransitions) {
+	ASSERT_NO_THROW({
+			experiment->CreateAnt(1);
+			Identifier::AddIdentification(experiment->Identifier(),1,123,{},{});
+			auto right = experiment->Spaces().at(1)->CreateZone("right");
+			std::vector<Shape::ConstPtr> shapes = {std::make_shared<Polygon>(Vector2dList({{100,0},{1000,0},{1000,1000},{100,1000}}))};
+			right->AddDefinition(shapes,{},{});
+		});
+	auto maximumGap = 500 * Duration::Millisecond;
+
+	// naive diff of the zone of each detection
+	struct Last {
+		Time    FrameTime;
+		ZoneID  Zone;
+	};
+	std::map<AntID,Last> last;
+	std::vector<AntZoneTransition> expected,transitions,debounced,filtered;
+	ASSERT_NO_THROW({
+			Query::IdentifyFrames(experiment,
+			                      [&](const IdentifiedFrame::ConstPtr & frame) {
+				                      for ( size_t i = 0; i < frame->Positions.size(); ++i ) {
+					                      AntID antID = frame->Positions[i].ID;
+					                      ZoneID zone = frame->Zones[i];
+					                      auto fi = last.find(antID);
+					                      if ( fi != last.end()
+					                           && ( fi->second.FrameTime.HasMono() == false
+					                                || frame->FrameTime.HasMono() == false
+					                                || fi->second.FrameTime.MonoID() != frame->FrameTime.MonoID()
+					                                || frame->FrameTime.Sub(fi->second.FrameTime) > maximumGap ) ) {
+						                      expected.push_back({antID,1,fi->second.Zone,AntZoneTransition::UNDETECTED,fi->second.FrameTime});
+						                      last.erase(fi);
+						                      fi = last.end();
+					                      }
+					                      if ( fi == last.end() ) {
+						                      expected.push_back({antID,1,AntZoneTransition::UNDETECTED,zone,frame->FrameTime});
+					                      } else if ( fi->second.Zone != zone ) {
+						                      expected.push_back({antID,1,fi->second.Zone,zone,frame->FrameTime});
+					                      }
+					                      last[antID] = {frame->FrameTime,zone};
+				                      }
+			                      },
+			                      {},
+			                      {},
+			                      true,
+			                      true);
+			for ( const auto & [antID,l] : last ) {
+				expected.push_back({antID,1,l.Zone,AntZoneTransition::UNDETECTED,l.FrameTime});
+			}
+			Query::ComputeAntZoneTransitions(experiment,
+			                                 [&transitions](const AntZoneTransition & t) {
+				                                 transitions.push_back(t);
+			                                 },
+			                                 {},
+			                                 {},
+			                                 0,
+			                                 maximumGap);
+			// ant stays 5s in each zone
+			Query::ComputeAntZoneTransitions(experiment,
+			                                 [&debounced](const AntZoneTransition & t) {
+				                                 debounced.push_back(t);
+			                                 },
+			                                 {},
+			                                 {},
+			                                 6 * Duration::Second,
+			                                 maximumGap);
+			Query::ComputeAntZoneTransitions(experiment,
+			                                 [&filtered](const AntZoneTransition & t) {
+				                                 filtered.push_back(t);
+			                                 },
+			                                 {},
+			                                 {},
+			                                 0,
+			                                 maximumGap,
+			                                 Matcher::AntIDMatcher(2));
+		});
+
+	size_t changes(0);
+	for ( const auto & t : expected ) {
+		if ( t.From != AntZoneTransition::UNDETECTED && t.To != AntZoneTransition::UNDETECTED ) {
+			++changes;
+		}
+	}
+	EXPECT_GT(changes,0);
+	ASSERT_FALSE(expected.empty());
+	// the last stay is closed at the last detection
+	EXPECT_EQ(expected.back().To,AntZoneTransition::UNDETECTED);
+	ASSERT_EQ(transitions.size(),expected.size());
+	for ( size_t i = 0; i < expected.size(); ++i ) {
+		EXPECT_EQ(transitions[i].Ant,expected[i].Ant) << " at index " << i;
+		EXPECT_EQ(transitions[i].Space,expected[i].Space) << " at index " << i;
+		EXPECT_EQ(transitions[i].From,expected[i].From) << " at index " << i;
+		EXPECT_EQ(transitions[i].To,expected[i].To) << " at index " << i;
+		EXPECT_TRUE(TimeEqual(transitions[i].FrameTime,expected[i].FrameTime)) << " at index " << i;
+	}
+
+	// no stay is long enough to be confirmed
+	EXPECT_EQ(debounced.size(),expected.size() - changes);
+	for ( const auto & t : debounced ) {
+		EXPECT_TRUE(t.From == AntZoneTransition::UNDETECTED
+		            || t.To == AntZoneTransition::UNDETECTED);
+	}
+	EXPECT_TRUE(filtered.empty());
+}
+
+TEST_F(QueryUTest,AntOccupancyHeatmaps) {
+	ASSERT_NO_THROW({
+			experiment->AddAntMetadataColumn("group",AntMetadata::Type::STRING);
+			auto a1 = experiment->CreateAnt(1);
+			auto a2 = experiment->CreateAnt(2);
+			Identifier::AddIdentification(experiment->Identifier(),1,123,{},{});
+			Identifier::AddIdentification(experiment->Identifier(),2,124,{},{});
+			a1->SetValue("group",std::string("nurse"),Time::ConstPtr());
+			a2->SetValue("group",std::string("forager"),Time::ConstPtr());
+		});
+
+	std::map<AntID,uint32_t> expected;
+	ASSERT_NO_THROW({
+			Query::IdentifyFrames(experiment,
+			                      [&expected](const IdentifiedFrame::ConstPtr & f) {
+				                      const auto & frame = *f;
+				                      for ( const auto & pa : frame.Positions ) {
+					                      if ( pa.Position.x() >= 0 && pa.Position.y() >= 0 ) {
+						                      ++expected[pa.ID];
+					                      }
+				                      }
+			                      },
+			                      {},
+			                      {},
+			                      false);
+		});
+	ASSERT_EQ(expected.size(),2);
+
+	std::vector<AntOccupancyHeatmap::ConstPtr> all,allSingle,perAnt,perGroup;
+	auto collect = [](std::vector<AntOccupancyHeatmap::ConstPtr> & res) {
+		               return [&res](const AntOccupancyHeatmap::ConstPtr & h) {
+			                      res.push_back(h);
+		                      };
+	               };
+	ASSERT_NO_THROW({
+			Query::ComputeAntOccupancyHeatmaps(experiment,collect(all),{},{},50.0,0);
+			Query::ComputeAntOccupancyHeatmaps(experiment,collect(allSingle),{},{},50.0,0,false,"",true);
+			Query::ComputeAntOccupancyHeatmaps(experiment,collect(perAnt),{},{},50.0,10 * Duration::Second,true);
+			Query::ComputeAntOccupancyHeatmaps(experiment,collect(perGroup),{},{},50.0,0,false,"group");
+		});
+
+	ASSERT_EQ(all.size(),1);
+	ASSERT_EQ(allSingle.size(),1);
+	EXPECT_EQ(all[0]->Space,1);
+	EXPECT_EQ(all[0]->Ant,0);
+	EXPECT_EQ(all[0]->Detections.sum(),expected[1] + expected[2]);
+	EXPECT_TRUE(all[0]->Detections == allSingle[0]->Detections);
+	EXPECT_TRUE(all[0]->WindowStart.Equals(allSingle[0]->WindowStart));
+
+	std::map<AntID,uint32_t> perAntCounts;
+	for ( const auto & h : perAnt ) {
+		EXPECT_EQ(h->WindowStart.Sub(Time()).Nanoseconds() % (10 * Duration::Second).Nanoseconds(),0);
+		perAntCounts[h->Ant] += h->Detections.sum();
+	}
+	EXPECT_EQ(perAntCounts,expected);
+
+	ASSERT_EQ(perGroup.size(),2);
+	// groups are ordered by value
+	EXPECT_EQ(std::get<std::string>(perGroup[0]->Group),"forager");
+	EXPECT_EQ(perGroup[0]->Detections.sum(),expected[2]);
+	EXPECT_EQ(std::get<std::string>(perGroup[1]->Group),"nurse");
+	EXPECT_EQ(perGroup[1]->Detections.sum(),expected[1]);
+
+	EXPECT_THROW({
+			Query::ComputeAntOccupancyHeatmaps(experiment,
+			                                   [](const AntOccupancyHeatmap::ConstPtr &) {},
+			                                   {},
+			                                   {},
+			                                   0.0,
+			                                   0);
+		},std::invalid_argument);
+}
 
 } // namespace priv
 } // namespace myrmidon
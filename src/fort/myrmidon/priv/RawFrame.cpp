@@ -63,25 +63,23 @@ const FrameReference & RawFrame::Frame() const {
 
 IdentifiedFrame::Ptr RawFrame::IdentifyFrom(const IdentifierIF & identifier,SpaceID spaceID ) const {
 	auto res = std::make_shared<IdentifiedFrame>();
-	res->Space = spaceID;
-	res->FrameTime = Frame().Time();
-	res->Width = d_width;
-	res->Height = d_height;
-	res->Positions.reserve(d_tags.size());
-	Eigen::Vector2d position;
-	double angle;
-	for ( const auto & t : d_tags ) {
-		auto identification = identifier.Identify(t.id(),res->FrameTime);
-		if ( !identification ) {
-			continue;
-		}
-		identification->ComputePositionFromTag(position,angle,Eigen::Vector2d(t.x(),t.y()),t.theta());
-		res->Positions.push_back({position,angle,identification->Target()->AntID()});
-
-	}
+	IdentifyFrom(*res,identifier,spaceID);
 	return res;
 }
 
+void RawFrame::IdentifyFrom(IdentifiedFrame & result,
+                            const IdentifierIF & identifier,
+                            SpaceID spaceID,
+                            const AABB * tagRegion) const {
+	result.Space = spaceID;
+	result.FrameTime = Frame().Time();
+	result.Width = d_width;
+	result.Height = d_height;
+	result.Positions.clear();
+	result.Zones.clear();
+	identifier.IdentifyAnts(result.Positions,d_tags,result.FrameTime,tagRegion);
+}
+
 
 } //namespace priv
 } //namespace myrmidon
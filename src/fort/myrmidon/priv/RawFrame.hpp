@@ -53,6 +53,18 @@ public:
 
 	IdentifiedFrame::Ptr IdentifyFrom(const IdentifierIF & identifier,SpaceID spaceID) const;
 
+	// Identifies the frame in an existing IdentifiedFrame
+	// @result the frame to fill, its previous Positions and Zones are
+	//         discarded but their storage is reused.
+	// @identifier the identifier to use
+	// @spaceID the space of this frame
+	// @tagRegion if not nullptr, only the tags in this region are
+	//            identified.
+	void IdentifyFrom(IdentifiedFrame & result,
+	                  const IdentifierIF & identifier,
+	                  SpaceID spaceID,
+	                  const AABB * tagRegion = nullptr) const;
+
 	static RawFrame::ConstPtr Create(const std::string & parentURI,
 	                                 fort::hermes::FrameReadout & pb,
 	                                 Time::MonoclockID clockID);
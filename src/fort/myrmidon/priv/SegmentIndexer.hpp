@@ -3,6 +3,7 @@
 #include "../Time.hpp"
 #include "Types.hpp"
 #include "FrameReference.hpp"
+#include "TimeUtils.hpp"
 
 namespace fort {
 
@@ -38,6 +39,12 @@ public:
 
 	std::pair<FrameReference,T> Find(const Time & t) const;
 
+	// Freezes the index for faster lookups
+	//
+	// Copies the index in contiguous arrays, searched without
+	// branches. Any later <Insert> unfreezes the index.
+	void Freeze();
+
 private:
 	typedef std::shared_ptr<Segment> SegmentPtr;
 	class FrameComparator {
@@ -55,6 +62,11 @@ private:
 	std::map<FrameID,SegmentPtr,FrameComparator> d_byID;
 	std::map<Time,SegmentPtr,TimeComparator> d_byTime;
 
+	// Segments in increasing order, and their start FrameID and Time.
+	std::vector<Segment> d_frozen;
+	std::vector<FrameID> d_frozenIDs;
+	std::vector<Time>    d_frozenTimes;
+
 };
 
 
@@ -51,6 +51,10 @@ inline void SegmentIndexer<T>::Insert(const FrameReference & ref, const T & valu
 		throw std::invalid_argument(os.str());
 	}
 
+	d_frozen.clear();
+	d_frozenIDs.clear();
+	d_frozenTimes.clear();
+
 	auto toInsert = std::make_shared<SegmentIndexer<T>::Segment>(ref,value);
 
 	d_byID.insert(std::make_pair(ref.FrameID(),toInsert));
@@ -59,6 +63,9 @@ inline void SegmentIndexer<T>::Insert(const FrameReference & ref, const T & valu
 
 template <typename T>
 inline std::vector<typename SegmentIndexer<T>::Segment> SegmentIndexer<T>::Segments() const {
+	if ( d_frozen.empty() == false ) {
+		return d_frozen;
+	}
 	std::vector<Segment> res(d_byTime.size(),Segment(FrameReference("",0,Time()),T()));
 	std::vector<SegmentPtr> resPtr(d_byTime.size());
 	size_t i = res.size();
@@ -80,6 +87,15 @@ inline std::vector<typename SegmentIndexer<T>::Segment> SegmentIndexer<T>::Segme
 
 template <typename T>
 inline std::pair<FrameReference,T> SegmentIndexer<T>::Find(uint64_t frameID) const {
+	if ( d_frozen.empty() == false ) {
+		auto i = BranchlessUpperBound(d_frozenIDs.data(),d_frozenIDs.size(),frameID);
+		if ( i == 0 ) {
+			std::ostringstream os;
+			os << frameID << " is too small";
+			throw std::out_of_range(os.str());
+		}
+		return d_frozen[i-1];
+	}
 	auto fi = d_byID.lower_bound(frameID);
 	if ( fi == d_byID.end() ) {
 		std::ostringstream os;
@@ -91,6 +107,18 @@ inline std::pair<FrameReference,T> SegmentIndexer<T>::Find(uint64_t frameID) con
 
 template <typename T>
 inline std::pair<FrameReference,T> SegmentIndexer<T>::Find(const Time & t) const {
+	if ( d_frozen.empty() == false ) {
+		auto i = BranchlessUpperBound(d_frozenTimes.data(),d_frozenTimes.size(),t,
+		                              [](const Time & a, const Time & b) {
+			                              return a.Before(b);
+		                              });
+		if ( i == 0 ) {
+			std::ostringstream os;
+			os << t << " is too small";
+			throw std::out_of_range(os.str());
+		}
+		return d_frozen[i-1];
+	}
 	auto fi = d_byTime.lower_bound(t);
 	if ( fi == d_byTime.end() ) {
 		std::ostringstream os;
@@ -101,6 +129,18 @@ inline std::pair<FrameReference,T> SegmentIndexer<T>::Find(const Time & t) const
 	return *fi->second;
 }
 
+template <typename T>
+inline void SegmentIndexer<T>::Freeze() {
+	d_frozen = Segments();
+	d_frozenIDs.clear();
+	d_frozenTimes.clear();
+	d_frozenIDs.reserve(d_frozen.size());
+	d_frozenTimes.reserve(d_frozen.size());
+	for ( const auto & s : d_frozen ) {
+		d_frozenIDs.push_back(s.first.FrameID());
+		d_frozenTimes.push_back(s.first.Time());
+	}
+}
 
 } //namespace priv
 
@@ -23,17 +23,21 @@ void SegmentIndexerUTest::SetUp() {
 
 TEST_F(SegmentIndexerUTest,CanStoreAnIndex) {
 
+	for ( bool frozen : {false,true} ) {
+		if ( frozen == true ) {
+			d_si.Freeze();
+		}
+		std::vector<SegmentIndexer<std::string>::Segment> res;
+		EXPECT_NO_THROW({
+				res = d_si.Segments();
+			});
 
-	std::vector<SegmentIndexer<std::string>::Segment> res;
-	EXPECT_NO_THROW({
-			res = d_si.Segments();
-		});
-
-	ASSERT_EQ(res.size(),d_testdata.size());
-	for(size_t i =0 ; i < res.size(); ++i ){
-		EXPECT_EQ(res[i].first.FrameID(),d_testdata[i].first.FrameID()) << " for segment " << i;
-		EXPECT_TRUE(res[i].first.Time().Equals(d_testdata[i].first.Time())) << " for segment " << i;
-		EXPECT_EQ(res[i].second,d_testdata[i].second) << " for segment " << i;
+		ASSERT_EQ(res.size(),d_testdata.size());
+		for(size_t i =0 ; i < res.size(); ++i ){
+			EXPECT_EQ(res[i].first.FrameID(),d_testdata[i].first.FrameID()) << " for segment " << i << " frozen: " << frozen;
+			EXPECT_TRUE(res[i].first.Time().Equals(d_testdata[i].first.Time())) << " for segment " << i << " frozen: " << frozen;
+			EXPECT_EQ(res[i].second,d_testdata[i].second) << " for segment " << i << " frozen: " << frozen;
+		}
 	}
 
 }
@@ -54,25 +58,36 @@ TEST_F(SegmentIndexerUTest,CanFindSegment) {
 		   {1001,"9"},
 	};
 
-	for(const auto & d : data) {
-		std::pair<FrameReference,std::string> res;
-		EXPECT_NO_THROW({
-				res = d_si.Find(Time::FromTimeT(d.F));
-			});
-		EXPECT_EQ(res.second,d.Expected);
-		EXPECT_NO_THROW({
-				res = d_si.Find(d.F);
-			});
-		EXPECT_EQ(res.second,d.Expected);
+	for ( bool frozen : {false,true} ) {
+		if ( frozen == true ) {
+			d_si.Freeze();
+		}
+		for(const auto & d : data) {
+			std::pair<FrameReference,std::string> res;
+			EXPECT_NO_THROW({
+					res = d_si.Find(Time::FromTimeT(d.F));
+				});
+			EXPECT_EQ(res.second,d.Expected) << "frozen: " << frozen;
+			EXPECT_NO_THROW({
+					res = d_si.Find(d.F);
+				});
+			EXPECT_EQ(res.second,d.Expected) << "frozen: " << frozen;
+		}
+
+		EXPECT_THROW({
+				auto res = d_si.Find(0);
+			},std::out_of_range);
+
+		EXPECT_THROW({
+				auto res = d_si.Find(Time::FromTimeT(0));
+			},std::out_of_range);
 	}
 
-	EXPECT_THROW({
-			auto res = d_si.Find(0);
-		},std::out_of_range);
-
-	EXPECT_THROW({
-			auto res = d_si.Find(Time::FromTimeT(0));
-		},std::out_of_range);
+	// Insertion unfreezes the index
+	EXPECT_NO_THROW(d_si.Insert(FrameReference("",1001,Time::FromTimeT(1001)),"10"));
+	EXPECT_EQ(d_si.Find(1001).second,"10");
+	EXPECT_EQ(d_si.Find(Time::FromTimeT(1001)).second,"10");
+	EXPECT_EQ(d_si.Find(1000).second,"9");
 
 }
 
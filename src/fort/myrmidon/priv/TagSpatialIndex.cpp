@@ -0,0 +1,79 @@
+#include "TagSpatialIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <fort/hermes/FileContext.h>
+#include <fort/hermes/Error.h>
+
+namespace fort {
+namespace myrmidon {
+namespace priv {
+
+const double TagSpatialIndex::TILE_SIZE = 256.0;
+
+TagSpatialIndex::Tile TagSpatialIndex::TileOf(const Eigen::Vector2d & position) {
+	return std::make_pair(int32_t(std::floor(position.x() / TILE_SIZE)),
+	                      int32_t(std::floor(position.y() / TILE_SIZE)));
+}
+
+TagSpatialIndex::Segment TagSpatialIndex::Build(const std::string & hermesFile) {
+	Segment res;
+	hermes::FileContext file(hermesFile,false);
+	hermes::FrameReadout ro;
+	bool hasStart = false;
+	for (;;) {
+		try {
+			file.Read(&ro);
+		} catch ( const fort::hermes::EndOfFile & ) {
+			break;
+		} catch ( const std::exception & e ) {
+			throw std::runtime_error("Could not build spatial index for '"
+			                         + hermesFile + "':" + e.what());
+		}
+		if ( hasStart == false ) {
+			hasStart = true;
+			res.Start = ro.frameid();
+		}
+		for ( const auto & tag : ro.tags() ) {
+			auto & tags = res.Tags[TileOf(Eigen::Vector2d(tag.x(),tag.y()))];
+			auto fi = std::lower_bound(tags.begin(),tags.end(),tag.id());
+			if ( fi == tags.end() || *fi != tag.id() ) {
+				tags.insert(fi,tag.id());
+			}
+		}
+	}
+	if ( hasStart == false ) {
+		throw std::runtime_error("Could not build spatial index for '"
+		                         + hermesFile + "': no frame");
+	}
+	return res;
+}
+
+bool TagSpatialIndex::MayContain(const Segment & segment,
+                                 const AABB & region,
+                                 const std::vector<TagID> & tagIDs) {
+	if ( region.isEmpty() == true || tagIDs.empty() == true ) {
+		return false;
+	}
+	auto minTile = TileOf(region.min());
+	auto maxTile = TileOf(region.max());
+	for ( auto iter = segment.Tags.lower_bound(minTile);
+	      iter != segment.Tags.end() && iter->first.first <= maxTile.first;
+	      ++iter ) {
+		const auto & [tile,tags] = *iter;
+		if ( tile.second < minTile.second || tile.second > maxTile.second ) {
+			continue;
+		}
+		for ( const auto & tagID : tags ) {
+			if ( std::binary_search(tagIDs.begin(),tagIDs.end(),tagID) ) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+} // namespace priv
+} // namespace myrmidon
+} // namespace fort
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "Types.hpp"
+
+namespace fort {
+namespace myrmidon {
+namespace priv {
+
+// Indexes where tags are seen in tracking segments
+//
+// For each tracking segment of a <TrackingDataDirectory>, the image
+// is divided in square tiles of <TILE_SIZE> pixels, and the <TagID>
+// seen in each tile are recorded. Region queries use it to skip the
+// segments where none of their tags were ever located in the region.
+class TagSpatialIndex {
+public:
+	// Coordinates of a tile, in units of <TILE_SIZE>
+	typedef std::pair<int32_t,int32_t> Tile;
+
+	// The tags seen in a tracking segment
+	struct Segment {
+		// The first <FrameID> of the segment
+		FrameID                           Start;
+		// The sorted <TagID> seen in each non-empty tile
+		std::map<Tile,std::vector<TagID>> Tags;
+	};
+
+	// All segments of a <TrackingDataDirectory>, in frame order
+	typedef std::vector<Segment> BySegment;
+
+	// The side of a tile in pixels
+	const static double TILE_SIZE;
+
+	// Gets the tile of a position
+	// @position the position in the image
+	// @return the <Tile> containing position
+	static Tile TileOf(const Eigen::Vector2d & position);
+
+	// Indexes a tracking segment
+	// @hermesFile the path to the segment file
+	// @return the <Segment> for this file
+	static Segment Build(const std::string & hermesFile);
+
+	// Tells if any of some tags may be seen in a region
+	// @segment the <Segment> to look into
+	// @region the region in the image
+	// @tagIDs the sorted <TagID> to look for
+	// @return false if none of tagIDs was seen in the tiles
+	//         intersecting region.
+	static bool MayContain(const Segment & segment,
+	                       const AABB & region,
+	                       const std::vector<TagID> & tagIDs);
+};
+
+} // namespace priv
+} // namespace myrmidon
+} // namespace fort
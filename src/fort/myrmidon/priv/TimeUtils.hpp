@@ -3,6 +3,9 @@
 #include <fort/hermes/FrameReadout.pb.h>
 #include <fort/myrmidon/Time.hpp>
 
+#include <functional>
+#include <limits>
+
 
 namespace fort {
 namespace myrmidon {
@@ -16,6 +19,106 @@ Time TimeFromFrameReadout(const fort::hermes::FrameReadout & ro, Time::Monoclock
 	return Time::FromTimestampAndMonotonic(ro.time(),ro.timestamp() * 1000, monoID);
 }
 
+// Packs a Time::SortableKey in a single 64-bit integer
+// @key the key to pack
+//
+// The packed value is a number of nanoseconds since the epoch, so
+// ordering between keys is kept. Keys out of the representable
+// range (before 1678 or after 2262) saturate to the lowest or
+// highest value, which also represent -∞ and +∞.
+// @return an integer with the same ordering than key
+inline static
+int64_t PackSortKey(const Time::SortableKey & key) {
+	const static int64_t MAX_SECONDS = std::numeric_limits<int64_t>::max() / 1000000000LL - 1;
+	if ( key.first < -MAX_SECONDS ) {
+		return std::numeric_limits<int64_t>::min();
+	}
+	if ( key.first > MAX_SECONDS ) {
+		return std::numeric_limits<int64_t>::max();
+	}
+	return key.first * 1000000000LL + key.second;
+}
+
+// A compact timestamp for bulk per-frame data
+//
+// A PackedTime keeps only what is needed to order and differentiate
+// frames: the monotonic value and its clock, or, for Time without
+// monotonic value, the wall time in nanoseconds with NO_CLOCK. Two
+// PackedTime are comparable if they share the same Clock, and then
+// comparisons and differences are single integer operations with the
+// same result than Time::Before and Time::Sub.
+//
+// It takes 16 bytes and not 64 bits: monotonic values are full 64
+// bits nanoseconds counters, and the clock cannot be folded in them
+// without losing range or precision.
+struct PackedTime {
+	// Clock of Time without monotonic value.
+	const static uint32_t NO_CLOCK = 0xffffffff;
+
+	// Monotonic nanoseconds, or wall nanoseconds since the epoch if
+	// Clock is NO_CLOCK.
+	int64_t  Nanos;
+	// The Time::MonoID() of the source Time, or NO_CLOCK
+	uint32_t Clock;
+
+	// Packs a Time
+	// @t the Time to pack
+	// @return a PackedTime representing t
+	inline static PackedTime From(const Time & t) {
+		if ( t.HasMono() == false ) {
+			return {PackSortKey(t.SortKey()),NO_CLOCK};
+		}
+		return {int64_t(t.MonotonicValue()),t.MonoID()};
+	}
+
+	// Reports if a difference with another PackedTime is meaningful
+	// @other the other PackedTime
+	// @return true if other is on the same clock
+	inline bool SameClock(const PackedTime & other) const {
+		return Clock == other.Clock;
+	}
+
+	// Computes the time elapsed since another PackedTime
+	// @other the PackedTime to substract, on the same clock
+	// @return the difference in nanoseconds
+	inline int64_t Sub(const PackedTime & other) const {
+		return Nanos - other.Nanos;
+	}
+
+	// Reports if this PackedTime is strictly before another
+	// @other the PackedTime to compare to, on the same clock
+	// @return true if this is strictly before other
+	inline bool Before(const PackedTime & other) const {
+		return Nanos < other.Nanos;
+	}
+};
+
+// Finds the first element greater than a value in a sorted array
+// @data the sorted array
+// @size the size of data
+// @value the value to look for
+// @comp the comparison used to sort data
+//
+// Same as std::upper_bound, but the search loop is written so the
+// compiler can use conditional moves instead of unpredictable
+// branches.
+// @return the index of the first element greater than value, or size
+template <typename T, typename Compare = std::less<T>>
+inline static
+size_t BranchlessUpperBound(const T * data, size_t size, const T & value,
+                            Compare comp = Compare()) {
+	if ( size == 0 ) {
+		return 0;
+	}
+	const T * base = data;
+	while ( size > 1 ) {
+		size_t half = size / 2;
+		base = comp(value,base[half]) ? base : base + half;
+		size -= half;
+	}
+	return (base - data) + (comp(value,*base) ? 0 : 1);
+}
+
 
 } //namespace priv
 } //namespace myrmidon
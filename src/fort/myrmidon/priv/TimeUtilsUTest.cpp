@@ -2,6 +2,8 @@
 
 #include "TimeUtils.hpp"
 
+#include <algorithm>
+
 namespace fort {
 namespace myrmidon {
 namespace priv {
@@ -32,6 +34,67 @@ TEST_F(TimeUtilsUTest,TimeConversion) {
 
 }
 
+TEST_F(TimeUtilsUTest,PackedKeysAreOrdered) {
+	std::vector<Time::SortableKey> keys
+		= {
+		   Time::SortKey(Time::ConstPtr()),
+		   Time::FromTimeT(-1).SortKey(),
+		   Time().SortKey(),
+		   Time().Add(1).SortKey(),
+		   Time::FromTimeT(1).SortKey(),
+		   Time::FromTimeT(1).Add(999999999).SortKey(),
+		   Time::Parse("2019-11-02T22:02:24.674Z").SortKey(),
+		   std::make_pair(std::numeric_limits<int64_t>::max(),
+		                  std::numeric_limits<int32_t>::max()),
+	};
+	for ( size_t i = 1; i < keys.size(); ++i ) {
+		EXPECT_LT(PackSortKey(keys[i-1]),PackSortKey(keys[i])) << " for key " << i;
+	}
+}
+
+TEST_F(TimeUtilsUTest,PackedTimeMatchesTime) {
+	google::protobuf::Timestamp ts;
+	ts.set_seconds(1000);
+	std::vector<Time> times
+		= {
+		   Time::FromTimeT(1000),
+		   Time::FromTimeT(1000).Add(1),
+		   Time::FromTimeT(1002).Add(-3),
+		   Time::FromTimestampAndMonotonic(ts,2000,1),
+		   Time::FromTimestampAndMonotonic(ts,1500,1),
+		   Time::FromTimestampAndMonotonic(ts,4000000000ULL,1),
+		   Time::FromTimestampAndMonotonic(ts,1500,2),
+	};
+	for ( const auto & a : times ) {
+		auto pa = PackedTime::From(a);
+		for ( const auto & b : times ) {
+			auto pb = PackedTime::From(b);
+			EXPECT_EQ(pa.SameClock(pb),a.HasMono() == b.HasMono()
+			          && (a.HasMono() == false || a.MonoID() == b.MonoID()));
+			if ( pa.SameClock(pb) == false ) {
+				continue;
+			}
+			EXPECT_EQ(pa.Sub(pb),a.Sub(b).Nanoseconds());
+			EXPECT_EQ(pa.Before(pb),a.Before(b));
+		}
+	}
+}
+
+TEST_F(TimeUtilsUTest,BranchlessUpperBound) {
+	for ( size_t size = 0; size < 20; ++size ) {
+		std::vector<int> data;
+		for ( size_t i = 0; i < size; ++i ) {
+			// some duplicated values
+			data.push_back(2 * (i / 2) + 1);
+		}
+		for ( int v = -1; v < int(2 * size + 2); ++v ) {
+			EXPECT_EQ(BranchlessUpperBound(data.data(),data.size(),v),
+			          std::upper_bound(data.begin(),data.end(),v) - data.begin())
+				<< " for size " << size << " and value " << v;
+		}
+	}
+}
+
 } //namespace priv
 } //namespace myrmidon
 } //namespace fort
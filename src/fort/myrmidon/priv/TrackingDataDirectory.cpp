@@ -22,6 +22,7 @@
 #include <fort/myrmidon/priv/proto/TDDCache.hpp>
 #include <fort/myrmidon/priv/proto/TagStatisticsCache.hpp>
 #include <fort/myrmidon/priv/proto/TagCloseUpCache.hpp>
+#include <fort/myrmidon/priv/proto/TagSpatialIndexCache.hpp>
 
 #include "TagCloseUp.hpp"
 #include "TimeUtils.hpp"
@@ -107,6 +108,9 @@ TrackingDataDirectory::TrackingDataDirectory(const std::string & uri,
 		d_frameIDByTime.insert(std::make_pair(ref.Time().SortKey(),frameID));
 	}
 
+	// indexes are complete, and only queried from now on
+	d_segments->Freeze();
+	d_movies->Freeze();
 }
 
 
@@ -736,6 +740,14 @@ TrackingDataDirectory::TagStatistics() const {
 	return *d_tagStatistics;
 }
 
+const TagSpatialIndex::BySegment &
+TrackingDataDirectory::SpatialIndex() const {
+	if ( SpatialIndexComputed() == false ) {
+		throw ComputedRessourceUnavailable("SpatialIndex");
+	}
+	return *d_spatialIndex;
+}
+
 
 bool TrackingDataDirectory::TagCloseUpsComputed() const {
 	return !d_tagCloseUps == false;
@@ -749,6 +761,10 @@ bool TrackingDataDirectory::FullFramesComputed() const {
 	return !d_fullFrames == false;
 }
 
+bool TrackingDataDirectory::SpatialIndexComputed() const {
+	return !d_spatialIndex == false;
+}
+
 class TagCloseUpsReducer {
 public:
 	TagCloseUpsReducer(size_t count,
@@ -929,6 +945,50 @@ TrackingDataDirectory::PrepareTagStatisticsLoaders() {
 }
 
 
+class SpatialIndexReducer {
+public:
+	SpatialIndexReducer(size_t count,
+	                    const TrackingDataDirectory::Ptr & tdd)
+		: d_tdd(tdd)
+		, d_segments(count) {
+		d_count.store(count);
+	}
+
+	void Reduce(size_t index,
+	            const TagSpatialIndex::Segment & segment) {
+		d_segments[index] = segment;
+		if ( (d_count.fetch_sub(1) - 1 ) > 0 ) {
+			return;
+		}
+		d_tdd->d_spatialIndex = std::make_shared<TagSpatialIndex::BySegment>(std::move(d_segments));
+		proto::TagSpatialIndexCache::Save(d_tdd->AbsoluteFilePath(),*d_tdd->d_spatialIndex);
+	}
+private:
+	std::atomic<size_t>        d_count;
+	TrackingDataDirectory::Ptr d_tdd;
+	TagSpatialIndex::BySegment d_segments;
+};
+
+std::vector<TrackingDataDirectory::Loader>
+TrackingDataDirectory::PrepareSpatialIndexLoaders() {
+	const auto & segments = d_segments->Segments();
+	auto reducer = std::make_shared<SpatialIndexReducer>(segments.size(),
+	                                                     Itself());
+
+	std::vector<Loader> res;
+	res.reserve(segments.size());
+	size_t i = 0;
+	for ( const auto & s : segments ) {
+		res.push_back([reducer,s,i,this]() {
+			              auto segment = TagSpatialIndex::Build((AbsoluteFilePath()/ s.second).string());
+			              reducer->Reduce(i,segment);
+		              });
+		++i;
+	}
+	return res;
+}
+
+
 class FullFramesReducer {
 public :
 	FullFramesReducer(size_t count,
@@ -980,6 +1040,15 @@ void TrackingDataDirectory::LoadComputedFromCache() {
 		d_tagStatistics = std::make_shared<TagStatisticsHelper::Timed>(proto::TagStatisticsCache::Load(AbsoluteFilePath()));
 	} catch (const std::exception & e) {}
 
+	try {
+		d_spatialIndex = std::make_shared<TagSpatialIndex::BySegment>(proto::TagSpatialIndexCache::Load(AbsoluteFilePath()));
+		if ( d_spatialIndex->size() != d_segments->Segments().size() ) {
+			d_spatialIndex.reset();
+		}
+	} catch (const std::exception & e) {
+		d_spatialIndex.reset();
+	}
+
 	try {
 		d_tagCloseUps = std::make_shared<std::vector<TagCloseUp::ConstPtr>>();
 		*d_tagCloseUps = proto::TagCloseUpCache::Load(AbsoluteFilePath(),
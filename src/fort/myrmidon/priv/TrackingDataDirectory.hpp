@@ -16,6 +16,7 @@
 #include "FrameReference.hpp"
 #include "TagCloseUp.hpp"
 #include "TagStatistics.hpp"
+#include "TagSpatialIndex.hpp"
 
 
 namespace fort {
@@ -184,17 +185,20 @@ public:
 	const std::vector<TagCloseUp::ConstPtr> & TagCloseUps() const;
 	const std::map<FrameReference,fs::path> & FullFrames() const;
 	const TagStatisticsHelper::Timed & TagStatistics() const;
+	const TagSpatialIndex::BySegment & SpatialIndex() const;
 
 
 	bool TagCloseUpsComputed() const;
 	bool TagStatisticsComputed() const;
 	bool FullFramesComputed() const;
+	bool SpatialIndexComputed() const;
 
 	typedef std::function<void()> Loader;
 
 	std::vector<Loader> PrepareTagCloseUpsLoaders();
 	std::vector<Loader> PrepareTagStatisticsLoaders();
 	std::vector<Loader> PrepareFullFramesLoaders();
+	std::vector<Loader> PrepareSpatialIndexLoaders();
 
 	const tags::ApriltagOptions & DetectionSettings() const;
 
@@ -206,6 +210,7 @@ private:
 	friend class FullFramesReducer;
 	friend class TagCloseUpsReducer;
 	friend class TagStatisticsReducer;
+	friend class SpatialIndexReducer;
 
 
 
@@ -285,6 +290,7 @@ private:
 	std::shared_ptr<std::vector<TagCloseUp::ConstPtr>> d_tagCloseUps;
 	std::shared_ptr<std::map<FrameReference,fs::path>> d_fullFrames;
 	std::shared_ptr<TagStatisticsHelper::Timed>        d_tagStatistics;
+	std::shared_ptr<TagSpatialIndex::BySegment>        d_spatialIndex;
 
 
 };
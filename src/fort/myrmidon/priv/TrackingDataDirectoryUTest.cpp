@@ -320,6 +320,46 @@ TEST_F(TrackingDataDirectoryUTest,ComputesAndCacheTagStatistics) {
 
 }
 
+TEST_F(TrackingDataDirectoryUTest,ComputesAndCacheSpatialIndex) {
+	TrackingDataDirectory::Ptr tdd;
+	ASSERT_NO_THROW({
+			tdd = TrackingDataDirectory::Open(TestSetup::Basedir() / "computed-cache-test.0000",TestSetup::Basedir());
+		});
+
+	EXPECT_FALSE(tdd->SpatialIndexComputed());
+	EXPECT_THROW({
+			tdd->SpatialIndex();
+		},TrackingDataDirectory::ComputedRessourceUnavailable);
+
+	TagSpatialIndex::BySegment computed,cached;
+	try {
+		auto loaders = tdd->PrepareSpatialIndexLoaders();
+		EXPECT_EQ(loaders.size(),2);
+		for ( const auto & l : loaders ) {
+			l();
+		}
+
+		EXPECT_TRUE(tdd->SpatialIndexComputed());
+		computed = tdd->SpatialIndex();
+	} catch ( const std::exception & e) {
+		ADD_FAILURE() << "Computation should not throw this excption: " << e.what();
+	}
+
+	tdd.reset();
+	ASSERT_NO_THROW({
+			tdd = TrackingDataDirectory::Open(TestSetup::Basedir() / "computed-cache-test.0000",TestSetup::Basedir());
+			cached = tdd->SpatialIndex();
+		});
+	EXPECT_TRUE(tdd->SpatialIndexComputed());
+	ASSERT_EQ(cached.size(),computed.size());
+	const auto & segments = tdd->TrackingSegments().Segments();
+	for ( size_t i = 0; i < cached.size(); ++i ) {
+		EXPECT_EQ(computed[i].Start,segments[i].first.FrameID());
+		EXPECT_EQ(cached[i].Start,computed[i].Start);
+		EXPECT_TRUE(cached[i].Tags == computed[i].Tags);
+	}
+}
+
 TEST_F(TrackingDataDirectoryUTest,ComputesAndCacheFullFrames) {
 	TrackingDataDirectory::Ptr tdd;
 	ASSERT_NO_THROW({
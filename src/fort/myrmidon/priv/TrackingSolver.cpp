@@ -21,17 +21,7 @@ IdentifiedFrame::Ptr TrackingSolver::IdentifyFrame(const fort::hermes::FrameRead
 	res->FrameTime = Time::FromTimestamp(frame.time());
 	res->Width = frame.width();
 	res->Height = frame.height();
-	res->Positions.reserve(frame.tags().size());
-	Eigen::Vector2d position;
-	double angle;
-	for ( const auto & t : frame.tags() ) {
-		auto identification = d_identifier->Identify(t.id(),res->FrameTime);
-		if ( !identification == true ) {
-			continue;
-		}
-		identification->ComputePositionFromTag(position,angle,Eigen::Vector2d(t.x(),t.y()),t.theta());
-		res->Positions.push_back({position,angle,identification->Target()->AntID()});
-	}
+	d_identifier->IdentifyAnts(res->Positions,frame.tags(),res->FrameTime);
 	return res;
 }
 
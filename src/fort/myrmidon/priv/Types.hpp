@@ -8,6 +8,7 @@
 #include <variant>
 #include <string>
 
+#include <set>
 #include <unordered_map>
 #include <vector>
 
@@ -36,6 +37,9 @@ typedef std::pair<Time::ConstPtr,AntStaticValue>   AntTimedValue;
 typedef std::unordered_map<std::string,std::vector<AntTimedValue> > AntDataMap;
 typedef std::unordered_map<std::string,const std::vector<AntTimedValue> > AntConstDataMap;
 
+// A set of pairs of AntShapeTypeID, each pair is ordered with first <= second
+typedef std::set<std::pair<AntShapeTypeID,AntShapeTypeID>> InteractionTypeSet;
+
 
 
 
@@ -61,8 +61,13 @@ Experiment::Ptr ExperimentReadWriter::DoOpen(const fs::path & filename, bool dat
 		                 }
 	                 });
 
-	for ( const auto & m : measurements ) {
-		res->SetMeasurement(m);
+	{
+		// ant poses are computed once all measurements are set
+		Identifier::PoseEditScope poseEdits(*res->Identifier());
+		for ( const auto & m : measurements ) {
+			res->SetMeasurement(m);
+		}
+		poseEdits.Commit();
 	}
 
 	return res;
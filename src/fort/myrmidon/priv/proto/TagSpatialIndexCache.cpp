@@ -0,0 +1,80 @@
+#include "TagSpatialIndexCache.hpp"
+
+
+namespace fort {
+namespace myrmidon {
+namespace priv {
+namespace proto {
+
+
+const uint32_t TagSpatialIndexCache::CACHE_VERSION = 1;
+
+const std::string TagSpatialIndexCache::CACHE_PATH = "tags_spatial_index.cache";
+
+static TagSpatialIndex::Segment LoadSegment(const pb::TagSpatialIndexSegment & pb) {
+	TagSpatialIndex::Segment res;
+	res.Start = pb.start();
+	for ( const auto & pbTile : pb.tiles() ) {
+		auto & tags = res.Tags[std::make_pair(pbTile.x(),pbTile.y())];
+		tags.assign(pbTile.tagids().begin(),pbTile.tagids().end());
+	}
+	return res;
+}
+
+static void SaveSegment(pb::TagSpatialIndexSegment * pb, const TagSpatialIndex::Segment & segment) {
+	pb->set_start(segment.Start);
+	for ( const auto & [tile,tags] : segment.Tags ) {
+		auto pbTile = pb->add_tiles();
+		pbTile->set_x(tile.first);
+		pbTile->set_y(tile.second);
+		for ( const auto & tagID : tags ) {
+			pbTile->add_tagids(tagID);
+		}
+	}
+}
+
+
+TagSpatialIndex::BySegment
+TagSpatialIndexCache::Load(const fs::path & tddAbsolutePath) {
+	TagSpatialIndex::BySegment res;
+	ReadWriter::Read(tddAbsolutePath / CACHE_PATH ,
+	                 [](const pb::TagSpatialIndexCacheHeader & pb) {
+		                 if ( pb.version() != CACHE_VERSION) {
+			                 throw std::runtime_error("Mismatched cache version "
+			                                          + std::to_string(pb.version())
+			                                          + " (expected:"
+			                                          + std::to_string(CACHE_VERSION));
+		                 }
+		                 if ( pb.tilesize() != TagSpatialIndex::TILE_SIZE ) {
+			                 throw std::runtime_error("Mismatched tile size "
+			                                          + std::to_string(pb.tilesize())
+			                                          + " (expected:"
+			                                          + std::to_string(TagSpatialIndex::TILE_SIZE));
+		                 }
+	                 },
+	                 [&res] ( const pb::TagSpatialIndexSegment & pb) {
+		                 res.push_back(LoadSegment(pb));
+	                 });
+	return res;
+}
+
+void TagSpatialIndexCache::Save(const fs::path & tddAbsolutePath,
+                                const TagSpatialIndex::BySegment & index) {
+	pb::TagSpatialIndexCacheHeader h;
+	h.set_version(CACHE_VERSION);
+	h.set_tilesize(TagSpatialIndex::TILE_SIZE);
+	std::vector<ReadWriter::LineWriter> lines;
+	for ( const auto & segment : index ) {
+		lines.push_back([segment = std::ref(segment)](pb::TagSpatialIndexSegment & line) {
+			                SaveSegment(&line,segment);
+		                });
+	}
+	ReadWriter::Write(tddAbsolutePath / CACHE_PATH,
+	                  h,
+	                  lines);
+}
+
+} //namespace proto
+} //namespace priv
+} //namespace myrmidon
+} //namespace fort
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "FileReadWriter.hpp"
+
+#include <fort/myrmidon/priv/TagSpatialIndex.hpp>
+#include <fort/myrmidon/TagSpatialIndexCache.pb.h>
+
+namespace fort {
+namespace myrmidon {
+namespace priv {
+namespace proto {
+
+class TagSpatialIndexCache {
+public:
+	typedef FileReadWriter<pb::TagSpatialIndexCacheHeader,pb::TagSpatialIndexSegment> ReadWriter;
+	static TagSpatialIndex::BySegment Load(const fs::path & tddAbsolutePath);
+
+	static void Save(const fs::path & tddAbsolutePath,const TagSpatialIndex::BySegment & index);
+
+	const static std::string CACHE_PATH;
+
+	const static uint32_t CACHE_VERSION;
+};
+
+
+} //namespace proto
+} //namespace priv
+} //namespace myrmidon
+} //namespace fort
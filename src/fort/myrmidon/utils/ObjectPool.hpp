@@ -1,41 +1,105 @@
 #pragma once
 
 #include <tbb/concurrent_queue.h>
+#include <tbb/enumerable_thread_specific.h>
 #include <memory>
+#include <vector>
+#include <iterator>
+#include <algorithm>
 
 namespace fort {
 namespace myrmidon {
 namespace utils {
 
+// A pool of reusable objects
+//
+// Get() returns a std::shared_ptr whose deleter gives the object
+// back to the pool instead of destroying it. Each thread keeps its
+// own free list, so getting and returning objects does not contend
+// with other threads. When a thread holds more than two batches of
+// free objects, one batch is handed to a shared queue other threads
+// refill from.
+//
+// Objects keep the pool storage alive, so they can safely outlive
+// the ObjectPool they were taken from. Copies of an ObjectPool share
+// the same storage.
 template<typename T>
 class ObjectPool {
 public:
-	ObjectPool()
-		: d_pool(std::make_shared<tbb::concurrent_bounded_queue<TPtr>>()) {
+	// Constructor
+	// @batchSize the number of objects moved at once between a
+	//            thread free list and the shared queue.
+	ObjectPool(size_t batchSize = 32)
+		: d_storage(std::make_shared<Storage>(std::max(batchSize,size_t(1)))) {
 	}
 
 	template<class ...Us> void Reserve(size_t N, Us... args) {
-		std::vector<TPtr> reserved;
+		std::vector<TPtr> batch;
 		for ( size_t i = 0; i < N; ++i ) {
-			reserved.push_back(Get(args...));
+			batch.push_back(std::make_shared<T>(args...));
+			if ( batch.size() == d_storage->BatchSize ) {
+				d_storage->Shared.push(std::move(batch));
+				batch = std::vector<TPtr>();
+			}
+		}
+		if ( batch.empty() == false ) {
+			d_storage->Shared.push(std::move(batch));
 		}
 	}
 
 	template<class ...Us> std::shared_ptr<T> Get(Us... args) {
-		std::shared_ptr<T> obj;
-		if ( d_pool->try_pop(obj) == false ) {
+		auto & local = d_storage->Local.local();
+		if ( local.empty() ) {
+			d_storage->Shared.try_pop(local);
+		}
+		TPtr obj;
+		if ( local.empty() ) {
 			obj = std::make_shared<T>(args...);
+		} else {
+			obj = std::move(local.back());
+			local.pop_back();
 		}
-		return TPtr(obj.get(),
-		            [this,obj](T*){
-			            d_pool->push(obj);
-		            });
+		T * ptr = obj.get();
+		return TPtr(ptr,Recycler{d_storage,std::move(obj)});
 	}
 
 private:
 	typedef std::shared_ptr<T> TPtr;
 
-	std::shared_ptr<tbb::concurrent_bounded_queue<TPtr>> d_pool;
+	struct Storage {
+		Storage(size_t batchSize)
+			: BatchSize(batchSize) {
+		}
+
+		void Release(TPtr && obj) {
+			auto & local = Local.local();
+			local.push_back(std::move(obj));
+			if ( local.size() < 2 * BatchSize ) {
+				return;
+			}
+			std::vector<TPtr> batch(std::make_move_iterator(local.end() - BatchSize),
+			                        std::make_move_iterator(local.end()));
+			local.resize(local.size() - BatchSize);
+			Shared.push(std::move(batch));
+		}
+
+		const size_t                                            BatchSize;
+		tbb::enumerable_thread_specific<std::vector<TPtr>>      Local;
+		tbb::concurrent_queue<std::vector<TPtr>>                Shared;
+	};
+
+	// Deleter of the returned objects. It holds the storage, so
+	// the storage outlives any object in use.
+	struct Recycler {
+		std::shared_ptr<Storage> Pool;
+		TPtr                     Object;
+
+		void operator()(T *) {
+			Pool->Release(std::move(Object));
+		}
+	};
+
+	std::shared_ptr<Storage> d_storage;
 };
 
 } // namespace utils
@@ -2,6 +2,8 @@
 
 #include "ObjectPool.hpp"
 
+#include <thread>
+
 
 namespace fort {
 namespace myrmidon {
@@ -76,6 +78,48 @@ TEST_F(ObjectPoolUTest,IsCopyable) {
 
 }
 
+TEST_F(ObjectPoolUTest,ObjectsCanOutliveThePool) {
+	std::shared_ptr<Object> o;
+	{
+		ObjectPool<Object> pool;
+		o = pool.Get(1);
+		pool.Get(2);
+		EXPECT_EQ(Object::CurrentlyAllocated(),2);
+	}
+	// the free object is kept until the last object is released
+	EXPECT_EQ(o->Value(),1);
+	EXPECT_EQ(Object::CurrentlyAllocated(),2);
+	o.reset();
+	EXPECT_EQ(Object::CurrentlyAllocated(),0);
+}
+
+TEST_F(ObjectPoolUTest,RecyclesAcrossThreads) {
+	ObjectPool<Object> pool(2);
+	std::vector<std::shared_ptr<Object>> objects;
+	for ( size_t i = 0; i < 4; ++i ) {
+		objects.push_back(pool.Get(i));
+	}
+	EXPECT_EQ(Object::CurrentlyAllocated(),4);
+	// a full batch is handed back to other threads once 4 objects
+	// are freed on this one
+	objects.clear();
+
+	std::thread([&pool,&objects]() {
+		            objects.push_back(pool.Get(42));
+		            objects.push_back(pool.Get(42));
+	            }).join();
+	EXPECT_EQ(Object::CurrentlyAllocated(),4);
+	EXPECT_NE(objects[0]->Value(),42);
+	EXPECT_NE(objects[1]->Value(),42);
+
+	std::thread([&pool,&objects]() {
+		            objects.push_back(pool.Get(42));
+	            }).join();
+	EXPECT_EQ(Object::CurrentlyAllocated(),5);
+	EXPECT_EQ(objects[2]->Value(),42);
+	objects.clear();
+}
+
 } // namespace utils
 } // namespace myrmdion
 } // namespace fort
@@ -103,6 +103,9 @@ void IdentifiedFrameConcurrentLoader::loadMovieSegment(quint32 spaceID,
 	}
 
 	clear();
+	// keys are movie frame IDs shifted by one
+	d_frames.reserve(segment->EndMovieFrame() + 2);
+	d_collisions.reserve(segment->EndMovieFrame() + 2);
 	auto identifier = d_experiment->CIdentifier().Compile();
 	auto solver = d_experiment->CompileCollisionSolver();
 